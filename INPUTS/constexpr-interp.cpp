@@ -0,0 +1,45 @@
+// Stress test for the constexpr bytecode interpreter. Compare:
+//
+//   time clang -std=c++1y -fsyntax-only -fconstexpr-steps=2000000000 \
+//     INPUTS/constexpr-interp.cpp
+//   time clang -std=c++1y -fsyntax-only -fconstexpr-steps=2000000000 \
+//     -fexperimental-constexpr-interpreter INPUTS/constexpr-interp.cpp
+
+typedef unsigned long long u64;
+
+// Sieve-free prime counting by trial division: millions of loop iterations.
+constexpr bool isPrime(unsigned n) {
+  if (n < 2)
+    return false;
+  for (unsigned d = 2; d * d <= n; ++d)
+    if (n % d == 0)
+      return false;
+  return true;
+}
+
+constexpr unsigned countPrimes(unsigned n) {
+  unsigned count = 0;
+  for (unsigned i = 0; i < n; ++i)
+    count += isPrime(i);
+  return count;
+}
+
+static_assert(countPrimes(200000) == 17984, "");
+
+// A linear congruential generator, run for a few million steps.
+constexpr u64 lcg(u64 seed, unsigned n) {
+  for (unsigned i = 0; i != n; ++i)
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return seed;
+}
+
+static_assert(lcg(0, 4000000) != 0, "");
+
+// Deep, non-memoizable recursion.
+constexpr unsigned long long ackermann(unsigned long long m,
+                                       unsigned long long n) {
+  return m == 0 ? n + 1 : n == 0 ? ackermann(m - 1, 1)
+                                 : ackermann(m - 1, ackermann(m, n - 1));
+}
+
+static_assert(ackermann(3, 5) == 253, "");
@@ -0,0 +1,47 @@
+// Stress test for memoized constexpr evaluation. Compare:
+//
+//   time clang -std=c++1y -fsyntax-only -fconstexpr-steps=2000000000 \
+//     INPUTS/constexpr-memo.cpp
+//   time clang -std=c++1y -fsyntax-only -fconstexpr-steps=2000000000 \
+//     -fconstexpr-cache-size=100000 INPUTS/constexpr-memo.cpp
+
+typedef unsigned long long u64;
+
+// Naively recursive: an exponential number of calls without memoization.
+constexpr u64 fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+static_assert(fib(30) == 832040ULL, "");
+static_assert(fib(32) == 2178309ULL, "");
+
+// FNV-1a hash of a string, as used to build compile-time hash tables. This
+// takes the string by pointer, so its calls are never memoized; it is only
+// the reference for hashRepeated below.
+constexpr u64 fnv1a(const char *s, unsigned i, unsigned n, u64 h) {
+  return i == n ? h : fnv1a(s, i + 1, n, (h ^ (unsigned char)s[i]) *
+                                             1099511628211ULL);
+}
+
+// One step of FNV-1a. Its arguments are plain integers, so its calls are
+// memoized.
+constexpr u64 step(u64 h, unsigned char c) {
+  return (h ^ c) * 1099511628211ULL;
+}
+
+// Hash of the string "a" repeated n times, with only integer arguments
+// throughout. Without memoization, each level evaluates the level below it
+// three times.
+constexpr u64 hashRepeated(unsigned n) {
+  return n == 0 ? 14695981039346656037ULL
+       : n == 1 ? step(14695981039346656037ULL, 'a')
+       : hashRepeated(n - 1) == hashRepeated(n - 1) ? step(hashRepeated(n - 1),
+                                                           'a')
+                                                    : 0;
+}
+
+static_assert(hashRepeated(1) == fnv1a("a", 0, 1, 14695981039346656037ULL),
+              "");
+static_assert(hashRepeated(4) == fnv1a("aaaa", 0, 4, 14695981039346656037ULL),
+              "");
+static_assert(hashRepeated(16) != 0, "");
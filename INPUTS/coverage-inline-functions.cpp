@@ -0,0 +1,65 @@
+// Header-style inline functions, as in a translation unit that includes a
+// large library, for which most of the coverage mapping data describes code
+// that other translation units map as well. Measure with:
+//
+//   clang++ -c -fprofile-instr-generate -fcoverage-mapping \
+//     INPUTS/coverage-inline-functions.cpp -o /tmp/a.o -DMAIN
+//   clang++ -c -fprofile-instr-generate -fcoverage-mapping \
+//     INPUTS/coverage-inline-functions.cpp -o /tmp/b.o
+//   clang++ -fprofile-instr-generate /tmp/a.o /tmp/b.o -o /tmp/cov
+//   size -A /tmp/a.o /tmp/b.o /tmp/cov | grep llvm_covmap
+//
+// The mappings of the inline functions are kept once in the executable. Add
+// -Xclang -print-stats to see the bytes of mapping data that are local to the
+// translation unit and that are shared, and -fcoverage-mapping-main-file-only
+// to leave out the mappings of the functions outside the main file.
+
+template <int N> struct Counter {
+  static int step(int X) {
+    if (X & 1)
+      return X * 3 + N;
+    return X / 2;
+  }
+};
+
+#define FUNC(n)                                                                \
+  inline int f##n(int X) {                                                     \
+    int Steps = 0;                                                             \
+    while (X > 1 && Steps < 100) {                                             \
+      X = Counter<n % 7>::step(X);                                             \
+      ++Steps;                                                                 \
+    }                                                                          \
+    return Steps;                                                              \
+  }
+
+#define FUNC10(n)                                                              \
+  FUNC(n##0) FUNC(n##1) FUNC(n##2) FUNC(n##3) FUNC(n##4)                       \
+  FUNC(n##5) FUNC(n##6) FUNC(n##7) FUNC(n##8) FUNC(n##9)
+#define FUNC100(n)                                                             \
+  FUNC10(n##0) FUNC10(n##1) FUNC10(n##2) FUNC10(n##3) FUNC10(n##4)             \
+  FUNC10(n##5) FUNC10(n##6) FUNC10(n##7) FUNC10(n##8) FUNC10(n##9)
+
+FUNC100(1) FUNC100(2) FUNC100(3) FUNC100(4) FUNC100(5)
+
+#define USE(n) Sum += f##n(X);
+#define USE10(n)                                                               \
+  USE(n##0) USE(n##1) USE(n##2) USE(n##3) USE(n##4)                            \
+  USE(n##5) USE(n##6) USE(n##7) USE(n##8) USE(n##9)
+#define USE100(n)                                                              \
+  USE10(n##0) USE10(n##1) USE10(n##2) USE10(n##3) USE10(n##4)                  \
+  USE10(n##5) USE10(n##6) USE10(n##7) USE10(n##8) USE10(n##9)
+
+#ifdef MAIN
+int use_b(int X);
+int main(int argc, char **argv) {
+  int X = argc, Sum = 0;
+  USE100(1) USE100(2) USE100(3) USE100(4) USE100(5)
+  return Sum + use_b(X);
+}
+#else
+int use_b(int X) {
+  int Sum = 0;
+  USE100(1) USE100(2) USE100(3) USE100(4) USE100(5)
+  return Sum;
+}
+#endif
@@ -0,0 +1,46 @@
+// A header's worth of structure and enumeration types, used by every one of a
+// set of translation units, in the style of a C library whose headers are
+// included everywhere. Measure the size of the debug info with:
+//
+//   for i in 1 2 3 4 5 6 7 8; do
+//     clang -c -g -fdebug-types-section -DUNIT=$i INPUTS/debug-types.c \
+//       -o /tmp/debug-types-$i.o
+//   done
+//   size -A /tmp/debug-types-*.o | grep debug
+//   time clang /tmp/debug-types-*.o -o /tmp/debug-types
+//   size -A /tmp/debug-types | grep debug
+//
+// and again without -fdebug-types-section. The type units of the types that
+// are the same in all the objects are kept only once in the linked program.
+
+#define STRUCT(n)                                                              \
+  enum Kind##n { Kind##n##_A, Kind##n##_B, Kind##n##_C };                      \
+  struct Node##n {                                                             \
+    enum Kind##n Kind;                                                         \
+    struct Node##n *Next, *Prev;                                               \
+    long Key;                                                                  \
+    double Weight;                                                             \
+    char Name[32];                                                             \
+  };                                                                           \
+  struct List##n {                                                             \
+    struct Node##n Head;                                                       \
+    unsigned Count : 24, Flags : 8;                                            \
+  };                                                                           \
+  struct List##n Global##n;
+
+#define STRUCT10(n)                                                            \
+  STRUCT(n##0) STRUCT(n##1) STRUCT(n##2) STRUCT(n##3) STRUCT(n##4)             \
+  STRUCT(n##5) STRUCT(n##6) STRUCT(n##7) STRUCT(n##8) STRUCT(n##9)
+
+STRUCT10(1) STRUCT10(2) STRUCT10(3) STRUCT10(4) STRUCT10(5)
+STRUCT10(6) STRUCT10(7) STRUCT10(8) STRUCT10(9)
+
+#define CAT(a, b) a##b
+#define XCAT(a, b) CAT(a, b)
+
+#ifdef UNIT
+int XCAT(unit, UNIT)(void) { return XCAT(Global1, UNIT).Count; }
+#if UNIT == 1
+int main(void) { return 0; }
+#endif
+#endif
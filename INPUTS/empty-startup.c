@@ -0,0 +1,10 @@
+// Measures the fixed cost of a compile, which dominates builds of many small
+// files: the work done for an empty file is process creation, option
+// parsing and target initialization. Time with:
+//
+//   time clang -fsyntax-only INPUTS/empty-startup.c INPUTS/empty-startup.c \
+//     INPUTS/empty-startup.c INPUTS/empty-startup.c INPUTS/empty-startup.c
+//
+// and again with -fintegrated-cc1, which runs each cc1 in the driver process.
+
+int startup;
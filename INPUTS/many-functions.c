@@ -0,0 +1,36 @@
+// A large translation unit of independent functions, in the style of
+// generated code, for which code generation dominates the compile time.
+// Time with:
+//
+//   time clang -c -O2 INPUTS/many-functions.c -o /tmp/many-functions.o
+//
+// and again with -fparallel-codegen=4. For the wall time and peak memory use
+// of -O0 builds, compare
+//
+//   /usr/bin/time -v clang -c INPUTS/many-functions.c -o /tmp/many-functions.o
+//
+// with and without -fstreaming-codegen ("Elapsed (wall clock) time" and
+// "Maximum resident set size"); -Xclang -print-stats shows how many of the
+// functions were generated before the end of the translation unit.
+
+#define FUNC(n)                                                                \
+  double f##n(const double *In, double *Out, int Len) {                        \
+    double Sum = 0;                                                            \
+    for (int I = 0; I < Len; ++I) {                                            \
+      Out[I] = In[I] * n + Sum;                                                \
+      Sum += In[I] / (I + n);                                                  \
+    }                                                                          \
+    return Sum;                                                                \
+  }
+
+#define FUNC10(n)                                                              \
+  FUNC(n##0) FUNC(n##1) FUNC(n##2) FUNC(n##3) FUNC(n##4)                       \
+  FUNC(n##5) FUNC(n##6) FUNC(n##7) FUNC(n##8) FUNC(n##9)
+#define FUNC100(n)                                                             \
+  FUNC10(n##0) FUNC10(n##1) FUNC10(n##2) FUNC10(n##3) FUNC10(n##4)             \
+  FUNC10(n##5) FUNC10(n##6) FUNC10(n##7) FUNC10(n##8) FUNC10(n##9)
+#define FUNC1000(n)                                                            \
+  FUNC100(n##0) FUNC100(n##1) FUNC100(n##2) FUNC100(n##3) FUNC100(n##4)        \
+  FUNC100(n##5) FUNC100(n##6) FUNC100(n##7) FUNC100(n##8) FUNC100(n##9)
+
+FUNC1000(1) FUNC1000(2) FUNC1000(3) FUNC1000(4)
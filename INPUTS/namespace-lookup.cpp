@@ -0,0 +1,44 @@
+// Stress test for name lookup into a very large namespace, in the style of
+// generated code: tens of thousands of classes and functions, and a single
+// overload set with thousands of members. Time with:
+//
+//   time clang -fsyntax-only -Xclang -print-stats INPUTS/namespace-lookup.cpp
+
+#define DECL(n)                                                                \
+  struct S##n { int x; };                                                      \
+  int get##n(const S##n &s);                                                   \
+  int overloaded(S##n *);
+
+#define DECL10(n)                                                              \
+  DECL(n##0) DECL(n##1) DECL(n##2) DECL(n##3) DECL(n##4)                       \
+  DECL(n##5) DECL(n##6) DECL(n##7) DECL(n##8) DECL(n##9)
+#define DECL100(n)                                                             \
+  DECL10(n##0) DECL10(n##1) DECL10(n##2) DECL10(n##3) DECL10(n##4)             \
+  DECL10(n##5) DECL10(n##6) DECL10(n##7) DECL10(n##8) DECL10(n##9)
+#define DECL1000(n)                                                            \
+  DECL100(n##0) DECL100(n##1) DECL100(n##2) DECL100(n##3) DECL100(n##4)        \
+  DECL100(n##5) DECL100(n##6) DECL100(n##7) DECL100(n##8) DECL100(n##9)
+
+// Redeclarations and qualified lookups, made after the lookup table for the
+// namespace has been built.
+#define USE(n)                                                                 \
+  namespace big { int overloaded(S##n *p); }                                   \
+  inline int use##n(big::S##n *p) { return big::get##n(*p) + overloaded(p); }
+
+#define USE10(n)                                                               \
+  USE(n##0) USE(n##1) USE(n##2) USE(n##3) USE(n##4)                            \
+  USE(n##5) USE(n##6) USE(n##7) USE(n##8) USE(n##9)
+#define USE100(n)                                                              \
+  USE10(n##0) USE10(n##1) USE10(n##2) USE10(n##3) USE10(n##4)                  \
+  USE10(n##5) USE10(n##6) USE10(n##7) USE10(n##8) USE10(n##9)
+
+namespace big {
+DECL1000(1)
+DECL1000(2)
+DECL1000(3)
+DECL1000(4)
+}
+
+USE100(10)
+USE100(20)
+USE100(30)
@@ -0,0 +1,42 @@
+// Stress test for overload resolution against a large overload set of
+// function templates, in the style of the output operators of a big library:
+// nine hundred templates taking different class templates, called with
+// arguments of class type that convert to the non-template candidates.
+// Time with:
+//
+//   time clang -fsyntax-only -Xclang -print-stats \
+//     INPUTS/overload-candidates.cpp
+
+struct Stream {};
+struct Name { Name(const char *); };
+struct Number { Number(long); operator long() const; };
+
+Stream &operator<<(Stream &, Name);
+Stream &operator<<(Stream &, long);
+Stream &operator<<(Stream &, double);
+
+#define DECL(n)                                                                \
+  template<typename T> struct C##n { T Value; };                               \
+  template<typename T> Stream &operator<<(Stream &, const C##n<T> &);
+
+#define DECL10(n)                                                              \
+  DECL(n##0) DECL(n##1) DECL(n##2) DECL(n##3) DECL(n##4)                       \
+  DECL(n##5) DECL(n##6) DECL(n##7) DECL(n##8) DECL(n##9)
+#define DECL100(n)                                                             \
+  DECL10(n##0) DECL10(n##1) DECL10(n##2) DECL10(n##3) DECL10(n##4)             \
+  DECL10(n##5) DECL10(n##6) DECL10(n##7) DECL10(n##8) DECL10(n##9)
+
+DECL100(1) DECL100(2) DECL100(3) DECL100(4) DECL100(5)
+DECL100(6) DECL100(7) DECL100(8) DECL100(9)
+
+#define USE(n)                                                                 \
+  void use##n(Stream &S, Number N, C1##n<int> &C) {                            \
+    S << N << "name" << C << N;                                                \
+  }
+
+#define USE10(n)                                                               \
+  USE(n##0) USE(n##1) USE(n##2) USE(n##3) USE(n##4)                            \
+  USE(n##5) USE(n##6) USE(n##7) USE(n##8) USE(n##9)
+
+USE10(0) USE10(1) USE10(2) USE10(3) USE10(4)
+USE10(5) USE10(6) USE10(7) USE10(8) USE10(9)
@@ -0,0 +1,51 @@
+// Stress test for typo correction: 100,000 declared names and the maximum
+// number of corrected typos. Compare:
+//
+//   time clang -fsyntax-only INPUTS/typo-correction.c
+//   time clang -fsyntax-only -ftypo-correction-time-budget=100 \
+//     INPUTS/typo-correction.c
+
+#define DECL10(p) \
+  int p##0, p##1, p##2, p##3, p##4, p##5, p##6, p##7, p##8, p##9;
+#define DECL100(p) DECL10(p##0) DECL10(p##1) DECL10(p##2) DECL10(p##3) \
+  DECL10(p##4) DECL10(p##5) DECL10(p##6) DECL10(p##7) DECL10(p##8) DECL10(p##9)
+#define DECL1000(p) DECL100(p##0) DECL100(p##1) DECL100(p##2) DECL100(p##3) \
+  DECL100(p##4) DECL100(p##5) DECL100(p##6) DECL100(p##7) DECL100(p##8) \
+  DECL100(p##9)
+#define DECL10000(p) DECL1000(p##0) DECL1000(p##1) DECL1000(p##2) \
+  DECL1000(p##3) DECL1000(p##4) DECL1000(p##5) DECL1000(p##6) \
+  DECL1000(p##7) DECL1000(p##8) DECL1000(p##9)
+
+DECL10000(request_handler_)
+DECL10000(connection_state_)
+DECL10000(buffer_offset_)
+DECL10000(parse_result_)
+DECL10000(value_)
+DECL10000(a)
+DECL10000(counter_for_widgets_)
+DECL10000(tmp_)
+DECL10000(node_index_)
+DECL10000(x)
+
+void typos(void) {
+  requst_handler_1234 = 0;
+  conection_state_2345 = 0;
+  bufer_offset_3456 = 0;
+  parse_reslt_4567 = 0;
+  valeu_5678 = 0;
+  b6789 = 0;
+  counter_for_widget_7890 = 0;
+  temp_8901 = 0;
+  node_idex_9012 = 0;
+  y0123 = 0;
+  requst_handler_4321 = 0;
+  conection_state_5432 = 0;
+  bufer_offset_6543 = 0;
+  parse_reslt_7654 = 0;
+  valeu_8765 = 0;
+  b9876 = 0;
+  counter_for_widget_0987 = 0;
+  temp_1098 = 0;
+  node_idex_2109 = 0;
+  y3210 = 0;
+}
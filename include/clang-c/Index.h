@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 29
+#define CINDEX_VERSION_MINOR 30
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -5577,7 +5577,14 @@ typedef enum {
    * indexing session associated with a \c CXIndexAction object.
    * Bodies in system headers are always skipped.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief Skip the function/method bodies of every file other than the main
+   * file. The bodies of templates are parsed if they are instantiated and
+   * \c CXIndexOpt_IndexImplicitTemplateInstantiations is set.
+   */
+  CXIndexOpt_SkipNonMainFileBodies = 0x20
 
 } CXIndexOptFlags;
 
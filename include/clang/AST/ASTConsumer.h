@@ -156,6 +156,14 @@ public:
   /// body may be parsed anyway if it is needed (for instance, if it contains
   /// the code completion point or is constexpr).
   virtual bool shouldSkipFunctionBody(Decl *D) { return true; }
+
+  /// \brief This callback is called for each function template, or member of
+  /// a class template, whose body \c shouldSkipFunctionBody chose to skip.
+  ///
+  /// \return \c true if the tokens of the body should be kept, so that the
+  /// body can be parsed if the template is instantiated, or \c false if the
+  /// instantiations of the function should have no body either.
+  virtual bool shouldDelaySkippedTemplateBody(Decl *D) { return false; }
 };
 
 } // end namespace clang.
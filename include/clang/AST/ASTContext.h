@@ -36,6 +36,7 @@
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
 #include <memory>
@@ -53,12 +54,14 @@ namespace clang {
   class CharUnits;
   class DiagnosticsEngine;
   class Expr;
+  class ASTMemoryProfile;
   class ASTMutationListener;
   class IdentifierTable;
   class MaterializeTemporaryExpr;
   class SelectorTable;
   class TargetInfo;
   class CXXABI;
+  class ConstexprInterpreter;
   class MangleNumberingContext;
   // Decls
   class MangleContext;
@@ -180,6 +183,11 @@ class ASTContext : public RefCountedBase<ASTContext> {
   llvm::DenseMap<const MaterializeTemporaryExpr*, APValue>
     MaterializedTemporaryValues;
 
+  /// \brief Memoized results of calls to constexpr functions, keyed by the
+  /// callee and the values of the arguments. Bounded by
+  /// LangOptions::ConstexprCacheSize.
+  llvm::StringMap<APValue> ConstexprCallResults;
+
   /// \brief Representation of a "canonical" template template parameter that
   /// is used in canonical template names.
   class CanonicalTemplateTemplateParm : public llvm::FoldingSetNode {
@@ -403,6 +411,11 @@ private:
   /// AST objects will be released when the ASTContext itself is destroyed.
   mutable llvm::BumpPtrAllocator BumpAlloc;
 
+  /// \brief Accounts for the memory allocated by BumpAlloc, when
+  /// -ast-memory-report is given.
+  std::unique_ptr<ASTMemoryProfile> MemoryProfile;
+  void noteAllocation(const void *Ptr, size_t Size) const;
+
   /// \brief Allocator for partial diagnostics.
   PartialDiagnostic::StorageAllocator DiagAllocator;
 
@@ -410,6 +423,10 @@ private:
   std::unique_ptr<CXXABI> ABI;
   CXXABI *createCXXABI(const TargetInfo &T);
 
+  /// \brief The bytecode interpreter for constexpr function calls, created
+  /// on first use.
+  std::unique_ptr<ConstexprInterpreter> ConstexprInterp;
+
   /// \brief The logical -> physical address space map.
   const LangAS::Map *AddrSpaceMap;
 
@@ -418,6 +435,7 @@ private:
   bool AddrSpaceMapMangling;
 
   friend class ASTDeclReader;
+  friend class ASTMemoryProfile;
   friend class ASTReader;
   friend class ASTWriter;
   friend class CXXRecordDecl;
@@ -489,7 +507,10 @@ public:
   }
 
   void *Allocate(size_t Size, unsigned Align = 8) const {
-    return BumpAlloc.Allocate(Size, Align);
+    void *Ptr = BumpAlloc.Allocate(Size, Align);
+    if (MemoryProfile)
+      noteAllocation(Ptr, Size);
+    return Ptr;
   }
   void Deallocate(void *Ptr) const { }
   
@@ -498,8 +519,23 @@ public:
   size_t getASTAllocatedMemory() const {
     return BumpAlloc.getTotalMemory();
   }
+  /// Return the number of bytes that have been allocated for AST nodes and
+  /// type information, not counting the slack at the end of each slab.
+  size_t getASTAllocatedBytes() const {
+    return BumpAlloc.getBytesAllocated();
+  }
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
+
+  /// \brief Start attributing the memory allocated for AST nodes to node
+  /// kinds and source files.
+  void enableMemoryProfile();
+
+  /// \brief Stop attributing memory, and destroy the memory profile.
+  void disableMemoryProfile();
+
+  /// \brief The memory profile, if enableMemoryProfile() has been called.
+  ASTMemoryProfile *getMemoryProfile() const { return MemoryProfile.get(); }
   
   PartialDiagnostic::StorageAllocator &getDiagAllocator() {
     return DiagAllocator;
@@ -612,11 +648,7 @@ public:
     return Comments;
   }
 
-  void addComment(const RawComment &RC) {
-    assert(LangOpts.RetainCommentsFromSystemHeaders ||
-           !SourceMgr.isInSystemHeader(RC.getSourceRange().getBegin()));
-    Comments.addComment(RC, BumpAlloc);
-  }
+  void addComment(const RawComment &RC);
 
   /// \brief Return the documentation comment attached to a given declaration.
   /// Returns NULL if no comment is attached.
@@ -2220,6 +2252,17 @@ public:
   APValue *getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
                                          bool MayCreate);
 
+  /// \brief Get the storage for the memoized result of a constexpr function
+  /// call, identified by \p Key.
+  ///
+  /// \returns null if there is no memoized result and either \p MayCreate is
+  /// false or the cache is full.
+  APValue *getConstexprCallResult(StringRef Key, bool MayCreate);
+
+  /// \brief Get the bytecode interpreter for constexpr function calls, used
+  /// with -fexperimental-constexpr-interpreter.
+  ConstexprInterpreter &getConstexprInterpreter();
+
   //===--------------------------------------------------------------------===//
   //                    Statistics
   //===--------------------------------------------------------------------===//
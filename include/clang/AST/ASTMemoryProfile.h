@@ -0,0 +1,131 @@
+//===--- ASTMemoryProfile.h - AST memory accounting -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines ASTMemoryProfile, which attributes the memory allocated
+//  by an ASTContext to node kinds and source files, for use with
+//  -ast-memory-report.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_ASTMEMORYPROFILE_H
+#define LLVM_CLANG_AST_ASTMEMORYPROFILE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+
+/// \brief Accounts for every allocation made by an ASTContext.
+///
+/// Each allocation made through ASTContext::Allocate is recorded along with
+/// its size. Declarations and statements are matched to their allocations
+/// by the statistics hooks in their constructors, type source information
+/// by ASTContext::CreateTypeSourceInfo, and types by walking the types of
+/// the ASTContext when the report is written. Memory allocated directly from
+/// the ASTContext's allocator is attributed to the category that was active
+/// at the time, such as comments while a documentation comment is parsed.
+///
+/// Recording every allocation costs roughly 24 bytes per allocation, so the
+/// profile is only created on request.
+class ASTMemoryProfile {
+public:
+  enum Category {
+    CAT_Decl,
+    CAT_Stmt,
+    CAT_Type,
+    CAT_TypeLoc,
+    CAT_Comment,
+    CAT_Other,
+    NUM_CATEGORIES
+  };
+
+  /// \brief RAII object that attributes the allocations made while it is
+  /// alive to a category, unless they are otherwise classified.
+  class CategoryScope {
+    ASTMemoryProfile *Profile;
+    Category Previous;
+
+    CategoryScope(const CategoryScope &) LLVM_DELETED_FUNCTION;
+    void operator=(const CategoryScope &) LLVM_DELETED_FUNCTION;
+
+  public:
+    CategoryScope(const ASTContext &Ctx, Category C);
+    ~CategoryScope();
+  };
+
+  explicit ASTMemoryProfile(const ASTContext &Ctx);
+  ~ASTMemoryProfile();
+
+  /// \brief The profile of the ASTContext whose nodes are being created,
+  /// if any. A profile is active from its creation until it is destroyed,
+  /// which the ASTContext does once the report is written.
+  static ASTMemoryProfile *getActive();
+
+  /// \brief Record an allocation made through ASTContext::Allocate.
+  void noteAllocation(const void *Ptr, size_t Size) {
+    Allocation &A = Allocations[Ptr];
+    A.Size = Size;
+    A.Cat = CurrentCategory;
+    RecordedBytes += Size;
+  }
+
+  /// \brief Record that \p Node was created in a recorded allocation.
+  void noteNode(Category C, const void *Node);
+
+  /// \brief Write the report, largest costs first.
+  void write(raw_ostream &OS);
+
+private:
+  struct Allocation {
+    size_t Size;
+    Category Cat;
+  };
+
+  struct NodeRecord {
+    const void *Node;
+    size_t Size;
+    Category Cat;
+  };
+
+  const ASTContext &Ctx;
+  ASTMemoryProfile *PreviousActive;
+
+  /// \brief Whether the profile turned on the Decl and Stmt statistics it
+  /// relies on, which are then turned off and cleared when it is destroyed,
+  /// so that they don't carry over to the next compilation in the process.
+  bool EnabledStatistics;
+
+  llvm::DenseMap<const void *, Allocation> Allocations;
+  std::vector<NodeRecord> Nodes;
+
+  /// \brief The category of allocations not otherwise classified.
+  Category CurrentCategory;
+
+  /// \brief The total size of the recorded allocations.
+  uint64_t RecordedBytes;
+
+  /// \brief The bytes allocated directly from the allocator, bypassing
+  /// ASTContext::Allocate, in each category.
+  uint64_t UnrecordedBytes[NUM_CATEGORIES];
+
+  /// \brief The unrecorded bytes at the last change of category.
+  uint64_t LastUnrecordedBytes;
+
+  void switchCategory(Category C);
+
+  ASTMemoryProfile(const ASTMemoryProfile &) LLVM_DELETED_FUNCTION;
+  void operator=(const ASTMemoryProfile &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
@@ -320,7 +320,7 @@ protected:
       IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
       CacheValidAndLinkage(0)
   {
-    if (StatisticsEnabled) add(DK);
+    if (StatisticsEnabled) add(DK, this);
   }
 
   Decl(Kind DK, EmptyShell Empty)
@@ -330,7 +330,7 @@ protected:
       IdentifierNamespace(getIdentifierNamespaceForKind(DK)),
       CacheValidAndLinkage(0)
   {
-    if (StatisticsEnabled) add(DK);
+    if (StatisticsEnabled) add(DK, this);
   }
 
   virtual ~Decl();
@@ -827,8 +827,11 @@ public:
   SourceLocation getBodyRBrace() const;
 
   // global temp stats (until we have a per-module visitor)
-  static void add(Kind k);
+  static void add(Kind k, const Decl *D);
   static void EnableStatistics();
+  static bool isStatisticsEnabled() { return StatisticsEnabled; }
+  /// \brief Stop collecting statistics, and clear the counts collected.
+  static void ResetStatistics();
   static void PrintStats();
 
   /// isTemplateParameter - Determines whether this declaration is a
@@ -16,6 +16,7 @@
 
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclarationName.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
@@ -172,8 +173,28 @@ public:
       return true;
     }
 
-    // Determine if this declaration is actually a redeclaration.
     DeclsTy &Vec = *getAsVector();
+
+    // A function only replaces its previous declaration, so adding to a large
+    // overload set doesn't need to ask every overload whether it's replaced.
+    if (FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+      FunctionDecl *Prev = FD->getPreviousDecl();
+      if (!Prev)
+        return false;
+      DeclsTy::iterator OD = std::find(Vec.begin(), Vec.end(), Prev);
+      if (OD == Vec.end())
+        return false;
+      *OD = D;
+      return true;
+    }
+
+    // Likewise, a function template can only replace a previous declaration
+    // of the same template.
+    if (FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D))
+      if (!FTD->getTemplatedDecl()->getPreviousDecl())
+        return false;
+
+    // Determine if this declaration is actually a redeclaration.
     for (DeclsTy::iterator OD = Vec.begin(), ODEnd = Vec.end();
          OD != ODEnd; ++OD) {
       NamedDecl *OldD = *OD;
@@ -244,6 +265,15 @@ class StoredDeclsMap
 public:
   static void DestroyAll(StoredDeclsMap *Map, bool Dependent);
 
+  /// \brief Print statistics about the lookup tables in the chain starting
+  /// at \p Map.
+  static void PrintStats(const StoredDeclsMap *Map);
+
+  /// \brief Compute the heap memory used by the lookup tables in the chain
+  /// starting at \p Map, and the number of tables.
+  static uint64_t getChainMemorySize(const StoredDeclsMap *Map,
+                                     unsigned &NumMaps);
+
 private:
   friend class ASTContext; // walks the chain deleting these
   friend class DeclContext;
@@ -215,6 +215,44 @@ protected:
     unsigned RefersToEnclosingLocal : 1;
   };
 
+  class MemberExprBitfields {
+    friend class MemberExpr;
+    unsigned : NumExprBits;
+
+    /// \brief True if this is "X->F", false if this is "X.F".
+    unsigned IsArrow : 1;
+
+    /// \brief True if a MemberNameQualifier is allocated immediately after
+    /// the MemberExpr.
+    unsigned HasQualifierOrFoundDecl : 1;
+
+    /// \brief True if an ASTTemplateKWAndArgsInfo is allocated after the
+    /// MemberExpr and its MemberNameQualifier, if any.
+    unsigned HasTemplateKWAndArgsInfo : 1;
+
+    /// \brief True if the member was resolved from an overload set having
+    /// more than one candidate.
+    unsigned HadMultipleCandidates : 1;
+  };
+
+  class UnaryOperatorBitfields {
+    friend class UnaryOperator;
+    unsigned : NumExprBits;
+
+    unsigned Opc : 5;
+  };
+
+  class BinaryOperatorBitfields {
+    friend class BinaryOperator;
+    unsigned : NumExprBits;
+
+    unsigned Opc : 6;
+
+    /// \brief Whether the operation may be contracted (e.g., into a fused
+    /// multiply-add), per FP_CONTRACT.
+    unsigned FPContractable : 1;
+  };
+
   class CastExprBitfields {
     friend class CastExpr;
     unsigned : NumExprBits;
@@ -225,9 +263,18 @@ protected:
 
   class CallExprBitfields {
     friend class CallExpr;
+    friend class CXXOperatorCallExpr;
+    friend class ASTStmtReader; // deserialization
     unsigned : NumExprBits;
 
     unsigned NumPreArgs : 1;
+
+    /// \brief The overloaded operator of a CXXOperatorCallExpr.
+    unsigned OperatorKind : 6;
+
+    /// \brief Whether a CXXOperatorCallExpr may be contracted, per
+    /// FP_CONTRACT.
+    unsigned FPContractable : 1;
   };
 
   class ExprWithCleanupsBitfields {
@@ -286,17 +333,29 @@ protected:
     unsigned NumArgs : 32 - 8 - 1 - NumExprBits;
   };
 
+  /// \brief The words of the bitfields. On 64-bit hosts there are two, and
+  /// the second one, which would otherwise be padding before the first
+  /// pointer of a node, is the spare word of StmtSpareWord.
+  class SpareWordBitfields {
+    template <bool> friend class StmtSpareWord;
+
+    unsigned Words[sizeof(void *) / sizeof(unsigned)];
+  };
+
   union {
-    // FIXME: this is wasteful on 64-bit platforms.
     void *Aligner;
 
     StmtBitfields StmtBits;
+    SpareWordBitfields SpareWordBits;
     CompoundStmtBitfields CompoundStmtBits;
     ExprBitfields ExprBits;
     CharacterLiteralBitfields CharacterLiteralBits;
     FloatingLiteralBitfields FloatingLiteralBits;
     UnaryExprOrTypeTraitExprBitfields UnaryExprOrTypeTraitExprBits;
     DeclRefExprBitfields DeclRefExprBits;
+    MemberExprBitfields MemberExprBits;
+    UnaryOperatorBitfields UnaryOperatorBits;
+    BinaryOperatorBitfields BinaryOperatorBits;
     CastExprBitfields CastExprBits;
     CallExprBitfields CallExprBits;
     ExprWithCleanupsBitfields ExprWithCleanupsBits;
@@ -306,10 +365,15 @@ protected:
     TypeTraitExprBitfields TypeTraitExprBits;
   };
 
+  template <bool> friend class StmtSpareWord;
   friend class ASTStmtReader;
   friend class ASTStmtWriter;
 
 public:
+  /// \brief Whether the bitfields have a spare 32-bit word, which is the case
+  /// on 64-bit hosts.
+  static const bool HasSpareBitfieldWord = sizeof(void *) > sizeof(unsigned);
+
   // Only allow allocation of Stmts using the allocator in ASTContext
   // or by doing a placement new.
   void* operator new(size_t bytes, const ASTContext& C,
@@ -343,13 +407,15 @@ protected:
   /// \brief Construct an empty statement.
   explicit Stmt(StmtClass SC, EmptyShell) {
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (StatisticsEnabled) Stmt::addStmtClass(SC, this);
   }
 
 public:
   Stmt(StmtClass SC) {
+    static_assert(sizeof(*this) == sizeof(void *),
+                  "changing bitfields changed sizeof(Stmt)");
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (StatisticsEnabled) Stmt::addStmtClass(SC, this);
   }
 
   StmtClass getStmtClass() const {
@@ -365,8 +431,11 @@ public:
   SourceLocation getLocEnd() const LLVM_READONLY;
 
   // global temp stats (until we have a per-module visitor)
-  static void addStmtClass(const StmtClass s);
+  static void addStmtClass(const StmtClass s, const Stmt *S);
   static void EnableStatistics();
+  static bool isStatisticsEnabled() { return StatisticsEnabled; }
+  /// \brief Stop collecting statistics, and clear the counts collected.
+  static void ResetStatistics();
   static void PrintStats();
 
   /// \brief Dumps the specified AST fragment and all subtrees to
@@ -439,6 +508,34 @@ public:
                bool Canonical) const;
 };
 
+/// \brief Storage for a location or other 32-bit field of the node kind
+/// that derives from it, besides Stmt.
+///
+/// On 64-bit hosts the field is kept in the spare word of the Stmt bitfields
+/// and this class is empty. Elsewhere there is no spare word, so that Stmt
+/// stays pointer-sized, and the field is a member of this class.
+template <bool InBitfields = Stmt::HasSpareBitfieldWord>
+class StmtSpareWord {
+  static const unsigned SpareWord =
+      sizeof(Stmt::SpareWordBitfields::Words) / sizeof(unsigned) - 1;
+
+protected:
+  unsigned getSpareWord(const Stmt *S) const {
+    return S->SpareWordBits.Words[SpareWord];
+  }
+  void setSpareWord(Stmt *S, unsigned Value) {
+    S->SpareWordBits.Words[SpareWord] = Value;
+  }
+};
+
+template <> class StmtSpareWord<false> {
+  unsigned Word;
+
+protected:
+  unsigned getSpareWord(const Stmt *) const { return Word; }
+  void setSpareWord(Stmt *, unsigned Value) { Word = Value; }
+};
+
 /// DeclStmt - Adaptor class for mixing declarations with statements and
 /// expressions. For example, CompoundStmt mixes statements, expressions
 /// and declarations (variables, types). Another example is ForStmt, where
@@ -1340,19 +1437,21 @@ public:
 /// return void.  We explicitly model this in the AST, which means you can't
 /// depend on the return type of the function and the presence of an argument.
 ///
-class ReturnStmt : public Stmt {
+class ReturnStmt : public Stmt, StmtSpareWord<> {
   Stmt *RetExpr;
-  SourceLocation RetLoc;
   const VarDecl *NRVOCandidate;
 
 public:
   ReturnStmt(SourceLocation RL)
-    : Stmt(ReturnStmtClass), RetExpr(nullptr), RetLoc(RL),
-      NRVOCandidate(nullptr) {}
+    : Stmt(ReturnStmtClass), RetExpr(nullptr), NRVOCandidate(nullptr) {
+    setSpareWord(this, RL.getRawEncoding());
+  }
 
   ReturnStmt(SourceLocation RL, Expr *E, const VarDecl *NRVOCandidate)
-    : Stmt(ReturnStmtClass), RetExpr((Stmt*) E), RetLoc(RL),
-      NRVOCandidate(NRVOCandidate) {}
+    : Stmt(ReturnStmtClass), RetExpr((Stmt*) E),
+      NRVOCandidate(NRVOCandidate) {
+    setSpareWord(this, RL.getRawEncoding());
+  }
 
   /// \brief Build an empty return expression.
   explicit ReturnStmt(EmptyShell Empty) : Stmt(ReturnStmtClass, Empty) { }
@@ -1361,8 +1460,12 @@ public:
   Expr *getRetValue();
   void setRetValue(Expr *E) { RetExpr = reinterpret_cast<Stmt*>(E); }
 
-  SourceLocation getReturnLoc() const { return RetLoc; }
-  void setReturnLoc(SourceLocation L) { RetLoc = L; }
+  SourceLocation getReturnLoc() const {
+    return SourceLocation::getFromRawEncoding(getSpareWord(this));
+  }
+  void setReturnLoc(SourceLocation L) {
+    setSpareWord(this, L.getRawEncoding());
+  }
 
   /// \brief Retrieve the variable that might be used for the named return
   /// value optimization.
@@ -1372,9 +1475,9 @@ public:
   const VarDecl *getNRVOCandidate() const { return NRVOCandidate; }
   void setNRVOCandidate(const VarDecl *Var) { NRVOCandidate = Var; }
 
-  SourceLocation getLocStart() const LLVM_READONLY { return RetLoc; }
+  SourceLocation getLocStart() const LLVM_READONLY { return getReturnLoc(); }
   SourceLocation getLocEnd() const LLVM_READONLY {
-    return RetExpr ? RetExpr->getLocEnd() : RetLoc;
+    return RetExpr ? RetExpr->getLocEnd() : getReturnLoc();
   }
 
   static bool classof(const Stmt *T) {
@@ -395,6 +395,18 @@ public:
   virtual IdentifierIterator *getIdentifiers();
 };
 
+/// \brief Is told about the identifiers that an IdentifierTable creates, so
+/// that a client can follow the contents of the table without walking it.
+class IdentifierCreationListener {
+public:
+  virtual ~IdentifierCreationListener();
+
+  /// \brief Called when the table creates an IdentifierInfo for \p II,
+  /// including when an external identifier lookup creates one through
+  /// IdentifierTable::getOwn().
+  virtual void IdentifierCreated(IdentifierInfo &II) = 0;
+};
+
 /// \brief An abstract class used to resolve numerical identifier
 /// references (meaningful only to some external source) into
 /// IdentifierInfo pointers.
@@ -421,6 +433,22 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  IdentifierCreationListener *CreationListener;
+
+  IdentifierInfo &create(HashTableTy::MapEntryTy &Entry) {
+    void *Mem = getAllocator().Allocate<IdentifierInfo>();
+    IdentifierInfo *II = new (Mem) IdentifierInfo();
+
+    // Make sure getName() knows how to find the IdentifierInfo
+    // contents.
+    II->Entry = &Entry;
+    Entry.second = II;
+
+    if (CreationListener)
+      CreationListener->IdentifierCreated(*II);
+    return *II;
+  }
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -436,6 +464,18 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Set the listener that is told about new identifiers, or clear
+  /// it with null.
+  void setCreationListener(IdentifierCreationListener *Listener) {
+    CreationListener = Listener;
+  }
+
+  /// \brief Retrieve the listener that is told about new identifiers, if
+  /// any.
+  IdentifierCreationListener *getCreationListener() const {
+    return CreationListener;
+  }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -457,14 +497,7 @@ public:
     }
 
     // Lookups failed, make a new IdentifierInfo.
-    void *Mem = getAllocator().Allocate<IdentifierInfo>();
-    II = new (Mem) IdentifierInfo();
-
-    // Make sure getName() knows how to find the IdentifierInfo
-    // contents.
-    II->Entry = &Entry;
-
-    return *II;
+    return create(Entry);
   }
 
   IdentifierInfo &get(StringRef Name, tok::TokenKind TokenCode) {
@@ -488,18 +521,13 @@ public:
       return *II;
 
     // Lookups failed, make a new IdentifierInfo.
-    void *Mem = getAllocator().Allocate<IdentifierInfo>();
-    II = new (Mem) IdentifierInfo();
-
-    // Make sure getName() knows how to find the IdentifierInfo
-    // contents.
-    II->Entry = &Entry;
+    IdentifierInfo &NewII = create(Entry);
 
     // If this is the 'import' contextual keyword, mark it as such.
     if (Name.equals("import"))
-      II->setModulesImport(true);
+      NewII.setModulesImport(true);
 
-    return *II;
+    return NewII;
   }
 
   typedef HashTableTy::const_iterator iterator;
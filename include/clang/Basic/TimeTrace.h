@@ -0,0 +1,110 @@
+//===--- TimeTrace.h - Hierarchical compile time tracing --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a lightweight profiler that records nested time spans of
+/// the compilation (e.g., the parsing of each header, each template
+/// instantiation or each function emitted by IR generation) and writes them
+/// in the Chrome trace event format, for use with -ftime-trace.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include <string>
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// \brief The active time trace profiler of this thread, or null if time
+/// tracing is disabled. Each thread records its own spans, so that compiles
+/// run on different threads of one process don't interleave them.
+extern LLVM_THREAD_LOCAL TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// \brief Start recording time spans on this thread.
+void timeTraceProfilerInitialize();
+
+/// \brief Stop recording time spans and discard any that were recorded.
+void timeTraceProfilerCleanup();
+
+/// \brief Determine whether time spans are being recorded.
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// \brief Write all of the recorded time spans to \p OS as a Chrome trace
+/// (see chrome://tracing), along with the total time spent in spans of each
+/// name. Spans that are still open are closed first.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// \brief Open a new time span, nested within the innermost open span.
+///
+/// \param Name The kind of work, e.g. "InstantiateFunction".
+///
+/// \param Detail What the work is being done on, e.g. the name of the
+/// function being instantiated.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// \brief Close the innermost open time span.
+void timeTraceProfilerEnd();
+
+/// \brief Replace the detail of the innermost open time span, for work whose
+/// subject is only known once it has started.
+void timeTraceProfilerSetDetail(StringRef Detail);
+
+/// \brief RAII object that records a time span for its lifetime, if time
+/// tracing is enabled.
+///
+/// The detail can be computed lazily, so that the cost of building it is only
+/// paid when tracing:
+/// \code
+///   TimeTraceScope Scope("InstantiateClass", [&]() {
+///     return Instantiation->getQualifiedNameAsString();
+///   });
+/// \endcode
+class TimeTraceScope {
+  bool Active;
+
+  TimeTraceScope(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail)
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail());
+  }
+
+  /// \brief Replace the detail of this time span.
+  void setDetail(llvm::function_ref<std::string()> Detail) {
+    if (Active)
+      timeTraceProfilerSetDetail(Detail());
+  }
+
+  ~TimeTraceScope() {
+    if (Active)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace clang
+
+#endif
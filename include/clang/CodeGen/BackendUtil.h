@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 
 namespace llvm {
+  class Function;
   class Module;
 }
 
@@ -35,6 +36,41 @@ namespace clang {
                          const TargetOptions &TOpts, const LangOptions &LOpts,
                          StringRef TDesc, llvm::Module *M, BackendAction Action,
                          raw_ostream *OS);
+
+  /// StreamingBackend - Generates code for the functions of a module one at a
+  /// time, as soon as their IR is complete, while IR generation for the rest
+  /// of the module goes on. The IR of each function is freed once its code
+  /// has been generated.
+  class StreamingBackend {
+  public:
+    virtual ~StreamingBackend();
+
+    /// AddCompletedFunction - Note that IR generation has finished the body
+    /// of \p F, so that the next EmitCompletedFunctions looks at it.
+    virtual void AddCompletedFunction(llvm::Function *F) = 0;
+
+    /// EmitCompletedFunctions - Generate code for the functions of the module
+    /// that are complete and are no longer needed in IR form.
+    virtual void EmitCompletedFunctions() = 0;
+
+    /// Finish - Generate code for the rest of the module, once IR generation
+    /// is done. \p TDesc is as for EmitBackendOutput.
+    virtual void Finish(StringRef TDesc) = 0;
+
+    /// PrintStats - Print statistics about the functions generated early.
+    virtual void PrintStats() const = 0;
+  };
+
+  /// CreateStreamingBackend - Set up streaming code generation for \p M, if
+  /// the options allow it. Returns null if the code for \p M has to be
+  /// generated all at once by EmitBackendOutput.
+  StreamingBackend *CreateStreamingBackend(DiagnosticsEngine &Diags,
+                                           const CodeGenOptions &CGOpts,
+                                           const TargetOptions &TOpts,
+                                           const LangOptions &LOpts,
+                                           llvm::Module *M,
+                                           BackendAction Action,
+                                           raw_ostream *OS);
 }
 
 #endif
@@ -29,6 +29,11 @@ namespace clang {
   class CodeGenOptions;
   class TargetOptions;
   class Decl;
+  class StreamingBackend;
+
+  namespace CodeGen {
+    class LoopReport;
+  }
 
   class CodeGenerator : public ASTConsumer {
     virtual void anchor();
@@ -36,6 +41,10 @@ namespace clang {
     virtual llvm::Module* GetModule() = 0;
     virtual llvm::Module* ReleaseModule() = 0;
     virtual const Decl *GetDeclForMangledName(llvm::StringRef MangledName) = 0;
+
+    /// SetStreamingBackend - Tell \p S about each function whose body has
+    /// been generated. Must be called after Initialize.
+    virtual void SetStreamingBackend(StreamingBackend *S) = 0;
   };
 
   /// CreateLLVMCodeGen - Create a CodeGenerator instance.
@@ -46,7 +55,8 @@ namespace clang {
                                    const CodeGenOptions &CGO,
                                    const TargetOptions &TO,
                                    llvm::LLVMContext& C,
-                                   CoverageSourceInfo *CoverageInfo = nullptr);
+                                   CoverageSourceInfo *CoverageInfo = nullptr,
+                                   CodeGen::LoopReport *Loops = nullptr);
 }
 
 #endif
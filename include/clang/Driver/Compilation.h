@@ -172,6 +172,20 @@ public:
   void ExecuteJob(const Job &J,
      SmallVectorImpl< std::pair<int, const Command *> > &FailingCommands) const;
 
+  /// ExecuteJobs - Execute the commands of a job list, running up to
+  /// \p MaxParallelJobs of them at the same time.
+  ///
+  /// A command is started once the commands producing its inputs have
+  /// succeeded. The output of each command is buffered and written, along
+  /// with any failure, in the order of the job list, so the result is the
+  /// same as that of ExecuteJob.
+  ///
+  /// \param FailingCommands - For non-zero results, this will be a vector of
+  /// failing commands and their associated result code.
+  void ExecuteJobs(const JobList &Jobs,
+     SmallVectorImpl< std::pair<int, const Command *> > &FailingCommands,
+     unsigned MaxParallelJobs) const;
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
@@ -113,6 +113,10 @@ public:
   /// Information about the host which can be overridden by the user.
   std::string HostBits, HostMachine, HostSystem, HostRelease;
 
+  /// The function used to run -cc1 jobs in the driver process with
+  /// -fintegrated-cc1, or null if the driver can't run them itself.
+  CC1ToolFunc CC1Main;
+
   /// The file to log CC_PRINT_OPTIONS output to, if enabled.
   const char *CCPrintOptionsFilename;
 
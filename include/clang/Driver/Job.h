@@ -11,6 +11,7 @@
 #define LLVM_CLANG_DRIVER_JOB_H
 
 #include "clang/Basic/LLVM.h"
+#include "clang/Driver/Util.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Option/Option.h"
 #include "llvm/ADT/iterator.h"
@@ -41,6 +42,7 @@ class Job {
 public:
   enum JobClass {
     CommandClass,
+    CC1CommandClass,
     FallbackCommandClass,
     JobListClass
   };
@@ -136,8 +138,33 @@ public:
 
   static bool classof(const Job *J) {
     return J->getKind() == CommandClass ||
+           J->getKind() == CC1CommandClass ||
            J->getKind() == FallbackCommandClass;
   }
+
+protected:
+  Command(JobClass Kind, const Action &_Source, const Tool &_Creator,
+          const char *_Executable, const llvm::opt::ArgStringList &_Arguments);
+};
+
+/// Like Command, but runs the -cc1 tool in the driver process instead of
+/// spawning a new one. A crash in the tool is caught and reported as if the
+/// process had been killed by a signal.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_,
+             CC1ToolFunc CC1Main_);
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+
+  static bool classof(const Job *J) {
+    return J->getKind() == CC1CommandClass;
+  }
+
+private:
+  CC1ToolFunc CC1Main;
 };
 
 /// Like Command, but with a fallback which is executed in case
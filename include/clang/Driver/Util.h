@@ -26,6 +26,11 @@ namespace driver {
   /// ActionList - Type used for lists of actions.
   typedef SmallVector<Action*, 3> ActionList;
 
+  /// CC1ToolFunc - Type of the function that runs a -cc1 tool in the driver
+  /// process. Argv[0] is the executable and Argv[1] the -cc1 flag naming the
+  /// tool.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
 } // end namespace driver
 } // end namespace clang
 
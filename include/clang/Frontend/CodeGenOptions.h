@@ -114,6 +114,18 @@ public:
   /// non-empty.
   std::string DwarfDebugFlags;
 
+  /// The dependency list that decides the home of the classes defined in
+  /// headers, with -fdebug-type-homing.
+  std::string DebugTypeHomingManifest;
+
+  /// The file to write the estimated debug info size of each type to, if
+  /// non-empty.
+  std::string DebugTypeReportFile;
+
+  /// The file to write the loops, their hints and the optimizer's remarks
+  /// about them to, if non-empty.
+  std::string LoopReportFile;
+
   /// The ABI to use for passing floating point arguments.
   std::string FloatABI;
 
@@ -145,6 +157,10 @@ public:
   /// A list of command-line options to forward to the LLVM backend.
   std::vector<std::string> BackendOptions;
 
+  /// The files to write the code for the parts of the module after the first
+  /// to, if code is generated for the parts of the module in parallel.
+  std::vector<std::string> ParallelCodeGenOutputs;
+
   /// A list of dependent libraries.
   std::vector<std::string> DependentLibraries;
 
@@ -154,6 +170,10 @@ public:
   /// Name of the profile file to use as input for -fprofile-instr-use
   std::string InstrProfileInput;
 
+  /// The file to write the part of the -fprofile-instr-use profile that the
+  /// translation unit uses to, if non-empty.
+  std::string InstrProfileSubsetOutput;
+
   /// Regular expression to select optimizations for which we should enable
   /// optimization remarks. Transformation passes whose name matches this
   /// expression (and support this feature), will emit a diagnostic
@@ -103,6 +103,15 @@ class CompilerInstance : public ModuleLoader {
   /// \brief The frontend timer
   std::unique_ptr<llvm::Timer> FrontendTimer;
 
+  /// \brief The stream that -trace-deserialization writes to, once opened.
+  ///
+  /// This is declared before the ASTReader so that it outlives the listeners
+  /// that write to it.
+  std::unique_ptr<raw_ostream> DeserializationTraceStream;
+
+  /// \brief Whether opening the -trace-deserialization file failed.
+  bool DeserializationTraceFailed;
+
   /// \brief The ASTReader, if one exists.
   IntrusiveRefCntPtr<ASTReader> ModuleManager;
 
@@ -519,6 +528,14 @@ public:
   /// \param EraseFiles - If true, attempt to erase the files from disk.
   void clearOutputFiles(bool EraseFiles);
 
+  /// \brief Get the stream for -trace-deserialization, opening the file the
+  /// first time it is requested so that every AST reader appends to the same
+  /// trace.
+  ///
+  /// \returns null (after emitting a diagnostic the first time) if the file
+  /// could not be opened.
+  raw_ostream *getDeserializationTraceStream();
+
   /// }
   /// @name Construction Utility Methods
   /// {
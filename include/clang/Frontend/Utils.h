@@ -32,6 +32,7 @@ class ArgList;
 
 namespace clang {
 class ASTConsumer;
+class ASTDeserializationListener;
 class ASTReader;
 class CompilerInstance;
 class CompilerInvocation;
@@ -159,10 +160,23 @@ void AttachHeaderIncludeGen(Preprocessor &PP, bool ShowAllHeaders = false,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// AttachTimeTraceSourceSpans - Record a time span for each header entered by
+/// the given preprocessor, for -ftime-trace.
+void AttachTimeTraceSourceSpans(Preprocessor &PP);
+
 /// CacheTokens - Cache tokens for use with PCH. Note that this requires
 /// a seekable stream.
 void CacheTokens(Preprocessor &PP, llvm::raw_fd_ostream* OS);
 
+/// Create a deserialization listener that writes a trace of every declaration
+/// and type deserialized from an AST file to \p OS, along with why it was
+/// deserialized and how long reading it took, before forwarding to
+/// \p Previous.
+ASTDeserializationListener *
+createDeserializationTracer(raw_ostream &OS,
+                            ASTDeserializationListener *Previous,
+                            bool DeletePrevious);
+
 /// The ChainedIncludesSource class converts headers to chained PCHs in
 /// memory, mainly for testing.
 IntrusiveRefCntPtr<ExternalSemaSource>
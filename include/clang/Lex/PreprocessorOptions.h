@@ -61,6 +61,10 @@ public:
   /// \brief Headers that will be converted to chained PCHs in memory.
   std::vector<std::string> ChainedIncludes;
 
+  /// \brief The directory in which the PCHs for the chained includes are
+  /// cached between compilations, or empty to always rebuild them.
+  std::string ChainedIncludesCachePath;
+
   /// \brief When true, disables most of the normal validation performed on
   /// precompiled headers.
   bool DisablePCHValidation;
@@ -75,6 +79,10 @@ public:
   /// deserialized, and we emit an error if they are; for testing purposes.
   std::set<std::string> DeserializedPCHDeclsToErrorOn;
 
+  /// \brief If non-empty, the file to which a trace of all declarations and
+  /// types deserialized from AST files is written.
+  std::string DeserializationTraceFile;
+
   /// \brief If non-zero, the implicit PCH include is actually a precompiled
   /// preamble that covers this number of bytes in the main source file.
   ///
@@ -174,7 +182,9 @@ public:
     Includes.clear();
     MacroIncludes.clear();
     ChainedIncludes.clear();
+    ChainedIncludesCachePath.clear();
     DumpDeserializedPCHDecls = false;
+    DeserializationTraceFile.clear();
     ImplicitPCHInclude.clear();
     ImplicitPTHInclude.clear();
     TokenCache.clear();
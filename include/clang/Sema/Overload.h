@@ -23,6 +23,7 @@
 #include "clang/AST/UnresolvedSet.h"
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/AlignOf.h"
@@ -542,6 +543,53 @@ namespace clang {
     void dump() const;
   };
 
+  /// \brief A cache of the implicit conversion sequences from arguments of
+  /// class type.
+  ///
+  /// The conversion sequence from an ordinary expression of complete class
+  /// type to a complete type depends only on the types involved, the value
+  /// kind of the expression and how the conversion is being performed, so
+  /// it can be reused across every overload candidate in the translation
+  /// unit. Bad conversion sequences refer to the expression they were
+  /// computed for, and must be pointed at the new one when reused.
+  class ConversionSequenceCache {
+  public:
+    /// \brief The flags describing how a conversion is performed.
+    enum {
+      SuppressUserConversions = 0x1,
+      InOverloadResolution = 0x2,
+      AllowObjCWritebackConversion = 0x4,
+      AllowExplicit = 0x8,
+      ValueKindShift = 4
+    };
+
+    typedef std::pair<std::pair<void *, void *>, unsigned> Key;
+
+    static Key getKey(QualType FromType, QualType ToType, unsigned Flags) {
+      return Key(std::make_pair(FromType.getAsOpaquePtr(),
+                                ToType.getAsOpaquePtr()),
+                 Flags);
+    }
+
+    /// \brief Find the conversion sequence for \p K, or return null.
+    const ImplicitConversionSequence *find(const Key &K) const {
+      llvm::DenseMap<Key, ImplicitConversionSequence>::const_iterator I =
+          Cache.find(K);
+      return I == Cache.end() ? nullptr : &I->second;
+    }
+
+    void insert(const Key &K, const ImplicitConversionSequence &ICS) {
+      Cache[K] = ICS;
+    }
+
+    unsigned size() const { return Cache.size(); }
+
+    void clear() { Cache.clear(); }
+
+  private:
+    llvm::DenseMap<Key, ImplicitConversionSequence> Cache;
+  };
+
   enum OverloadFailureKind {
     ovl_fail_too_many_arguments,
     ovl_fail_too_few_arguments,
@@ -568,7 +616,12 @@ namespace clang {
 
     /// This candidate function was not viable because an enable_if
     /// attribute disabled it.
-    ovl_fail_enable_if
+    ovl_fail_enable_if,
+
+    /// This function template candidate was not viable because template
+    /// argument deduction was certain to fail, so it was skipped. The
+    /// deduction is performed if the reason is needed for a diagnostic.
+    ovl_fail_deferred_deduction
   };
 
   /// OverloadCandidate - A single candidate in an overload set (C++ 13.3).
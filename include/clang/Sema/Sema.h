@@ -94,6 +94,7 @@ namespace clang {
   class CodeCompletionAllocator;
   class CodeCompletionTUInfo;
   class CodeCompletionResult;
+  class ConversionSequenceCache;
   class Decl;
   class DeclAccessPair;
   class DeclContext;
@@ -160,6 +161,7 @@ namespace clang {
   class TemplateArgumentList;
   class TemplateArgumentLoc;
   class TemplateDecl;
+  class TemplateInstantiationReport;
   class TemplateParameterList;
   class TemplatePartialOrderingContext;
   class TemplateTemplateParmDecl;
@@ -169,6 +171,7 @@ namespace clang {
   class TypedefNameDecl;
   class TypeLoc;
   class TypoCorrectionConsumer;
+  class TypoCorrectionIndex;
   class UnqualifiedId;
   class UnresolvedLookupExpr;
   class UnresolvedMemberExpr;
@@ -1698,6 +1701,11 @@ public:
   /// \c constexpr in C++11 or has an 'auto' return type in C++14).
   bool canSkipFunctionBody(Decl *D);
 
+  /// \brief Determine whether the body of a templated function that is being
+  /// skipped should instead be lexed and kept, so that it can be parsed on
+  /// demand when the function is instantiated.
+  bool canDelaySkippedFunctionBody(Decl *D);
+
   void computeNRVO(Stmt *Body, sema::FunctionScopeInfo *Scope);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
@@ -2045,6 +2053,31 @@ public:
     AA_Passing_CFAudited
   };
 
+  /// \brief The implicit conversion sequences from arguments of class type
+  /// computed for overload candidates, created on first use.
+  std::unique_ptr<ConversionSequenceCache> ConversionCache;
+
+  /// \brief The number of enable_if conditions evaluated; a conversion
+  /// sequence that evaluated one depends on the argument's value.
+  unsigned NumEnableIfChecks;
+
+  /// \brief The number of function template candidates for which template
+  /// argument deduction was skipped because it was certain to fail.
+  unsigned NumDeductionsAvoided;
+
+  /// \brief The number of template argument deductions for overload
+  /// candidates that failed, and the time they took in microseconds, when
+  /// collecting statistics.
+  unsigned NumFailedDeductions;
+  uint64_t FailedDeductionTime;
+
+  /// \brief Lookups in ConversionCache that found a conversion sequence,
+  /// and those that computed one, with the time spent computing them in
+  /// microseconds when collecting statistics.
+  unsigned NumConversionCacheHits;
+  unsigned NumConversionCacheMisses;
+  uint64_t ConversionCacheMissTime;
+
   /// C++ Overloading.
   enum OverloadKind {
     /// This is a legitimate overload: the existing declarations are
@@ -6383,6 +6416,10 @@ public:
   SmallVector<ActiveTemplateInstantiation, 16>
     ActiveTemplateInstantiations;
 
+  /// \brief The cost of each template specialization instantiated so far, if
+  /// -ftemplate-instantiation-report is enabled; otherwise null.
+  std::unique_ptr<TemplateInstantiationReport> InstantiationReport;
+
   /// \brief Extra modules inspected when performing a lookup during a template
   /// instantiation. Computed lazily.
   SmallVector<Module*, 16> ActiveTemplateInstantiationLookupModules;
@@ -6667,6 +6704,21 @@ public:
   /// \brief The number of typos corrected by CorrectTypo.
   unsigned TyposCorrected;
 
+  /// \brief The time spent looking for typo corrections and validating
+  /// them, in microseconds.
+  uint64_t TypoCorrectionTime;
+
+  /// \brief Whether typo correction has time left in the budget set by
+  /// -ftypo-correction-time-budget.
+  bool hasTypoCorrectionTimeLeft() const {
+    unsigned Budget = getLangOpts().TypoCorrectionTimeBudget;
+    return !Budget || TypoCorrectionTime < Budget * 1000ULL;
+  }
+
+  /// \brief An index of the identifiers in the translation unit, built the
+  /// first time a typo is corrected.
+  std::unique_ptr<TypoCorrectionIndex> TypoIndex;
+
   typedef llvm::DenseMap<IdentifierInfo *, TypoCorrection>
     UnqualifiedTyposCorrectedMap;
 
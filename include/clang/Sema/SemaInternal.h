@@ -121,6 +121,12 @@ public:
   void addKeywordResult(StringRef Keyword);
   void addCorrection(TypoCorrection Correction);
 
+  /// \brief The largest edit distance at which a name is considered as a
+  /// correction for \p Typo.
+  static unsigned getMaxEditDistance(StringRef Typo) {
+    return (Typo.size() + 2) / 3;
+  }
+
   bool empty() const {
     return CorrectionResults.empty() && ValidatedCorrections.size() == 1;
   }
@@ -0,0 +1,111 @@
+//===- TemplateInstantiationReport.h - Instantiation costs ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//===----------------------------------------------------------------------===//
+//
+//  This file defines TemplateInstantiationReport, which accounts for the cost
+//  of each template specialization instantiated by Sema, for use with
+//  -ftemplate-instantiation-report.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONREPORT_H
+#define LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONREPORT_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+
+namespace clang {
+
+class NamedDecl;
+class Sema;
+
+/// \brief Accounts for the time, AST memory and AST nodes spent on each
+/// template specialization instantiated within a translation unit.
+///
+/// Costs are recorded both inclusive of the instantiations that a
+/// specialization triggers ("total") and exclusive of them ("self"), and are
+/// aggregated per primary template when the report is written. The report
+/// is a tab-separated text file; utils/merge-instantiation-reports.py merges
+/// the reports of several translation units to find the specializations
+/// that are instantiated over and over again, which are good candidates for
+/// explicit instantiation declarations.
+class TemplateInstantiationReport {
+public:
+  /// \brief The accumulated cost of one template specialization.
+  struct Cost {
+    /// \brief The kind of specialization, "class" or "function".
+    const char *Kind;
+
+    /// \brief The qualified name of the template that was instantiated.
+    std::string Template;
+
+    /// \brief The number of times the specialization was instantiated.
+    unsigned Count;
+
+    /// \brief Time spent instantiating, in microseconds.
+    uint64_t SelfTime, TotalTime;
+
+    /// \brief Bytes allocated from the ASTContext while instantiating.
+    uint64_t SelfBytes, TotalBytes;
+
+    /// \brief The number of statements and declarations in the
+    /// instantiated definition.
+    unsigned Nodes;
+
+    /// \brief The deepest template instantiation stack seen when
+    /// instantiating this specialization.
+    unsigned MaxDepth;
+
+    Cost()
+      : Kind(""), Count(0), SelfTime(0), TotalTime(0), SelfBytes(0),
+        TotalBytes(0), Nodes(0), MaxDepth(0) { }
+  };
+
+  /// \brief RAII object that accounts for the instantiation of a single
+  /// specialization, if the report is enabled for the given Sema.
+  class Scope {
+    TemplateInstantiationReport *Report;
+    Sema &S;
+    const NamedDecl *Specialization;
+    const NamedDecl *Pattern;
+
+    Scope(const Scope &) LLVM_DELETED_FUNCTION;
+    void operator=(const Scope &) LLVM_DELETED_FUNCTION;
+
+  public:
+    Scope(Sema &S, const NamedDecl *Specialization, const NamedDecl *Pattern);
+    ~Scope();
+  };
+
+private:
+  /// \brief An instantiation that is in progress.
+  struct Frame {
+    uint64_t StartTime;
+    uint64_t StartBytes;
+    uint64_t ChildTime;
+    uint64_t ChildBytes;
+  };
+
+  SmallVector<Frame, 8> Stack;
+
+  /// \brief The costs of each specialization, keyed by its name including
+  /// template arguments.
+  llvm::StringMap<Cost> Specializations;
+
+  void begin(uint64_t Bytes);
+  void end(uint64_t Bytes, StringRef Name, const char *Kind,
+           StringRef Template, unsigned Nodes, unsigned Depth);
+
+public:
+  /// \brief Write the report, most expensive specializations first.
+  void write(raw_ostream &OS) const;
+};
+
+} // end namespace clang
+
+#endif
@@ -0,0 +1,90 @@
+//===- TypoCorrectionIndex.h - Typo correction candidates -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//===----------------------------------------------------------------------===//
+//
+//  This file defines TypoCorrectionIndex, which finds the identifiers that
+//  may be within a given edit distance of a typo without computing the edit
+//  distance to every identifier.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_CLANG_SEMA_TYPOCORRECTIONINDEX_H
+#define LLVM_CLANG_SEMA_TYPOCORRECTIONINDEX_H
+
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include <vector>
+
+namespace clang {
+
+/// \brief An index of the bigrams of every identifier in a translation unit.
+///
+/// An edit changes at most two of the bigrams of a word padded with a
+/// leading and a trailing marker, so a name within edit distance \c K of a
+/// typo must share all but \c 2K of the typo's distinct bigrams. Looking up
+/// the names that pass this filter visits only the posting lists of the
+/// typo's bigrams, instead of every identifier.
+///
+/// The index is built on first use. From then on, it listens to the
+/// identifier table for new identifiers, and indexes them on the next lookup.
+/// Names from an external identifier source are indexed once per generation
+/// of the external AST source.
+class TypoCorrectionIndex : public IdentifierCreationListener {
+  IdentifierTable &Idents;
+
+  /// \brief The indexed names.
+  std::vector<StringRef> Names;
+
+  /// \brief For each bigram, the indices of the names containing it.
+  llvm::DenseMap<unsigned, std::vector<unsigned> > Postings;
+
+  /// \brief Whether the entries of the identifier table have been indexed.
+  bool IndexedTable;
+
+  /// \brief The identifiers created since the last update.
+  std::vector<StringRef> NewIdentifiers;
+
+  /// \brief The generation of the external AST source whose identifiers
+  /// have been indexed, or ~0U if none have.
+  unsigned ExternalGeneration;
+
+  /// \brief The number of bigrams each name shares with the current typo,
+  /// and the names for which it is nonzero.
+  std::vector<unsigned> SharedBigrams;
+  SmallVector<unsigned, 64> TouchedNames;
+
+  void addName(StringRef Name);
+  void clear();
+
+  TypoCorrectionIndex(const TypoCorrectionIndex &) LLVM_DELETED_FUNCTION;
+  void operator=(const TypoCorrectionIndex &) LLVM_DELETED_FUNCTION;
+
+public:
+  explicit TypoCorrectionIndex(IdentifierTable &Idents);
+  ~TypoCorrectionIndex();
+
+  void IdentifierCreated(IdentifierInfo &II) override;
+
+  /// \brief Bring the index up to date with the identifier table and the
+  /// identifiers of \p External, whose contents are identified by
+  /// \p Generation.
+  void update(IdentifierInfoLookup *External, unsigned Generation);
+
+  /// \brief Find the indexed names that may be within edit distance
+  /// \p MaxDistance of \p Typo. Some of them may not be.
+  void lookup(StringRef Typo, unsigned MaxDistance,
+              SmallVectorImpl<StringRef> &Candidates);
+
+  /// \brief The number of indexed names.
+  unsigned size() const { return Names.size(); }
+};
+
+} // end namespace clang
+
+#endif
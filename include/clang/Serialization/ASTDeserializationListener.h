@@ -43,8 +43,15 @@ public:
   ///        qualifier bits already removed, and T is guaranteed to be locally
   ///        unqualified.
   virtual void TypeRead(serialization::TypeIdx Idx, QualType T) { }
+  /// \brief The record of a type is about to be read from the AST file. This
+  ///        is followed by TypeRead() for the same index, unless reading the
+  ///        type fails.
+  virtual void ReadingType(serialization::TypeIdx Idx) { }
   /// \brief A decl was deserialized from the AST file.
   virtual void DeclRead(serialization::DeclID ID, const Decl *D) { }
+  /// \brief The record of a decl is about to be read from the AST file. This
+  ///        is followed by DeclRead() for the same ID.
+  virtual void ReadingDecl(serialization::DeclID ID) { }
   /// \brief A selector was read from the AST file.
   virtual void SelectorRead(serialization::SelectorID iD, Selector Sel) { }
   /// \brief A macro definition was read from the AST file.
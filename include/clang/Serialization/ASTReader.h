@@ -1083,6 +1083,56 @@ private:
     ~ReadingKindTracker() { Reader.ReadingKind = PrevKind; }
   };
 
+public:
+  /// \brief Why declarations and types are currently being deserialized.
+  ///
+  /// This is only tracked for the benefit of deserialization listeners, and
+  /// reflects the outermost request that caused the deserialization.
+  enum DeserializationReason {
+    /// \brief The reason is not known, e.g., a declaration was requested
+    /// directly by its ID.
+    DR_Unknown,
+    /// \brief Looking up a name in a declaration context or the identifier
+    /// table.
+    DR_NameLookup,
+    /// \brief Enumerating the lexical contents of a declaration context.
+    DR_LexicalDecls,
+    /// \brief Completing the redeclaration chain of a declaration.
+    DR_RedeclChain,
+    /// \brief Deserializing the declarations that the AST file marks as
+    /// needed by the consumer as soon as it starts.
+    DR_Eager,
+    /// \brief Loading methods from the global Objective-C method pool.
+    DR_MethodPool
+  };
+
+private:
+  /// \brief Why declarations and types are currently being deserialized.
+  DeserializationReason CurrentDeserializationReason;
+
+  /// \brief RAII object to record the reason for deserializing, unless an
+  /// outer request has already recorded one.
+  class DeserializationReasonTracker {
+    ASTReader &Reader;
+    DeserializationReason PrevReason;
+
+    DeserializationReasonTracker(const DeserializationReasonTracker &)
+        LLVM_DELETED_FUNCTION;
+    void operator=(const DeserializationReasonTracker &) LLVM_DELETED_FUNCTION;
+
+  public:
+    DeserializationReasonTracker(DeserializationReason NewReason,
+                                 ASTReader &reader)
+      : Reader(reader), PrevReason(Reader.CurrentDeserializationReason) {
+      if (PrevReason == DR_Unknown)
+        Reader.CurrentDeserializationReason = NewReason;
+    }
+
+    ~DeserializationReasonTracker() {
+      Reader.CurrentDeserializationReason = PrevReason;
+    }
+  };
+
   /// \brief Suggested contents of the predefines buffer, after this
   /// PCH file has been processed.
   ///
@@ -1648,6 +1698,16 @@ public:
   /// if the declaration is not from a module file.
   ModuleFile *getOwningModuleFile(const Decl *D);
 
+  /// \brief Retrieve the module file that owns the type with the given
+  /// index, or NULL if the type is predefined.
+  ModuleFile *getOwningModuleFile(serialization::TypeIdx Idx);
+
+  /// \brief Retrieve the reason why declarations and types are currently
+  /// being deserialized.
+  DeserializationReason getDeserializationReason() const {
+    return CurrentDeserializationReason;
+  }
+
   /// \brief Get the best name we know for the module that owns the given
   /// declaration, or an empty string if the declaration is not from a module.
   std::string getOwningModuleNameForDiagnostic(const Decl *D);
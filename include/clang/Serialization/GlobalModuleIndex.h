@@ -8,9 +8,10 @@
 //===----------------------------------------------------------------------===//
 //
 // This file defines the GlobalModuleIndex class, which manages a global index
-// containing all of the identifiers known to the various modules within a given
-// subdirectory of the module cache. It is used to improve the performance of
-// queries such as "do any modules know about this identifier?"
+// containing all of the identifiers and Objective-C selectors known to the
+// various modules within a given subdirectory of the module cache. It is used
+// to improve the performance of queries such as "do any modules know about
+// this identifier?"
 //
 //===----------------------------------------------------------------------===//
 #ifndef LLVM_CLANG_SERIALIZATION_GLOBALMODULEINDEX_H
@@ -34,6 +35,7 @@ namespace clang {
 class DirectoryEntry;
 class FileEntry;
 class FileManager;
+class GlobalModuleIndexBuilder;
 class IdentifierIterator;
 
 namespace serialization {
@@ -68,9 +70,15 @@ class GlobalModuleIndex {
   /// GlobalModuleIndex.
   void *IdentifierIndex;
 
+  /// \brief The selector hash table.
+  ///
+  /// This pointer actually points to a SelectorIndexTable object, which is
+  /// only accessible within the implementation of GlobalModuleIndex.
+  void *SelectorIndex;
+
   /// \brief Information about a given module file.
   struct ModuleInfo {
-    ModuleInfo() : File(), Size(), ModTime() { }
+    ModuleInfo() : File(), Size(), ModTime(), SelectorsIndexed() { }
 
     /// \brief The module file, once it has been resolved.
     ModuleFile *File;
@@ -88,6 +96,11 @@ class GlobalModuleIndex {
     /// \brief The module IDs on which this module directly depends.
     /// FIXME: We don't really need a vector here.
     llvm::SmallVector<unsigned, 4> Dependencies;
+
+    /// \brief Whether every selector known to this module file is recorded in
+    /// the selector index. If not, selector lookups always have to search
+    /// this module file.
+    bool SelectorsIndexed;
   };
 
   /// \brief A mapping from module IDs to information about each module.
@@ -113,7 +126,14 @@ class GlobalModuleIndex {
   /// \brief The number of identifier lookup hits, where we recognize the
   /// identifier.
   unsigned NumIdentifierLookupHits;
-  
+
+  /// \brief The number of selector lookups we performed.
+  unsigned NumSelectorLookups;
+
+  /// \brief The number of selector lookup hits, where we recognize the
+  /// selector.
+  unsigned NumSelectorLookupHits;
+
   /// \brief Internal constructor. Use \c readIndex() to read an index.
   explicit GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                              llvm::BitstreamCursor Cursor);
@@ -121,6 +141,8 @@ class GlobalModuleIndex {
   GlobalModuleIndex(const GlobalModuleIndex &) LLVM_DELETED_FUNCTION;
   GlobalModuleIndex &operator=(const GlobalModuleIndex &) LLVM_DELETED_FUNCTION;
 
+  friend class GlobalModuleIndexBuilder;
+
 public:
   ~GlobalModuleIndex();
 
@@ -177,6 +199,17 @@ public:
   /// \returns true if the identifier is known to the index, false otherwise.
   bool lookupIdentifier(StringRef Name, HitSet &Hits);
 
+  /// \brief Look for all of the module files whose global method pool may
+  /// contain methods with the given Objective-C selector.
+  ///
+  /// \param Name The spelling of the selector, e.g., "initWithFoo:bar:".
+  ///
+  /// \param Hits Will be populated with the set of module files that may
+  /// have information about this selector.
+  ///
+  /// \returns true if the selector index was consulted, false otherwise.
+  bool lookupSelector(StringRef Name, HitSet &Hits);
+
   /// \brief Note that the given module file has been loaded.
   ///
   /// \returns false if the global module index has information about this
@@ -191,6 +224,10 @@ public:
 
   /// \brief Write a global index into the given
   ///
+  /// If an index already exists, the information it holds about module files
+  /// that have not changed since it was written is reused rather than
+  /// reloading those module files.
+  ///
   /// \param FileMgr The file manager to use to load module files.
   ///
   /// \param Path The path to the directory containing module files, into
@@ -13,12 +13,15 @@
 
 #include "clang/AST/ASTContext.h"
 #include "CXXABI.h"
+#include "ConstexprInterpreter.h"
+#include "clang/AST/ASTMemoryProfile.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/CharUnits.h"
 #include "clang/AST/Comment.h"
 #include "clang/AST/CommentCommandTraits.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclContextInternals.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
@@ -60,6 +63,13 @@ enum FloatingRank {
   HalfRank, FloatRank, DoubleRank, LongDoubleRank
 };
 
+void ASTContext::addComment(const RawComment &RC) {
+  assert(LangOpts.RetainCommentsFromSystemHeaders ||
+         !SourceMgr.isInSystemHeader(RC.getSourceRange().getBegin()));
+  ASTMemoryProfile::CategoryScope Scope(*this, ASTMemoryProfile::CAT_Comment);
+  Comments.addComment(RC, BumpAlloc);
+}
+
 RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (!CommentsLoaded && ExternalSource) {
     ExternalSource->ReadComments();
@@ -433,6 +443,7 @@ comments::FullComment *ASTContext::cloneFullComment(comments::FullComment *FC,
 
 comments::FullComment *ASTContext::getLocalCommentForDeclUncached(const Decl *D) const {
   const RawComment *RC = getRawCommentForDeclNoCache(D);
+  ASTMemoryProfile::CategoryScope Scope(*this, ASTMemoryProfile::CAT_Comment);
   return RC ? RC->parse(*this, nullptr, D) : nullptr;
 }
 
@@ -441,6 +452,7 @@ comments::FullComment *ASTContext::getCommentForDecl(
                                               const Preprocessor *PP) const {
   if (D->isInvalidDecl())
     return nullptr;
+  ASTMemoryProfile::CategoryScope Scope(*this, ASTMemoryProfile::CAT_Comment);
   D = adjustDeclToTemplate(D);
   
   const Decl *Canonical = D->getCanonicalDecl();
@@ -857,6 +869,9 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  llvm::errs() << "\n*** Lookup Table Stats:\n";
+  StoredDeclsMap::PrintStats(LastSDM.getPointer());
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -1973,8 +1988,10 @@ TypeSourceInfo *ASTContext::CreateTypeSourceInfo(QualType T,
            "incorrect data size provided to CreateTypeSourceInfo!");
 
   TypeSourceInfo *TInfo =
-    (TypeSourceInfo*)BumpAlloc.Allocate(sizeof(TypeSourceInfo) + DataSize, 8);
+    (TypeSourceInfo*)Allocate(sizeof(TypeSourceInfo) + DataSize, 8);
   new (TInfo) TypeSourceInfo(T);
+  if (MemoryProfile)
+    MemoryProfile->noteNode(ASTMemoryProfile::CAT_TypeLoc, TInfo);
   return TInfo;
 }
 
@@ -8075,6 +8092,18 @@ MangleContext *ASTContext::createMangleContext() {
 
 CXXABI::~CXXABI() {}
 
+void ASTContext::enableMemoryProfile() {
+  MemoryProfile.reset(new ASTMemoryProfile(*this));
+}
+
+void ASTContext::disableMemoryProfile() {
+  MemoryProfile.reset();
+}
+
+void ASTContext::noteAllocation(const void *Ptr, size_t Size) const {
+  MemoryProfile->noteAllocation(Ptr, Size);
+}
+
 size_t ASTContext::getSideTableAllocatedMemory() const {
   return ASTRecordLayouts.getMemorySize() +
          llvm::capacity_in_bytes(ObjCLayouts) +
@@ -8183,6 +8212,21 @@ ASTContext::getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
   return I == MaterializedTemporaryValues.end() ? nullptr : &I->second;
 }
 
+APValue *ASTContext::getConstexprCallResult(StringRef Key, bool MayCreate) {
+  llvm::StringMap<APValue>::iterator I = ConstexprCallResults.find(Key);
+  if (I != ConstexprCallResults.end())
+    return &I->second;
+  if (!MayCreate || ConstexprCallResults.size() >= LangOpts.ConstexprCacheSize)
+    return nullptr;
+  return &ConstexprCallResults[Key];
+}
+
+ConstexprInterpreter &ASTContext::getConstexprInterpreter() {
+  if (!ConstexprInterp)
+    ConstexprInterp.reset(new ConstexprInterpreter(*this));
+  return *ConstexprInterp;
+}
+
 bool ASTContext::AtomicUsesUnsupportedLibcall(const AtomicExpr *E) const {
   const llvm::Triple &T = getTargetInfo().getTriple();
   if (!T.isOSDarwin())
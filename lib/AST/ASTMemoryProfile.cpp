@@ -0,0 +1,268 @@
+//===--- ASTMemoryProfile.cpp - AST memory accounting ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements ASTMemoryProfile.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTMemoryProfile.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclContextInternals.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/TypeLoc.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace clang;
+
+/// The profile of the ASTContext whose nodes are being created. Like the
+/// statistics hooks that feed it, this is not thread-safe. It is reset when
+/// the profile is destroyed, at the end of each compilation that asked for
+/// a report.
+static ASTMemoryProfile *ActiveProfile = nullptr;
+
+static const char *getCategoryName(ASTMemoryProfile::Category C) {
+  switch (C) {
+  case ASTMemoryProfile::CAT_Decl: return "decl";
+  case ASTMemoryProfile::CAT_Stmt: return "stmt";
+  case ASTMemoryProfile::CAT_Type: return "type";
+  case ASTMemoryProfile::CAT_TypeLoc: return "typeloc";
+  case ASTMemoryProfile::CAT_Comment: return "comment";
+  case ASTMemoryProfile::CAT_Other: return "other";
+  case ASTMemoryProfile::NUM_CATEGORIES: break;
+  }
+  llvm_unreachable("Invalid category!");
+}
+
+ASTMemoryProfile::CategoryScope::CategoryScope(const ASTContext &Ctx,
+                                               Category C)
+  : Profile(Ctx.getMemoryProfile()) {
+  if (Profile) {
+    Previous = Profile->CurrentCategory;
+    Profile->switchCategory(C);
+  }
+}
+
+ASTMemoryProfile::CategoryScope::~CategoryScope() {
+  if (Profile)
+    Profile->switchCategory(Previous);
+}
+
+ASTMemoryProfile::ASTMemoryProfile(const ASTContext &Ctx)
+  : Ctx(Ctx), PreviousActive(ActiveProfile),
+    EnabledStatistics(!Decl::isStatisticsEnabled() ||
+                      !Stmt::isStatisticsEnabled()),
+    CurrentCategory(CAT_Other), RecordedBytes(0),
+    LastUnrecordedBytes(Ctx.getASTAllocatedBytes()) {
+  std::fill(UnrecordedBytes, UnrecordedBytes + NUM_CATEGORIES, 0);
+  ActiveProfile = this;
+  Decl::EnableStatistics();
+  Stmt::EnableStatistics();
+}
+
+ASTMemoryProfile::~ASTMemoryProfile() {
+  if (ActiveProfile == this)
+    ActiveProfile = PreviousActive;
+  if (EnabledStatistics && !PreviousActive) {
+    Decl::ResetStatistics();
+    Stmt::ResetStatistics();
+  }
+}
+
+ASTMemoryProfile *ASTMemoryProfile::getActive() {
+  return ActiveProfile;
+}
+
+void ASTMemoryProfile::noteNode(Category C, const void *Node) {
+  llvm::DenseMap<const void *, Allocation>::iterator I =
+      Allocations.find(Node);
+
+  // Declarations loaded from an AST file are preceded by an 8-byte prefix
+  // holding their ID.
+  if (I == Allocations.end() && C == CAT_Decl)
+    I = Allocations.find(static_cast<const char *>(Node) - 8);
+
+  // Nodes created on the stack, or by another ASTContext, are not ours.
+  if (I == Allocations.end())
+    return;
+
+  I->second.Cat = C;
+  NodeRecord R = { Node, I->second.Size, C };
+  Nodes.push_back(R);
+}
+
+void ASTMemoryProfile::switchCategory(Category C) {
+  uint64_t Unrecorded = Ctx.getASTAllocatedBytes() - RecordedBytes;
+  UnrecordedBytes[CurrentCategory] += Unrecorded - LastUnrecordedBytes;
+  LastUnrecordedBytes = Unrecorded;
+  CurrentCategory = C;
+}
+
+namespace {
+struct Cost {
+  uint64_t Count;
+  uint64_t Bytes;
+  uint64_t CategoryBytes[ASTMemoryProfile::NUM_CATEGORIES];
+
+  Cost() : Count(0), Bytes(0) {
+    std::fill(CategoryBytes,
+              CategoryBytes + ASTMemoryProfile::NUM_CATEGORIES, 0);
+  }
+
+  void add(ASTMemoryProfile::Category C, uint64_t Size) {
+    ++Count;
+    Bytes += Size;
+    CategoryBytes[C] += Size;
+  }
+};
+
+typedef std::pair<unsigned, const char *> KindKey;
+typedef std::pair<KindKey, Cost> KindEntry;
+typedef std::pair<StringRef, Cost> FileEntryCost;
+
+bool compareKinds(const KindEntry &LHS, const KindEntry &RHS) {
+  if (LHS.second.Bytes != RHS.second.Bytes)
+    return LHS.second.Bytes > RHS.second.Bytes;
+  if (LHS.first.first != RHS.first.first)
+    return LHS.first.first < RHS.first.first;
+  return strcmp(LHS.first.second, RHS.first.second) < 0;
+}
+
+bool compareFiles(const FileEntryCost &LHS, const FileEntryCost &RHS) {
+  if (LHS.second.Bytes != RHS.second.Bytes)
+    return LHS.second.Bytes > RHS.second.Bytes;
+  return LHS.first < RHS.first;
+}
+}
+
+void ASTMemoryProfile::write(raw_ostream &OS) {
+  // Attribute the memory allocated since the last change of category.
+  switchCategory(CurrentCategory);
+
+  // Types are never deallocated, and are all listed by the ASTContext.
+  for (const Type *T : Ctx.Types)
+    noteNode(CAT_Type, T);
+
+  Cost Categories[NUM_CATEGORIES];
+  for (llvm::DenseMap<const void *, Allocation>::iterator
+           I = Allocations.begin(), E = Allocations.end();
+       I != E; ++I)
+    Categories[I->second.Cat].add(I->second.Cat, I->second.Size);
+
+  // Break the nodes down by kind and by the file they were written in.
+  const SourceManager &SM = Ctx.getSourceManager();
+  llvm::DenseMap<KindKey, Cost> Kinds;
+  llvm::DenseMap<unsigned, std::pair<FileID, Cost> > FileIDs;
+  Cost Redeclarations;
+  for (const NodeRecord &R : Nodes) {
+    const char *Name;
+    SourceLocation Loc;
+    switch (R.Cat) {
+    case CAT_Decl: {
+      const Decl *D = static_cast<const Decl *>(R.Node);
+      Name = D->getDeclKindName();
+      Loc = D->getLocation();
+      if (D->getPreviousDecl())
+        Redeclarations.add(CAT_Decl, R.Size);
+      break;
+    }
+    case CAT_Stmt: {
+      const Stmt *S = static_cast<const Stmt *>(R.Node);
+      Name = S->getStmtClassName();
+      Loc = S->getLocStart();
+      break;
+    }
+    case CAT_Type:
+      Name = static_cast<const Type *>(R.Node)->getTypeClassName();
+      break;
+    case CAT_TypeLoc: {
+      const TypeSourceInfo *TSI = static_cast<const TypeSourceInfo *>(R.Node);
+      Name = TSI->getType()->getTypeClassName();
+      Loc = TSI->getTypeLoc().getBeginLoc();
+      break;
+    }
+    default:
+      llvm_unreachable("unexpected node category");
+    }
+
+    Kinds[KindKey(R.Cat, Name)].add(R.Cat, R.Size);
+
+    FileID FID;
+    if (Loc.isValid())
+      FID = SM.getFileID(SM.getExpansionLoc(Loc));
+    std::pair<FileID, Cost> &F = FileIDs[FID.getHashValue()];
+    F.first = FID;
+    F.second.add(R.Cat, R.Size);
+  }
+
+  // A header included several times has a FileID for each inclusion.
+  llvm::StringMap<Cost> Files;
+  for (llvm::DenseMap<unsigned, std::pair<FileID, Cost> >::iterator
+           I = FileIDs.begin(), E = FileIDs.end();
+       I != E; ++I) {
+    StringRef Name = "<no file>";
+    if (!I->second.first.isInvalid()) {
+      if (const FileEntry *FE = SM.getFileEntryForID(I->second.first))
+        Name = FE->getName();
+      else
+        Name = "<built-in>";
+    }
+    Cost &C = Files[Name];
+    const Cost &FC = I->second.second;
+    C.Count += FC.Count;
+    C.Bytes += FC.Bytes;
+    for (unsigned Cat = 0; Cat != NUM_CATEGORIES; ++Cat)
+      C.CategoryBytes[Cat] += FC.CategoryBytes[Cat];
+  }
+
+  // Summary, by category.
+  OS << "# category\tname\tcount\tbytes\n";
+  for (unsigned Cat = 0; Cat != NUM_CATEGORIES; ++Cat) {
+    Category C = static_cast<Category>(Cat);
+    OS << "category\t" << getCategoryName(C) << '\t'
+       << Categories[Cat].Count << '\t'
+       << Categories[Cat].Bytes + UnrecordedBytes[Cat] << '\n';
+  }
+  OS << "category\tredeclaration\t" << Redeclarations.Count << '\t'
+     << Redeclarations.Bytes << '\n';
+  unsigned NumLookupTables;
+  uint64_t LookupTableBytes =
+      StoredDeclsMap::getChainMemorySize(Ctx.LastSDM.getPointer(),
+                                         NumLookupTables);
+  OS << "category\tlookup-table\t" << NumLookupTables << '\t'
+     << LookupTableBytes << '\n';
+  OS << "category\tallocator-slack\t0\t"
+     << Ctx.getASTAllocatedMemory() - Ctx.getASTAllocatedBytes() << '\n';
+
+  // By node kind.
+  std::vector<KindEntry> KindEntries(Kinds.begin(), Kinds.end());
+  std::sort(KindEntries.begin(), KindEntries.end(), compareKinds);
+  OS << "# kind\tcategory\tname\tcount\tbytes\n";
+  for (const KindEntry &K : KindEntries)
+    OS << "kind\t" << getCategoryName(static_cast<Category>(K.first.first))
+       << '\t' << K.first.second << '\t' << K.second.Count << '\t'
+       << K.second.Bytes << '\n';
+
+  // By file.
+  std::vector<FileEntryCost> FileEntries;
+  for (llvm::StringMap<Cost>::iterator I = Files.begin(), E = Files.end();
+       I != E; ++I)
+    FileEntries.push_back(FileEntryCost(I->getKey(), I->getValue()));
+  std::sort(FileEntries.begin(), FileEntries.end(), compareFiles);
+  OS << "# file\tname\tnodes\tbytes\tdecl-bytes\tstmt-bytes\ttypeloc-bytes\n";
+  for (const FileEntryCost &F : FileEntries)
+    OS << "file\t" << F.first << '\t' << F.second.Count << '\t'
+       << F.second.Bytes << '\t' << F.second.CategoryBytes[CAT_Decl] << '\t'
+       << F.second.CategoryBytes[CAT_Stmt] << '\t'
+       << F.second.CategoryBytes[CAT_TypeLoc] << '\n';
+}
@@ -0,0 +1,1054 @@
+//===--- ConstexprInterpreter.cpp - Bytecode constexpr evaluation ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the bytecode compiler and interpreter for constexpr
+// function calls, used with -fexperimental-constexpr-interpreter.
+//
+// Values are held in 64-bit slots, normalized to the width of their type:
+// sign-extended if the type is signed and zero-extended otherwise. Each
+// instruction that depends on the type of its operands records its width
+// and signedness.
+//
+// The interpreter must produce exactly the result that the AST-walking
+// evaluator would produce for calls that are constant expressions, and must
+// fail on every call that is not. It fails conservatively: whenever the
+// AST-walking evaluator would produce a diagnostic, or might, the
+// interpreter gives up and leaves the call to it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprInterpreter.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include <limits>
+
+using namespace clang;
+
+namespace {
+enum Opcode : unsigned char {
+  OP_Step,        ///< Count an evaluation step.
+  OP_Fail,        ///< Give up on the evaluation.
+  OP_Const,       ///< Push Arg.
+  OP_Load,        ///< Push the value of slot Arg.
+  OP_Store,       ///< Pop a value into slot Arg.
+  OP_Global,      ///< Push the value of the constexpr variable Globals[Arg].
+  OP_Dup,         ///< Push a copy of the top of the stack.
+  OP_Pop,         ///< Pop a value.
+  OP_Swap,        ///< Swap the top two values.
+  OP_Add, OP_Sub, OP_Mul, OP_Div, OP_Rem, OP_Shl, OP_Shr,
+  OP_And, OP_Or, OP_Xor,
+  OP_LT, OP_GT, OP_LE, OP_GE, OP_EQ, OP_NE,
+  OP_Neg, OP_Not, OP_LNot,
+  OP_Cast,        ///< Convert the top of the stack to the instruction's type.
+  OP_ToBool,      ///< Convert the top of the stack to bool.
+  OP_Jump,        ///< Jump to Arg.
+  OP_JumpIfFalse, ///< Pop a value, and jump to Arg if it is zero.
+  OP_JumpIfTrue,  ///< Pop a value, and jump to Arg if it is non-zero.
+  OP_Call,        ///< Call Callees[Arg] with the arguments on the stack.
+  OP_Ret          ///< Return the value on top of the stack.
+};
+
+/// A single bytecode instruction.
+struct Instr {
+  Opcode Op;
+  /// Whether the operands are of signed type.
+  bool Signed;
+  /// For shifts, whether the shift amount is of signed type.
+  bool RHSSigned;
+  /// The width of the operands.
+  unsigned char Width;
+  int64_t Arg;
+};
+}
+
+struct ConstexprInterpreter::Function {
+  std::vector<Instr> Code;
+
+  /// The width and signedness of each parameter, which occupy the first
+  /// slots of the frame.
+  SmallVector<std::pair<unsigned, bool>, 4> Params;
+
+  /// The number of slots needed for the parameters and local variables.
+  unsigned NumSlots;
+
+  /// The width and signedness of the result.
+  unsigned ResultWidth;
+  bool ResultSigned;
+
+  /// The functions called from this function.
+  std::vector<const FunctionDecl *> Callees;
+
+  /// The constexpr variables read by this function.
+  std::vector<const VarDecl *> Globals;
+
+  Function() : NumSlots(0), ResultWidth(0), ResultSigned(false) { }
+};
+
+/// Get the width and signedness of the values of type \p T, if they can be
+/// held in a slot.
+static bool getIntType(const ASTContext &Ctx, QualType T, unsigned &Width,
+                       bool &Signed) {
+  if (T.isVolatileQualified() || !T->isIntegralType(Ctx) ||
+      T->isEnumeralType())
+    return false;
+  Width = Ctx.getIntWidth(T);
+  Signed = T->isSignedIntegerOrEnumerationType();
+  return Width <= 64;
+}
+
+/// Truncate \p V to \p Width bits, and sign- or zero-extend it back to 64.
+static uint64_t normalize(uint64_t V, unsigned Width, bool Signed) {
+  if (Width >= 64)
+    return V;
+  uint64_t Mask = (uint64_t(1) << Width) - 1;
+  V &= Mask;
+  if (Signed && (V >> (Width - 1)))
+    V |= ~Mask;
+  return V;
+}
+
+/// Determine whether \p V is the smallest signed value of \p Width bits.
+static bool isMinSigned(uint64_t V, unsigned Width) {
+  if (Width >= 64)
+    return V == uint64_t(1) << 63;
+  return int64_t(V) == -(int64_t(1) << (Width - 1));
+}
+
+/// Determine whether \p V fits in a signed value of \p Width bits.
+static bool fitsSigned(int64_t V, unsigned Width) {
+  if (Width >= 64)
+    return true;
+  int64_t Max = (int64_t(1) << (Width - 1)) - 1;
+  return V >= -Max - 1 && V <= Max;
+}
+
+/// Perform a 64-bit signed addition, subtraction or multiplication.
+///
+/// \returns true if it overflowed.
+static bool signedOverflow(Opcode Op, int64_t A, int64_t B, int64_t &Result) {
+  uint64_t UA = A, UB = B;
+  switch (Op) {
+  case OP_Add:
+    Result = int64_t(UA + UB);
+    return (A >= 0) == (B >= 0) && (Result >= 0) != (A >= 0);
+  case OP_Sub:
+    Result = int64_t(UA - UB);
+    return (A >= 0) != (B >= 0) && (Result >= 0) != (A >= 0);
+  case OP_Mul: {
+    Result = 0;
+    if (A == 0 || B == 0)
+      return false;
+    uint64_t MA = A < 0 ? 0 - UA : UA;
+    uint64_t MB = B < 0 ? 0 - UB : UB;
+    if (MA > std::numeric_limits<uint64_t>::max() / MB)
+      return true;
+    uint64_t M = MA * MB;
+    if ((A < 0) != (B < 0)) {
+      if (M > uint64_t(1) << 63)
+        return true;
+      Result = int64_t(0 - M);
+    } else {
+      if (M > uint64_t(std::numeric_limits<int64_t>::max()))
+        return true;
+      Result = int64_t(M);
+    }
+    return false;
+  }
+  default:
+    llvm_unreachable("not an arithmetic operation");
+  }
+}
+
+/// Evaluate a binary operation on two slot values.
+///
+/// \returns false if the operation is not a constant expression.
+static bool evaluateBinOp(const Instr &I, uint64_t L, uint64_t R,
+                          uint64_t &Result) {
+  unsigned W = I.Width;
+  bool S = I.Signed;
+  switch (I.Op) {
+  case OP_Add:
+  case OP_Sub:
+  case OP_Mul: {
+    if (!S) {
+      uint64_t V = I.Op == OP_Add ? L + R : I.Op == OP_Sub ? L - R : L * R;
+      Result = normalize(V, W, false);
+      return true;
+    }
+    int64_t V;
+    if (signedOverflow(I.Op, int64_t(L), int64_t(R), V) || !fitsSigned(V, W))
+      return false;
+    Result = normalize(uint64_t(V), W, true);
+    return true;
+  }
+
+  case OP_Div:
+  case OP_Rem:
+    if (R == 0)
+      return false;
+    if (!S) {
+      Result = I.Op == OP_Div ? L / R : L % R;
+      return true;
+    }
+    if (int64_t(R) == -1 && isMinSigned(L, W))
+      return false;
+    Result = normalize(uint64_t(I.Op == OP_Div ? int64_t(L) / int64_t(R)
+                                               : int64_t(L) % int64_t(R)),
+                       W, true);
+    return true;
+
+  case OP_Shl:
+  case OP_Shr: {
+    // Negative and too-large shift amounts are not constant expressions.
+    if ((I.RHSSigned && int64_t(R) < 0) || R >= W)
+      return false;
+    unsigned SA = unsigned(R);
+    if (I.Op == OP_Shl) {
+      // A signed left shift must have a non-negative operand, and must not
+      // shift out any set bits.
+      if (S && (int64_t(L) < 0 || (W - SA < 64 && (L >> (W - SA)) != 0)))
+        return false;
+      Result = normalize(L << SA, W, S);
+    } else if (S && int64_t(L) < 0) {
+      Result = ~(~L >> SA);
+    } else {
+      Result = L >> SA;
+    }
+    return true;
+  }
+
+  case OP_And: Result = L & R; return true;
+  case OP_Or:  Result = L | R; return true;
+  case OP_Xor: Result = L ^ R; return true;
+
+  case OP_LT: Result = S ? int64_t(L) < int64_t(R) : L < R; return true;
+  case OP_GT: Result = S ? int64_t(L) > int64_t(R) : L > R; return true;
+  case OP_LE: Result = S ? int64_t(L) <= int64_t(R) : L <= R; return true;
+  case OP_GE: Result = S ? int64_t(L) >= int64_t(R) : L >= R; return true;
+  case OP_EQ: Result = L == R; return true;
+  case OP_NE: Result = L != R; return true;
+
+  default:
+    llvm_unreachable("not a binary operation");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Compiler
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Compiles the body of a single constexpr function to bytecode.
+///
+/// Every Stmt that the AST-walking evaluator passes to EvaluateStmt costs
+/// one step there, so the compiler emits an OP_Step at the start of the code
+/// for each such statement.
+class FunctionCompiler {
+  const ASTContext &Ctx;
+  ConstexprInterpreter::Function &F;
+
+  /// The slot of each parameter and local variable.
+  llvm::DenseMap<const VarDecl *, unsigned> Slots;
+
+  /// The jumps to patch once the target of the 'break' and 'continue'
+  /// statements of each enclosing loop is known.
+  struct Loop {
+    SmallVector<size_t, 4> Breaks;
+    SmallVector<size_t, 4> Continues;
+  };
+  SmallVector<Loop, 4> Loops;
+
+  size_t emit(Opcode Op, int64_t Arg = 0, unsigned Width = 0,
+              bool Signed = false, bool RHSSigned = false) {
+    Instr I = { Op, Signed, RHSSigned, (unsigned char)Width, Arg };
+    F.Code.push_back(I);
+    return F.Code.size() - 1;
+  }
+
+  size_t here() const { return F.Code.size(); }
+  void patch(size_t Jump, size_t Target) { F.Code[Jump].Arg = Target; }
+
+  void finishLoop(size_t ContinueTarget, size_t BreakTarget) {
+    for (size_t Jump : Loops.back().Continues)
+      patch(Jump, ContinueTarget);
+    for (size_t Jump : Loops.back().Breaks)
+      patch(Jump, BreakTarget);
+    Loops.pop_back();
+  }
+
+  bool compileStmt(const Stmt *S);
+  bool compileVarDecl(const VarDecl *VD);
+  bool compileCond(const VarDecl *CondVar, const Expr *Cond);
+  bool compileIgnored(const Expr *E);
+  bool compileRValue(const Expr *E);
+  bool compileLValue(const Expr *E, unsigned &Slot);
+  bool compileLoad(const Expr *E);
+  bool compileCast(const CastExpr *E);
+  bool compileBinOp(BinaryOperatorKind Opc, QualType LHSType,
+                    QualType RHSType);
+  bool isModifiable(const Expr *E);
+  bool compileIncDec(const UnaryOperator *E, unsigned Slot);
+  bool compileCall(const CallExpr *E);
+
+public:
+  FunctionCompiler(const ASTContext &Ctx, ConstexprInterpreter::Function &F)
+    : Ctx(Ctx), F(F) { }
+
+  bool compile(const FunctionDecl *FD, const Stmt *Body);
+};
+}
+
+bool FunctionCompiler::compile(const FunctionDecl *FD, const Stmt *Body) {
+  if (!Body || FD->isVariadic() ||
+      !getIntType(Ctx, FD->getReturnType(), F.ResultWidth, F.ResultSigned))
+    return false;
+
+  for (const ParmVarDecl *P : FD->params()) {
+    unsigned Width;
+    bool Signed;
+    if (!getIntType(Ctx, P->getType(), Width, Signed))
+      return false;
+    Slots[P] = F.Params.size();
+    F.Params.push_back(std::make_pair(Width, Signed));
+  }
+  F.NumSlots = F.Params.size();
+
+  if (!compileStmt(Body))
+    return false;
+
+  // Flowing off the end of a function with a non-void return type is not a
+  // constant expression.
+  emit(OP_Fail);
+  return true;
+}
+
+bool FunctionCompiler::compileStmt(const Stmt *S) {
+  emit(OP_Step);
+
+  switch (S->getStmtClass()) {
+  default:
+    if (const Expr *E = dyn_cast<Expr>(S))
+      return compileIgnored(E);
+    return false;
+
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::CompoundStmtClass:
+    for (const auto *BI : cast<CompoundStmt>(S)->body())
+      if (!compileStmt(BI))
+        return false;
+    return true;
+
+  case Stmt::DeclStmtClass:
+    for (const auto *D : cast<DeclStmt>(S)->decls())
+      if (const VarDecl *VD = dyn_cast<VarDecl>(D))
+        if (!compileVarDecl(VD))
+          return false;
+    return true;
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetExpr = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetExpr || !compileRValue(RetExpr))
+      return false;
+    emit(OP_Ret);
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const IfStmt *IS = cast<IfStmt>(S);
+    if (!compileCond(IS->getConditionVariable(), IS->getCond()))
+      return false;
+    size_t ToElse = emit(OP_JumpIfFalse);
+    if (!compileStmt(IS->getThen()))
+      return false;
+    if (const Stmt *Else = IS->getElse()) {
+      size_t ToEnd = emit(OP_Jump);
+      patch(ToElse, here());
+      if (!compileStmt(Else))
+        return false;
+      patch(ToEnd, here());
+    } else {
+      patch(ToElse, here());
+    }
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const WhileStmt *WS = cast<WhileStmt>(S);
+    size_t Top = here();
+    if (!compileCond(WS->getConditionVariable(), WS->getCond()))
+      return false;
+    size_t ToExit = emit(OP_JumpIfFalse);
+    Loops.push_back(Loop());
+    if (!compileStmt(WS->getBody()))
+      return false;
+    emit(OP_Jump, Top);
+    finishLoop(Top, here());
+    patch(ToExit, here());
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const DoStmt *DS = cast<DoStmt>(S);
+    size_t Top = here();
+    Loops.push_back(Loop());
+    if (!compileStmt(DS->getBody()))
+      return false;
+    size_t Cond = here();
+    if (!compileCond(nullptr, DS->getCond()))
+      return false;
+    emit(OP_JumpIfTrue, Top);
+    finishLoop(Cond, here());
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const ForStmt *FS = cast<ForStmt>(S);
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+    size_t Top = here();
+    bool HasCond = FS->getCond() != nullptr;
+    size_t ToExit = 0;
+    if (HasCond) {
+      if (!compileCond(FS->getConditionVariable(), FS->getCond()))
+        return false;
+      ToExit = emit(OP_JumpIfFalse);
+    }
+    Loops.push_back(Loop());
+    if (!compileStmt(FS->getBody()))
+      return false;
+    size_t Inc = here();
+    if (FS->getInc() && !compileIgnored(FS->getInc()))
+      return false;
+    emit(OP_Jump, Top);
+    finishLoop(Inc, here());
+    if (HasCond)
+      patch(ToExit, here());
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Breaks.push_back(emit(OP_Jump));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Continues.push_back(emit(OP_Jump));
+    return true;
+  }
+}
+
+bool FunctionCompiler::compileVarDecl(const VarDecl *VD) {
+  // Like the AST-walking evaluator, ignore variables without local storage.
+  if (!VD->hasLocalStorage())
+    return true;
+
+  unsigned Width;
+  bool Signed;
+  const Expr *Init = VD->getInit();
+  if (!Init || !getIntType(Ctx, VD->getType(), Width, Signed) ||
+      !compileRValue(Init))
+    return false;
+
+  unsigned Slot = F.NumSlots++;
+  Slots[VD] = Slot;
+  emit(OP_Store, Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileCond(const VarDecl *CondVar, const Expr *Cond) {
+  if (CondVar && !compileVarDecl(CondVar))
+    return false;
+  return compileRValue(Cond);
+}
+
+bool FunctionCompiler::compileIgnored(const Expr *E) {
+  if (E->isGLValue()) {
+    unsigned Slot;
+    return compileLValue(E, Slot);
+  }
+
+  if (const ParenExpr *PE = dyn_cast<ParenExpr>(E))
+    return compileIgnored(PE->getSubExpr());
+  if (const CastExpr *CE = dyn_cast<CastExpr>(E))
+    if (CE->getCastKind() == CK_ToVoid)
+      return compileIgnored(CE->getSubExpr());
+
+  if (!compileRValue(E))
+    return false;
+  emit(OP_Pop);
+  return true;
+}
+
+bool FunctionCompiler::compileRValue(const Expr *E) {
+  unsigned Width;
+  bool Signed;
+  if (!E->isRValue() || !getIntType(Ctx, E->getType(), Width, Signed))
+    return false;
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::IntegerLiteralClass:
+    emit(OP_Const, normalize(cast<IntegerLiteral>(E)->getValue().getZExtValue(),
+                             Width, Signed));
+    return true;
+
+  case Stmt::CharacterLiteralClass:
+    emit(OP_Const,
+         normalize(cast<CharacterLiteral>(E)->getValue(), Width, Signed));
+    return true;
+
+  case Stmt::CXXBoolLiteralExprClass:
+    emit(OP_Const, cast<CXXBoolLiteralExpr>(E)->getValue());
+    return true;
+
+  case Stmt::ParenExprClass:
+    return compileRValue(cast<ParenExpr>(E)->getSubExpr());
+
+  case Stmt::CXXDefaultArgExprClass:
+    return compileRValue(cast<CXXDefaultArgExpr>(E)->getExpr());
+
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return compileRValue(
+        cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement());
+
+  case Stmt::InitListExprClass: {
+    const InitListExpr *ILE = cast<InitListExpr>(E);
+    return ILE->getNumInits() == 1 && compileRValue(ILE->getInit(0));
+  }
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+    return compileCast(cast<CastExpr>(E));
+
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(E);
+    const Expr *Sub = UO->getSubExpr();
+    switch (UO->getOpcode()) {
+    default:
+      return false;
+    case UO_Plus:
+      return compileRValue(Sub);
+    case UO_Minus:
+      if (!compileRValue(Sub))
+        return false;
+      emit(OP_Neg, 0, Width, Signed);
+      return true;
+    case UO_Not:
+      if (!compileRValue(Sub))
+        return false;
+      emit(OP_Not, 0, Width, Signed);
+      return true;
+    case UO_LNot:
+      if (!compileRValue(Sub))
+        return false;
+      emit(OP_LNot);
+      return true;
+    case UO_PostInc:
+    case UO_PostDec: {
+      // Leave the old value on the stack.
+      unsigned Slot;
+      if (!compileLValue(Sub, Slot))
+        return false;
+      emit(OP_Load, Slot);
+      emit(OP_Dup);
+      return compileIncDec(UO, Slot);
+    }
+    }
+  }
+
+  case Stmt::BinaryOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(E);
+    switch (BO->getOpcode()) {
+    case BO_Comma:
+      return compileIgnored(BO->getLHS()) && compileRValue(BO->getRHS());
+
+    case BO_LAnd:
+    case BO_LOr: {
+      // Short-circuit, leaving the value of the LHS on the stack.
+      if (!compileRValue(BO->getLHS()))
+        return false;
+      emit(OP_Dup);
+      size_t ToEnd =
+          emit(BO->getOpcode() == BO_LAnd ? OP_JumpIfFalse : OP_JumpIfTrue);
+      emit(OP_Pop);
+      if (!compileRValue(BO->getRHS()))
+        return false;
+      patch(ToEnd, here());
+      return true;
+    }
+
+    default:
+      return compileRValue(BO->getLHS()) && compileRValue(BO->getRHS()) &&
+             compileBinOp(BO->getOpcode(), BO->getLHS()->getType(),
+                          BO->getRHS()->getType());
+    }
+  }
+
+  case Stmt::ConditionalOperatorClass: {
+    const ConditionalOperator *CO = cast<ConditionalOperator>(E);
+    if (!compileRValue(CO->getCond()))
+      return false;
+    size_t ToFalse = emit(OP_JumpIfFalse);
+    if (!compileRValue(CO->getTrueExpr()))
+      return false;
+    size_t ToEnd = emit(OP_Jump);
+    patch(ToFalse, here());
+    if (!compileRValue(CO->getFalseExpr()))
+      return false;
+    patch(ToEnd, here());
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return compileCall(cast<CallExpr>(E));
+  }
+}
+
+bool FunctionCompiler::compileCast(const CastExpr *E) {
+  unsigned Width;
+  bool Signed;
+  getIntType(Ctx, E->getType(), Width, Signed);
+
+  const Expr *Sub = E->getSubExpr();
+  switch (E->getCastKind()) {
+  default:
+    return false;
+  case CK_LValueToRValue:
+    return compileLoad(Sub);
+  case CK_NoOp:
+    return compileRValue(Sub);
+  case CK_IntegralCast:
+    if (!compileRValue(Sub))
+      return false;
+    emit(OP_Cast, 0, Width, Signed);
+    return true;
+  case CK_IntegralToBoolean:
+    if (!compileRValue(Sub))
+      return false;
+    emit(OP_ToBool);
+    return true;
+  }
+}
+
+bool FunctionCompiler::compileLoad(const Expr *E) {
+  unsigned Width;
+  bool Signed;
+  if (!getIntType(Ctx, E->getType(), Width, Signed))
+    return false;
+
+  // Reads of constexpr variables are resolved when they are executed, since
+  // their values might not have been computed yet.
+  if (const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens())) {
+    const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+    if (VD && !Slots.count(VD)) {
+      if (VD->hasLocalStorage() || !VD->isConstexpr())
+        return false;
+      F.Globals.push_back(VD);
+      emit(OP_Global, F.Globals.size() - 1, Width, Signed);
+      return true;
+    }
+  }
+
+  unsigned Slot;
+  if (!compileLValue(E, Slot))
+    return false;
+  emit(OP_Load, Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileLValue(const Expr *E, unsigned &Slot) {
+  unsigned Width;
+  bool Signed;
+  if (!E->isGLValue() || !getIntType(Ctx, E->getType(), Width, Signed))
+    return false;
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::ParenExprClass:
+    return compileLValue(cast<ParenExpr>(E)->getSubExpr(), Slot);
+
+  case Stmt::DeclRefExprClass: {
+    const VarDecl *VD = dyn_cast<VarDecl>(cast<DeclRefExpr>(E)->getDecl());
+    llvm::DenseMap<const VarDecl *, unsigned>::iterator I = Slots.find(VD);
+    if (!VD || I == Slots.end())
+      return false;
+    Slot = I->second;
+    return true;
+  }
+
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(E);
+    if (UO->getOpcode() != UO_PreInc && UO->getOpcode() != UO_PreDec)
+      return false;
+    if (!compileLValue(UO->getSubExpr(), Slot))
+      return false;
+    emit(OP_Load, Slot);
+    return compileIncDec(UO, Slot);
+  }
+
+  case Stmt::BinaryOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(E);
+    if (BO->getOpcode() == BO_Comma)
+      return compileIgnored(BO->getLHS()) && compileLValue(BO->getRHS(), Slot);
+    if (BO->getOpcode() != BO_Assign || !isModifiable(BO->getLHS()) ||
+        !compileLValue(BO->getLHS(), Slot) || !compileRValue(BO->getRHS()))
+      return false;
+    emit(OP_Store, Slot);
+    return true;
+  }
+
+  case Stmt::CompoundAssignOperatorClass: {
+    // The LHS is converted to the computation type, combined with the RHS,
+    // and the result converted back to the type of the LHS.
+    const CompoundAssignOperator *CAO = cast<CompoundAssignOperator>(E);
+    unsigned CompWidth;
+    bool CompSigned;
+    if (E->getType()->isBooleanType() || !isModifiable(CAO->getLHS()) ||
+        !getIntType(Ctx, CAO->getComputationLHSType(), CompWidth,
+                    CompSigned) ||
+        !compileLValue(CAO->getLHS(), Slot) || !compileRValue(CAO->getRHS()))
+      return false;
+    emit(OP_Load, Slot);
+    emit(OP_Cast, 0, CompWidth, CompSigned);
+    emit(OP_Swap);
+    if (!compileBinOp(
+            BinaryOperator::getOpForCompoundAssignment(CAO->getOpcode()),
+            CAO->getComputationLHSType(), CAO->getRHS()->getType()))
+      return false;
+    emit(OP_Cast, 0, Width, Signed);
+    emit(OP_Store, Slot);
+    return true;
+  }
+  }
+}
+
+bool FunctionCompiler::isModifiable(const Expr *E) {
+  // Local variables can only be modified within a constant expression in
+  // C++14, and never if they are const.
+  return Ctx.getLangOpts().CPlusPlus14 && !E->getType().isConstQualified();
+}
+
+bool FunctionCompiler::compileIncDec(const UnaryOperator *E, unsigned Slot) {
+  QualType T = E->getSubExpr()->getType();
+  unsigned Width;
+  bool Signed;
+  if (T->isBooleanType() || !isModifiable(E->getSubExpr()) ||
+      !getIntType(Ctx, T, Width, Signed))
+    return false;
+
+  // The operand is incremented in its own type. Only types at least as wide
+  // as int can overflow; narrower ones wrap around, as if they had been
+  // promoted and converted back.
+  bool Overflows = Signed && Width >= Ctx.getIntWidth(Ctx.IntTy);
+  emit(OP_Const, 1);
+  emit(E->isIncrementOp() ? OP_Add : OP_Sub, 0, Width, Overflows);
+  if (Signed && !Overflows)
+    emit(OP_Cast, 0, Width, true);
+  emit(OP_Store, Slot);
+  return true;
+}
+
+bool FunctionCompiler::compileBinOp(BinaryOperatorKind Opc, QualType LHSType,
+                                    QualType RHSType) {
+  unsigned Width, RHSWidth;
+  bool Signed, RHSSigned;
+  if (!getIntType(Ctx, LHSType, Width, Signed) ||
+      !getIntType(Ctx, RHSType, RHSWidth, RHSSigned))
+    return false;
+
+  Opcode Op;
+  switch (Opc) {
+  case BO_Shl:
+  case BO_Shr:
+    // The shift amount has its own type.
+    emit(Opc == BO_Shl ? OP_Shl : OP_Shr, 0, Width, Signed, RHSSigned);
+    return true;
+  case BO_Mul: Op = OP_Mul; break;
+  case BO_Div: Op = OP_Div; break;
+  case BO_Rem: Op = OP_Rem; break;
+  case BO_Add: Op = OP_Add; break;
+  case BO_Sub: Op = OP_Sub; break;
+  case BO_And: Op = OP_And; break;
+  case BO_Xor: Op = OP_Xor; break;
+  case BO_Or:  Op = OP_Or; break;
+  case BO_LT:  Op = OP_LT; break;
+  case BO_GT:  Op = OP_GT; break;
+  case BO_LE:  Op = OP_LE; break;
+  case BO_GE:  Op = OP_GE; break;
+  case BO_EQ:  Op = OP_EQ; break;
+  case BO_NE:  Op = OP_NE; break;
+  default:
+    return false;
+  }
+
+  // The usual arithmetic conversions have given both operands the same type.
+  if (!Ctx.hasSameUnqualifiedType(LHSType, RHSType))
+    return false;
+  emit(Op, 0, Width, Signed);
+  return true;
+}
+
+bool FunctionCompiler::compileCall(const CallExpr *E) {
+  const FunctionDecl *Callee = E->getDirectCallee();
+  if (!Callee || isa<CXXMethodDecl>(Callee) || Callee->getBuiltinID() ||
+      Callee->isVariadic() || E->getNumArgs() != Callee->getNumParams() ||
+      !isa<DeclRefExpr>(E->getCallee()->IgnoreParenImpCasts()))
+    return false;
+
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I) {
+    unsigned Width;
+    bool Signed;
+    if (!getIntType(Ctx, Callee->getParamDecl(I)->getType(), Width, Signed) ||
+        !compileRValue(E->getArg(I)))
+      return false;
+  }
+
+  F.Callees.push_back(Callee);
+  emit(OP_Call, F.Callees.size() - 1);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Interpreter
+//===----------------------------------------------------------------------===//
+
+ConstexprInterpreter::ConstexprInterpreter(ASTContext &Ctx) : Ctx(Ctx) { }
+
+ConstexprInterpreter::~ConstexprInterpreter() {
+  llvm::DeleteContainerSeconds(Functions);
+}
+
+ConstexprInterpreter::Function *
+ConstexprInterpreter::getFunction(const FunctionDecl *Definition) {
+  llvm::DenseMap<const FunctionDecl *, Function *>::iterator I =
+      Functions.find(Definition);
+  if (I != Functions.end())
+    return I->second;
+
+  Function *F = new Function();
+  FunctionCompiler Compiler(Ctx, *F);
+  if (!Compiler.compile(Definition, Definition->getBody())) {
+    delete F;
+    F = nullptr;
+  }
+  Functions[Definition] = F;
+  return F;
+}
+
+ConstexprInterpreter::CallResult
+ConstexprInterpreter::call(const FunctionDecl *Definition,
+                           ArrayRef<APValue> Args, unsigned CallDepth,
+                           unsigned &StepsLeft, APValue &Result) {
+  Function *F = getFunction(Definition);
+  if (!F || Args.size() != F->Params.size())
+    return CR_Unsupported;
+
+  size_t StackBase = Stack.size();
+  size_t SlotBase = Slots.size();
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    if (!Args[I].isInt() ||
+        Args[I].getInt().getBitWidth() != F->Params[I].first) {
+      Stack.resize(StackBase);
+      return CR_Unsupported;
+    }
+    Stack.push_back(normalize(Args[I].getInt().getZExtValue(),
+                              F->Params[I].first, F->Params[I].second));
+  }
+
+  unsigned Steps = StepsLeft;
+  if (!run(F, CallDepth, Steps)) {
+    Stack.resize(StackBase);
+    Slots.resize(SlotBase);
+    return CR_Failed;
+  }
+
+  uint64_t Value = Stack.back();
+  Stack.pop_back();
+  StepsLeft = Steps;
+  Result = APValue(APSInt(llvm::APInt(F->ResultWidth, Value, F->ResultSigned),
+                          !F->ResultSigned));
+  return CR_Succeeded;
+}
+
+bool ConstexprInterpreter::run(const Function *F, unsigned CallDepth,
+                               unsigned &StepsLeft) {
+  struct Frame {
+    const Function *F;
+    size_t PC;
+    size_t SlotBase;
+  };
+  SmallVector<Frame, 16> Callers;
+
+  // Move the arguments into the parameter slots of a new frame.
+  size_t SlotBase = Slots.size();
+  Slots.resize(SlotBase + F->NumSlots);
+  for (size_t I = F->Params.size(); I; --I) {
+    Slots[SlotBase + I - 1] = Stack.back();
+    Stack.pop_back();
+  }
+
+  const Instr *Code = F->Code.data();
+  size_t PC = 0;
+  while (true) {
+    const Instr &I = Code[PC++];
+    switch (I.Op) {
+    case OP_Step:
+      if (!StepsLeft)
+        return false;
+      --StepsLeft;
+      break;
+
+    case OP_Fail:
+      return false;
+
+    case OP_Const:
+      Stack.push_back(uint64_t(I.Arg));
+      break;
+
+    case OP_Load:
+      Stack.push_back(Slots[SlotBase + I.Arg]);
+      break;
+
+    case OP_Store:
+      Slots[SlotBase + I.Arg] = Stack.back();
+      Stack.pop_back();
+      break;
+
+    case OP_Global: {
+      // Mirror the checks in evaluateVarDeclInit, giving up wherever it
+      // would produce a diagnostic.
+      const VarDecl *VD = F->Globals[I.Arg];
+      const Expr *Init = VD->getAnyInitializer(VD);
+      if (!Init || Init->isValueDependent() || VD->isWeak() ||
+          !VD->isInitKnownICE() || !VD->isInitICE())
+        return false;
+      const APValue *Value = VD->getEvaluatedValue();
+      if (!Value || !Value->isInt() ||
+          Value->getInt().getBitWidth() != I.Width)
+        return false;
+      Stack.push_back(
+          normalize(Value->getInt().getZExtValue(), I.Width, I.Signed));
+      break;
+    }
+
+    case OP_Dup:
+      Stack.push_back(Stack.back());
+      break;
+
+    case OP_Pop:
+      Stack.pop_back();
+      break;
+
+    case OP_Swap:
+      std::swap(Stack[Stack.size() - 1], Stack[Stack.size() - 2]);
+      break;
+
+    case OP_Add: case OP_Sub: case OP_Mul: case OP_Div: case OP_Rem:
+    case OP_Shl: case OP_Shr: case OP_And: case OP_Or: case OP_Xor:
+    case OP_LT: case OP_GT: case OP_LE: case OP_GE: case OP_EQ: case OP_NE: {
+      uint64_t RHS = Stack.back();
+      Stack.pop_back();
+      if (!evaluateBinOp(I, Stack.back(), RHS, Stack.back()))
+        return false;
+      break;
+    }
+
+    case OP_Neg:
+      if (I.Signed && isMinSigned(Stack.back(), I.Width))
+        return false;
+      Stack.back() = normalize(0 - Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_Not:
+      Stack.back() = normalize(~Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_LNot:
+      Stack.back() = !Stack.back();
+      break;
+
+    case OP_Cast:
+      Stack.back() = normalize(Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_ToBool:
+      Stack.back() = Stack.back() != 0;
+      break;
+
+    case OP_Jump:
+      PC = I.Arg;
+      break;
+
+    case OP_JumpIfFalse:
+    case OP_JumpIfTrue: {
+      bool Cond = Stack.back() != 0;
+      Stack.pop_back();
+      if (Cond == (I.Op == OP_JumpIfTrue))
+        PC = I.Arg;
+      break;
+    }
+
+    case OP_Call: {
+      // Mirror CheckConstexprFunction and CheckCallLimit.
+      const FunctionDecl *Callee = F->Callees[I.Arg];
+      const FunctionDecl *Definition = nullptr;
+      if (Callee->isInvalidDecl() || !Callee->getBody(Definition) ||
+          !Definition->isConstexpr() || Definition->isInvalidDecl())
+        return false;
+      if (CallDepth + 1 + Callers.size() > Ctx.getLangOpts().ConstexprCallDepth)
+        return false;
+      const Function *G = getFunction(Definition);
+      if (!G)
+        return false;
+
+      Frame Caller = { F, PC, SlotBase };
+      Callers.push_back(Caller);
+      F = G;
+      Code = F->Code.data();
+      PC = 0;
+      SlotBase = Slots.size();
+      Slots.resize(SlotBase + F->NumSlots);
+      for (size_t Param = F->Params.size(); Param; --Param) {
+        Slots[SlotBase + Param - 1] = Stack.back();
+        Stack.pop_back();
+      }
+      break;
+    }
+
+    case OP_Ret:
+      Slots.resize(SlotBase);
+      if (Callers.empty())
+        return true;
+      F = Callers.back().F;
+      PC = Callers.back().PC;
+      SlotBase = Callers.back().SlotBase;
+      Callers.pop_back();
+      Code = F->Code.data();
+      break;
+    }
+  }
+}
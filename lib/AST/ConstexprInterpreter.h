@@ -0,0 +1,87 @@
+//===--- ConstexprInterpreter.h - Bytecode constexpr evaluation -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines an alternative engine for evaluating calls to constexpr
+// functions, which compiles each function body once to a compact bytecode
+// and interprets it over 64-bit stack slots, rather than walking the AST and
+// copying APValues at each step.
+//
+// Only a subset of the language is supported: functions whose parameters,
+// locals and result are of integral type, using the usual statements and
+// operators on them and calls to other such functions. Anything else, and
+// any evaluation that would not produce a constant expression (overflow,
+// division by zero, running out of steps, ...), is left to the AST-walking
+// evaluator in ExprConstant.cpp, which also produces the diagnostics.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+#define LLVM_CLANG_LIB_AST_CONSTEXPRINTERPRETER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+
+namespace clang {
+
+class APValue;
+class ASTContext;
+class FunctionDecl;
+
+/// Evaluates calls to constexpr functions by compiling them to bytecode.
+class ConstexprInterpreter {
+public:
+  struct Function;
+
+  enum CallResult {
+    /// The function uses constructs that the interpreter does not support.
+    CR_Unsupported,
+    /// The evaluation was abandoned, either because it is not a constant
+    /// expression or because it reached something unsupported.
+    CR_Failed,
+    /// The evaluation succeeded.
+    CR_Succeeded
+  };
+
+  explicit ConstexprInterpreter(ASTContext &Ctx);
+  ~ConstexprInterpreter();
+
+  /// \brief Evaluate a call to \p Definition with the given arguments.
+  ///
+  /// \param CallDepth The number of calls already in progress, which counts
+  /// towards LangOptions::ConstexprCallDepth.
+  /// \param StepsLeft The number of evaluation steps that remain, which is
+  /// decreased by the number of steps taken only if the call succeeds. Steps
+  /// are counted exactly as the AST-walking evaluator counts them.
+  CallResult call(const FunctionDecl *Definition, ArrayRef<APValue> Args,
+                  unsigned CallDepth, unsigned &StepsLeft, APValue &Result);
+
+private:
+  ASTContext &Ctx;
+
+  /// \brief The compiled functions, keyed by their definition; null for
+  /// functions that cannot be compiled.
+  llvm::DenseMap<const FunctionDecl *, Function *> Functions;
+
+  /// \brief The slots of the functions being interpreted.
+  std::vector<uint64_t> Slots;
+
+  /// \brief The operand stack.
+  std::vector<uint64_t> Stack;
+
+  Function *getFunction(const FunctionDecl *Definition);
+  bool run(const Function *F, unsigned CallDepth, unsigned &StepsLeft);
+
+  ConstexprInterpreter(const ConstexprInterpreter &) LLVM_DELETED_FUNCTION;
+  void operator=(const ConstexprInterpreter &) LLVM_DELETED_FUNCTION;
+};
+
+} // end namespace clang
+
+#endif
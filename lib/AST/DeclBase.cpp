@@ -13,6 +13,7 @@
 
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTMemoryProfile.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/Decl.h"
@@ -108,6 +109,13 @@ void Decl::EnableStatistics() {
   StatisticsEnabled = true;
 }
 
+void Decl::ResetStatistics() {
+  StatisticsEnabled = false;
+#define DECL(DERIVED, BASE) n##DERIVED##s = 0;
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+}
+
 void Decl::PrintStats() {
   llvm::errs() << "\n*** Decl Stats:\n";
 
@@ -132,12 +140,14 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
-void Decl::add(Kind k) {
+void Decl::add(Kind k, const Decl *D) {
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
 #define ABSTRACT_DECL(DECL)
 #include "clang/AST/DeclNodes.inc"
   }
+  if (ASTMemoryProfile *Profile = ASTMemoryProfile::getActive())
+    Profile->noteNode(ASTMemoryProfile::CAT_Decl, D);
 }
 
 bool Decl::isTemplateParameterPack() const {
@@ -1624,6 +1634,53 @@ void StoredDeclsMap::DestroyAll(StoredDeclsMap *Map, bool Dependent) {
   }
 }
 
+/// \brief The heap memory used by the vector form of a lookup table entry.
+static uint64_t getVectorMemorySize(const StoredDeclsList::DeclsTy &Vec) {
+  uint64_t Bytes = sizeof(Vec);
+  if (Vec.capacity() > 4)
+    Bytes += Vec.capacity() * sizeof(NamedDecl *);
+  return Bytes;
+}
+
+uint64_t StoredDeclsMap::getChainMemorySize(const StoredDeclsMap *Map,
+                                            unsigned &NumMaps) {
+  uint64_t Bytes = 0;
+  for (NumMaps = 0; Map; Map = Map->Previous.getPointer()) {
+    ++NumMaps;
+    Bytes += Map->getMemorySize();
+    for (const_iterator I = Map->begin(), E = Map->end(); I != E; ++I)
+      if (const StoredDeclsList::DeclsTy *Vec = I->second.getAsVector())
+        Bytes += getVectorMemorySize(*Vec);
+  }
+  return Bytes;
+}
+
+void StoredDeclsMap::PrintStats(const StoredDeclsMap *Map) {
+  unsigned NumMaps = 0, NumNames = 0, NumVectors = 0, NumVectorDecls = 0;
+  unsigned MaxVectorDecls = 0;
+  uint64_t MapBytes = 0, VectorBytes = 0;
+  for (; Map; Map = Map->Previous.getPointer()) {
+    ++NumMaps;
+    NumNames += Map->size();
+    MapBytes += Map->getMemorySize();
+    for (const_iterator I = Map->begin(), E = Map->end(); I != E; ++I) {
+      const StoredDeclsList::DeclsTy *Vec = I->second.getAsVector();
+      if (!Vec)
+        continue;
+      ++NumVectors;
+      NumVectorDecls += Vec->size();
+      MaxVectorDecls = std::max(MaxVectorDecls, (unsigned)Vec->size());
+      VectorBytes += getVectorMemorySize(*Vec);
+    }
+  }
+
+  llvm::errs() << "  " << NumMaps << " lookup tables with " << NumNames
+               << " names, " << MapBytes << " bytes\n";
+  llvm::errs() << "  " << NumVectors << " names with multiple declarations ("
+               << NumVectorDecls << " total, " << MaxVectorDecls << " max), "
+               << VectorBytes << " bytes\n";
+}
+
 DependentDiagnostic *DependentDiagnostic::Create(ASTContext &C,
                                                  DeclContext *Parent,
                                            const PartialDiagnostic &PDiag) {
@@ -328,7 +328,8 @@ DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
                          const TemplateArgumentListInfo *TemplateArgs,
                          QualType T, ExprValueKind VK)
   : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-    D(D), Loc(NameInfo.getLoc()), DNLoc(NameInfo.getInfo()) {
+    D(D), DNLoc(NameInfo.getInfo()) {
+  setSpareWord(this, NameInfo.getLoc().getRawEncoding());
   DeclRefExprBits.HasQualifier = QualifierLoc ? 1 : 0;
   if (QualifierLoc) {
     getInternalQualifierLoc() = QualifierLoc;
@@ -1397,14 +1398,15 @@ MemberExpr *MemberExpr::Create(const ASTContext &C, Expr *base, bool isarrow,
              QualifierLoc.getNestedNameSpecifier()->isInstantiationDependent()) 
       E->setInstantiationDependent(true);
     
-    E->HasQualifierOrFoundDecl = true;
+    E->MemberExprBits.HasQualifierOrFoundDecl = true;
 
     MemberNameQualifier *NQ = E->getMemberQualifier();
     NQ->QualifierLoc = QualifierLoc;
     NQ->FoundDecl = founddecl;
   }
 
-  E->HasTemplateKWAndArgsInfo = (targs || TemplateKWLoc.isValid());
+  E->MemberExprBits.HasTemplateKWAndArgsInfo =
+      (targs || TemplateKWLoc.isValid());
 
   if (targs) {
     bool Dependent = false;
@@ -1427,7 +1429,7 @@ SourceLocation MemberExpr::getLocStart() const {
   if (isImplicitAccess()) {
     if (hasQualifier())
       return getQualifierLoc().getBeginLoc();
-    return MemberLoc;
+    return getMemberLoc();
   }
 
   // FIXME: We don't want this to happen. Rather, we should be able to
@@ -1435,7 +1437,7 @@ SourceLocation MemberExpr::getLocStart() const {
   SourceLocation BaseStartLoc = getBase()->getLocStart();
   if (BaseStartLoc.isValid())
     return BaseStartLoc;
-  return MemberLoc;
+  return getMemberLoc();
 }
 SourceLocation MemberExpr::getLocEnd() const {
   SourceLocation EndLoc = getMemberNameInfo().getEndLoc();
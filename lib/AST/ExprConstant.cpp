@@ -33,6 +33,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -454,6 +455,11 @@ namespace {
     /// notes attached to it will also be stored, otherwise they will not be.
     bool HasActiveDiagnostic;
 
+    /// InterpreterFailed - Has the bytecode interpreter given up on a call
+    /// during this evaluation? If so, the calls it made will be evaluated
+    /// again by walking the AST, and there is no point retrying them.
+    bool InterpreterFailed;
+
     enum EvaluationMode {
       /// Evaluate as a constant expression. Stop if we find that the expression
       /// is not a constant expression.
@@ -514,7 +520,7 @@ namespace {
         BottomFrame(*this, SourceLocation(), nullptr, nullptr, nullptr),
         EvaluatingDecl((const ValueDecl *)nullptr),
         EvaluatingDeclValue(nullptr), HasActiveDiagnostic(false),
-        EvalMode(Mode) {}
+        InterpreterFailed(false), EvalMode(Mode) {}
 
     void setEvaluatingDecl(APValue::LValueBase Base, APValue &Value) {
       EvaluatingDecl = Base;
@@ -3700,6 +3706,80 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+/// Determine whether \p Value can be used as an argument or result of a
+/// memoized constexpr function call. Only scalars qualify: anything else
+/// could refer to objects whose lifetime is tied to the evaluation.
+static bool isMemoizableConstexprValue(const APValue &Value) {
+  return Value.isInt() || Value.isFloat();
+}
+
+/// Build the key under which the result of calling \p Callee with
+/// \p ArgValues is memoized in the ASTContext, if the call can be memoized.
+static bool getConstexprCallKey(EvalInfo &Info, const FunctionDecl *Callee,
+                                const LValue *This,
+                                ArrayRef<APValue> ArgValues,
+                                SmallVectorImpl<char> &Key) {
+  if (!Info.Ctx.getLangOpts().ConstexprCacheSize || This ||
+      Info.checkingPotentialConstantExpression() || !Callee->isConstexpr())
+    return false;
+
+  llvm::raw_svector_ostream OS(Key);
+  OS << static_cast<const void *>(Callee);
+  for (const APValue &Arg : ArgValues) {
+    if (!isMemoizableConstexprValue(Arg))
+      return false;
+    if (Arg.isInt()) {
+      const APSInt &Int = Arg.getInt();
+      OS << (Int.isSigned() ? " s" : " u") << Int.getBitWidth() << ':'
+         << Int.toString(16);
+    } else {
+      const APFloat &Float = Arg.getFloat();
+      OS << " f" << static_cast<const void *>(&Float.getSemantics()) << ':'
+         << Float.bitcastToAPInt().toString(16, /*Signed=*/false);
+    }
+  }
+  OS.flush();
+  return true;
+}
+
+/// Memoize the result of a call, if it was a constant expression.
+static void memoizeConstexprCall(EvalInfo &Info, StringRef MemoKey,
+                                 const APValue &Result) {
+  // Only memoize calls that were constant expressions, so that a memoized
+  // result never hides a diagnostic.
+  if (Info.EvalStatus.Diag->empty() && !Info.EvalStatus.HasSideEffects &&
+      isMemoizableConstexprValue(Result))
+    if (APValue *Memoized = Info.Ctx.getConstexprCallResult(MemoKey, true))
+      *Memoized = Result;
+}
+
+/// Try to evaluate a function call with the bytecode interpreter, which
+/// takes exactly the same steps as walking the AST would, but much faster.
+///
+/// \returns true if the interpreter produced the result. Otherwise, the call
+/// must be evaluated by walking the AST, which diagnoses the problem if the
+/// call is not a constant expression.
+static bool interpretFunctionCall(const FunctionDecl *Callee,
+                                  const LValue *This,
+                                  ArrayRef<APValue> ArgValues, EvalInfo &Info,
+                                  APValue &Result) {
+  if (!Info.getLangOpts().ConstexprInterpreter || This ||
+      Info.checkingPotentialConstantExpression() || Info.InterpreterFailed)
+    return false;
+
+  switch (Info.Ctx.getConstexprInterpreter().call(
+      Callee, ArgValues, Info.CallStackDepth, Info.StepsLeft, Result)) {
+  case ConstexprInterpreter::CR_Unsupported:
+    return false;
+  case ConstexprInterpreter::CR_Failed:
+    Info.InterpreterFailed = true;
+    return false;
+  case ConstexprInterpreter::CR_Succeeded:
+    return true;
+  }
+  llvm_unreachable("Invalid CallResult!");
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
@@ -3709,9 +3789,31 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!EvaluateArgs(Args, ArgValues, Info))
     return false;
 
+  // If the result of this call has already been computed, reuse it. This
+  // turns naively recursive constexpr functions from exponential to linear.
+  SmallString<64> MemoKey;
+  bool Memoize = getConstexprCallKey(Info, Callee, This, ArgValues, MemoKey);
+  if (Memoize) {
+    if (APValue *Memoized = Info.Ctx.getConstexprCallResult(MemoKey, false)) {
+      Result = *Memoized;
+      return true;
+    }
+
+    // We can only tell whether the call was a constant expression if no
+    // diagnostic or side-effect preceded it.
+    Memoize = Info.EvalStatus.Diag && Info.EvalStatus.Diag->empty() &&
+              !Info.EvalStatus.HasSideEffects;
+  }
+
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  if (interpretFunctionCall(Callee, This, ArgValues, Info, Result)) {
+    if (Memoize)
+      memoizeConstexprCall(Info, MemoKey, Result);
+    return true;
+  }
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -3744,7 +3846,12 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.Diag(Callee->getLocEnd(), diag::note_constexpr_no_return);
   }
-  return ESR == ESR_Returned;
+  if (ESR != ESR_Returned)
+    return false;
+
+  if (Memoize)
+    memoizeConstexprCall(Info, MemoKey, Result);
+  return true;
 }
 
 /// Evaluate a constructor call.
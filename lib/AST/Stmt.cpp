@@ -13,6 +13,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
+#include "clang/AST/ASTMemoryProfile.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/ExprObjC.h"
 #include "clang/AST/Stmt.h"
@@ -83,8 +84,10 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
-void Stmt::addStmtClass(StmtClass s) {
+void Stmt::addStmtClass(StmtClass s, const Stmt *S) {
   ++getStmtInfoTableEntry(s).Counter;
+  if (ASTMemoryProfile *Profile = ASTMemoryProfile::getActive())
+    Profile->noteNode(ASTMemoryProfile::CAT_Stmt, S);
 }
 
 bool Stmt::StatisticsEnabled = false;
@@ -92,6 +95,12 @@ void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
 }
 
+void Stmt::ResetStatistics() {
+  StatisticsEnabled = false;
+  for (int i = 0; i != Stmt::lastStmtConstant+1; i++)
+    StmtClassInfo[i].Counter = 0;
+}
+
 Stmt *Stmt::IgnoreImplicit() {
   Stmt *s = this;
 
@@ -56,6 +56,8 @@ IdentifierIterator::~IdentifierIterator() { }
 
 IdentifierInfoLookup::~IdentifierInfoLookup() {}
 
+IdentifierCreationListener::~IdentifierCreationListener() {}
+
 namespace {
   /// \brief A simple identifier lookup iterator that represents an
   /// empty sequence of identifiers.
@@ -75,7 +77,7 @@ ExternalIdentifierLookup::~ExternalIdentifierLookup() {}
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), CreationListener(nullptr) {
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -0,0 +1,196 @@
+//===--- TimeTrace.cpp - Hierarchical compile time tracing ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the time trace profiler used by -ftime-trace.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+LLVM_THREAD_LOCAL TimeTraceProfiler *clang::TimeTraceProfilerInstance = nullptr;
+
+namespace clang {
+
+class TimeTraceProfiler {
+  typedef std::chrono::steady_clock Clock;
+  typedef std::chrono::microseconds Duration;
+
+  /// \brief A recorded time span.
+  struct Entry {
+    Clock::time_point Start;
+    Duration Dur;
+    std::string Name;
+    std::string Detail;
+
+    Entry(Clock::time_point Start, StringRef Name, StringRef Detail)
+      : Start(Start), Dur(), Name(Name), Detail(Detail) { }
+  };
+
+  /// \brief The spans that are currently open, innermost last.
+  SmallVector<Entry, 16> Stack;
+
+  /// \brief The spans that have been closed, in the order they were closed.
+  std::vector<Entry> Entries;
+
+  /// \brief The total time and number of spans with each name, excluding
+  /// spans nested within a span of the same name, so that recursion is not
+  /// counted twice.
+  llvm::StringMap<std::pair<Duration, unsigned> > Totals;
+
+  /// \brief When recording started.
+  Clock::time_point StartTime;
+
+public:
+  TimeTraceProfiler() : StartTime(Clock::now()) { }
+
+  void begin(StringRef Name, StringRef Detail) {
+    Stack.push_back(Entry(Clock::now(), Name, Detail));
+  }
+
+  void setDetail(StringRef Detail) {
+    if (!Stack.empty())
+      Stack.back().Detail = Detail;
+  }
+
+  void end() {
+    if (Stack.empty())
+      return;
+
+    Entry E = Stack.pop_back_val();
+    E.Dur = std::chrono::duration_cast<Duration>(Clock::now() - E.Start);
+
+    bool Nested = false;
+    for (unsigned I = 0, N = Stack.size(); I != N; ++I) {
+      if (Stack[I].Name == E.Name) {
+        Nested = true;
+        break;
+      }
+    }
+    if (!Nested) {
+      std::pair<Duration, unsigned> &Total = Totals[E.Name];
+      Total.first += E.Dur;
+      ++Total.second;
+    }
+
+    Entries.push_back(std::move(E));
+  }
+
+  void write(raw_ostream &OS);
+};
+
+} // end namespace clang
+
+/// \brief Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned I = 0, N = Str.size(); I != N; ++I) {
+    unsigned char C = Str[I];
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\r': OS << "\\r"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+      break;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  while (!Stack.empty())
+    end();
+
+  // Chrome expects complete events to be sorted by start time.
+  std::stable_sort(Entries.begin(), Entries.end(),
+                   [](const Entry &LHS, const Entry &RHS) {
+    return LHS.Start < RHS.Start;
+  });
+
+  OS << "{\"traceEvents\":[";
+  bool First = true;
+  for (const Entry &E : Entries) {
+    if (!First)
+      OS << ",";
+    First = false;
+
+    uint64_t Start =
+        std::chrono::duration_cast<Duration>(E.Start - StartTime).count();
+    OS << "\n{\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":" << Start
+       << ",\"dur\":" << (uint64_t)E.Dur.count() << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    OS << ",\"args\":{\"detail\":";
+    writeJSONString(OS, E.Detail);
+    OS << "}}";
+  }
+
+  // Emit the totals for each kind of span on a separate thread, so they are
+  // shown as a summary next to the main timeline.
+  uint64_t TotalTime = 0;
+  for (llvm::StringMap<std::pair<Duration, unsigned> >::iterator
+           I = Totals.begin(), E = Totals.end();
+       I != E; ++I) {
+    if (!First)
+      OS << ",";
+    First = false;
+
+    uint64_t Dur = I->second.first.count();
+    OS << "\n{\"pid\":1,\"tid\":1,\"ph\":\"X\",\"ts\":" << TotalTime
+       << ",\"dur\":" << Dur << ",\"name\":";
+    writeJSONString(OS, "Total " + I->getKey().str());
+    OS << ",\"args\":{\"count\":" << I->second.second << "}}";
+    TotalTime += Dur;
+  }
+
+  OS << "\n]}\n";
+}
+
+void clang::timeTraceProfilerInitialize() {
+  assert(!TimeTraceProfilerInstance && "Profiler already initialized");
+  TimeTraceProfilerInstance = new TimeTraceProfiler();
+}
+
+void clang::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void clang::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance && "Profiler not initialized");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name, Detail);
+}
+
+void clang::timeTraceProfilerEnd() {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->end();
+}
+
+void clang::timeTraceProfilerSetDetail(StringRef Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->setDetail(Detail);
+}
@@ -8,25 +8,40 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/CodeGen/BackendUtil.h"
+#include "ModulePartitioner.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/PassManager.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -39,7 +54,11 @@
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
 #include <memory>
+#include <thread>
+#include <vector>
 using namespace clang;
 using namespace llvm;
 
@@ -58,6 +77,12 @@ class EmitAssemblyHelper {
   mutable PassManager *PerModulePasses;
   mutable FunctionPassManager *PerFunctionPasses;
 
+  /// The code generation passes, run on one function at a time when code is
+  /// generated while the module is still being built, and their output.
+  FunctionPassManager *StreamingPasses;
+  formatted_raw_ostream StreamingOS;
+  bool StreamingStarted, StreamingFinished;
+
 private:
   PassManager *getCodeGenPasses() const {
     if (!CodeGenPasses) {
@@ -106,6 +131,12 @@ private:
   /// \return True on success.
   bool AddEmitPasses(BackendAction Action, formatted_raw_ostream &OS);
 
+  /// EmitPartitions - Split the module, and generate code for the parts in
+  /// parallel. The first part is generated on the calling thread and written
+  /// to \p OS, the others on threads of their own and written to the files
+  /// named by CodeGenOpts.ParallelCodeGenOutputs.
+  void EmitPartitions(BackendAction Action, raw_ostream &OS);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags,
                      const CodeGenOptions &CGOpts,
@@ -115,12 +146,19 @@ public:
     : Diags(_Diags), CodeGenOpts(CGOpts), TargetOpts(TOpts), LangOpts(LOpts),
       TheModule(M), CodeGenerationTime("Code Generation Time"),
       CodeGenPasses(nullptr), PerModulePasses(nullptr),
-      PerFunctionPasses(nullptr) {}
+      PerFunctionPasses(nullptr), StreamingPasses(nullptr),
+      StreamingStarted(false), StreamingFinished(false) {}
 
   ~EmitAssemblyHelper() {
     delete CodeGenPasses;
     delete PerModulePasses;
     delete PerFunctionPasses;
+    // The code generator can't be torn down in the middle of a module, which
+    // happens when IR generation fails after streaming started.
+    if (StreamingStarted && !StreamingFinished)
+      BuryPointer(StreamingPasses);
+    else
+      delete StreamingPasses;
     if (CodeGenOpts.DisableFree)
       BuryPointer(std::move(TM));
   }
@@ -128,6 +166,23 @@ public:
   std::unique_ptr<TargetMachine> TM;
 
   void EmitAssembly(BackendAction Action, raw_ostream *OS);
+
+  /// BeginStreaming - Set up the passes that generate code for \p Action one
+  /// function at a time, while the rest of the module is being built.
+  ///
+  /// \return True on success.
+  bool BeginStreaming(BackendAction Action, raw_ostream &OS);
+
+  /// hasStartedStreaming - Whether code has been generated for any function.
+  bool hasStartedStreaming() const { return StreamingStarted; }
+
+  /// StreamFunction - Generate code for \p F, which is complete, and replace
+  /// its body with a placeholder.
+  void StreamFunction(Function &F);
+
+  /// FinishStreaming - Run the per-module passes over the complete module,
+  /// and generate code for the functions that are left.
+  void FinishStreaming();
 };
 
 // We need this wrapper to access LangOpts and CGOpts from extension functions
@@ -414,8 +469,11 @@ TargetMachine *EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
   if (CodeGenOpts.NoGlobalMerge)
     BackendArgs.push_back("-enable-global-merge=false");
   BackendArgs.push_back(nullptr);
-  llvm::cl::ParseCommandLineOptions(BackendArgs.size() - 1,
-                                    BackendArgs.data());
+  // Only touch the global option state if there are options to set, so that
+  // a process can run several compilations without backend options.
+  if (BackendArgs.size() > 2)
+    llvm::cl::ParseCommandLineOptions(BackendArgs.size() - 1,
+                                      BackendArgs.data());
 
   std::string FeaturesStr;
   if (TargetOpts.Features.size()) {
@@ -520,14 +578,16 @@ TargetMachine *EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
   return TM;
 }
 
-bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
-                                       formatted_raw_ostream &OS) {
-
-  // Create the code generator passes.
-  PassManager *PM = getCodeGenPasses();
-
+/// \brief Add the passes that generate code for \p Action with \p TM to
+/// \p PM.
+///
+/// \return True on success.
+static bool addCodeGenPasses(PassManagerBase *PM, TargetMachine *TM,
+                             const CodeGenOptions &CodeGenOpts,
+                             const LangOptions &LangOpts,
+                             llvm::Triple &TargetTriple, BackendAction Action,
+                             formatted_raw_ostream &OS) {
   // Add LibraryInfo.
-  llvm::Triple TargetTriple(TheModule->getTargetTriple());
   PM->add(createTLI(TargetTriple, CodeGenOpts));
 
   // Add Target specific analysis passes.
@@ -550,8 +610,18 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
       CodeGenOpts.OptimizationLevel > 0)
     PM->add(createObjCARCContractPass());
 
-  if (TM->addPassesToEmitFile(*PM, OS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+  return !TM->addPassesToEmitFile(*PM, OS, CGFT,
+                                  /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
+                                       formatted_raw_ostream &OS) {
+  // Create the code generator passes.
+  PassManager *PM = getCodeGenPasses();
+
+  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  if (!addCodeGenPasses(PM, TM.get(), CodeGenOpts, LangOpts, TargetTriple,
+                        Action, OS)) {
     Diags.Report(diag::err_fe_unable_to_interface_with_target);
     return false;
   }
@@ -559,6 +629,289 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
   return true;
 }
 
+namespace {
+/// \brief The diagnostics produced while generating code for one part of a
+/// module, which are replayed through the handlers of the module's context
+/// once all the parts are done.
+///
+/// The diagnostics refer to functions and debug locations of the part, so
+/// the part's context and module are kept alive until then. The messages of
+/// the diagnostics, which only reference their text, are copied.
+struct PartitionDiagnostics {
+  /// \brief A diagnostic of the part, in the order it was produced.
+  struct Diagnostic {
+    /// \brief The DiagnosticKind of the diagnostic, or -1 for an inline asm
+    /// diagnostic that came through the inline asm handler.
+    int Kind;
+    llvm::DiagnosticSeverity Severity;
+    std::string Message;
+    /// \brief For the kinds without a replay, the clang diagnostic to report.
+    unsigned DiagID;
+    const Function *Fn;
+    DebugLoc Loc;
+    const char *PassName;
+    uint64_t StackSize;
+    unsigned LocCookie;
+    /// \brief For an inline asm diagnostic, a copy of the diagnostic that
+    /// refers to a copy of its buffer in AsmSources.
+    llvm::SMDiagnostic AsmDiag;
+
+    Diagnostic(int Kind, llvm::DiagnosticSeverity Severity)
+        : Kind(Kind), Severity(Severity), DiagID(0), Fn(nullptr),
+          PassName(nullptr), StackSize(0), LocCookie(0) {}
+  };
+
+  std::unique_ptr<LLVMContext> Context;
+  std::unique_ptr<Module> M;
+  std::vector<Diagnostic> Diags;
+  std::vector<std::unique_ptr<llvm::SourceMgr> > AsmSources;
+
+  /// \brief Add a diagnostic that is reported through clang as it is.
+  void add(unsigned DiagID, StringRef Message) {
+    Diagnostic D(llvm::DK_FirstPluginKind, llvm::DS_Error);
+    D.DiagID = DiagID;
+    D.Message = Message.str();
+    Diags.push_back(D);
+  }
+
+  static void handleDiagnostic(const llvm::DiagnosticInfo &DI,
+                               void *Context) {
+    PartitionDiagnostics &PD = *static_cast<PartitionDiagnostics *>(Context);
+    Diagnostic D(DI.getKind(), DI.getSeverity());
+    switch (DI.getKind()) {
+    case llvm::DK_InlineAsm: {
+      const auto &IA = cast<DiagnosticInfoInlineAsm>(DI);
+      D.LocCookie = IA.getLocCookie();
+      D.Message = IA.getMsgStr().str();
+      break;
+    }
+    case llvm::DK_StackSize: {
+      const auto &SS = cast<DiagnosticInfoStackSize>(DI);
+      D.Fn = &SS.getFunction();
+      D.StackSize = SS.getStackSize();
+      break;
+    }
+    case llvm::DK_OptimizationRemark:
+    case llvm::DK_OptimizationRemarkMissed:
+    case llvm::DK_OptimizationRemarkAnalysis:
+    case llvm::DK_OptimizationFailure: {
+      const auto &OB =
+          static_cast<const DiagnosticInfoOptimizationBase &>(DI);
+      D.Fn = &OB.getFunction();
+      D.Loc = OB.getDebugLoc();
+      D.PassName = OB.getPassName();
+      D.Message = OB.getMsg().str();
+      break;
+    }
+    default: {
+      raw_string_ostream OS(D.Message);
+      DiagnosticPrinterRawOStream DP(OS);
+      DI.print(DP);
+      OS.flush();
+      switch (DI.getSeverity()) {
+      case llvm::DS_Error: D.DiagID = diag::err_fe_backend_plugin; break;
+      case llvm::DS_Warning: D.DiagID = diag::warn_fe_backend_plugin; break;
+      case llvm::DS_Remark: D.DiagID = diag::remark_fe_backend_plugin; break;
+      case llvm::DS_Note: D.DiagID = diag::note_fe_backend_plugin; break;
+      }
+      break;
+    }
+    }
+    PD.Diags.push_back(D);
+  }
+
+  static void handleInlineAsmDiagnostic(const llvm::SMDiagnostic &SMD,
+                                        void *Context, unsigned LocCookie) {
+    PartitionDiagnostics &PD = *static_cast<PartitionDiagnostics *>(Context);
+    Diagnostic D(-1, llvm::DS_Error);
+    D.LocCookie = LocCookie;
+
+    // The source manager of the diagnostic only lives as long as the inline
+    // asm is being parsed, so point a copy of the diagnostic into a copy of
+    // its buffer.
+    SMLoc Loc;
+    PD.AsmSources.emplace_back(new llvm::SourceMgr());
+    llvm::SourceMgr &SM = *PD.AsmSources.back();
+    if (SMD.getSourceMgr() && SMD.getLoc().isValid()) {
+      const llvm::SourceMgr &OrigSM = *SMD.getSourceMgr();
+      const MemoryBuffer *Buf = OrigSM.getMemoryBuffer(
+          OrigSM.FindBufferContainingLoc(SMD.getLoc()));
+      unsigned BufID = SM.AddNewSourceBuffer(
+          MemoryBuffer::getMemBufferCopy(Buf->getBuffer(),
+                                         Buf->getBufferIdentifier()),
+          SMLoc());
+      Loc = SMLoc::getFromPointer(
+          SM.getMemoryBuffer(BufID)->getBufferStart() +
+          (SMD.getLoc().getPointer() - Buf->getBufferStart()));
+    }
+    D.AsmDiag = llvm::SMDiagnostic(
+        SM, Loc, SMD.getFilename(), SMD.getLineNo(), SMD.getColumnNo(),
+        SMD.getKind(), SMD.getMessage(), SMD.getLineContents(),
+        SMD.getRanges(), SMD.getFixIts());
+    PD.Diags.push_back(D);
+  }
+
+  /// \brief Report the diagnostics through the handlers of \p Ctx, or
+  /// through \p ClangDiags for those that can't be replayed.
+  void replay(LLVMContext &Ctx, DiagnosticsEngine &ClangDiags) const {
+    for (const Diagnostic &D : Diags) {
+      switch (D.Kind) {
+      case -1:
+        if (LLVMContext::InlineAsmDiagHandlerTy Handler =
+                Ctx.getInlineAsmDiagnosticHandler())
+          Handler(D.AsmDiag, Ctx.getInlineAsmDiagnosticContext(),
+                  D.LocCookie);
+        else
+          ClangDiags.Report(diag::err_fe_inline_asm) << D.AsmDiag.getMessage();
+        break;
+      case llvm::DK_InlineAsm:
+        Ctx.diagnose(
+            DiagnosticInfoInlineAsm(D.LocCookie, D.Message, D.Severity));
+        break;
+      case llvm::DK_StackSize:
+        Ctx.diagnose(DiagnosticInfoStackSize(*D.Fn, D.StackSize, D.Severity));
+        break;
+      case llvm::DK_OptimizationRemark:
+        Ctx.diagnose(DiagnosticInfoOptimizationRemark(D.PassName, *D.Fn,
+                                                      D.Loc, D.Message));
+        break;
+      case llvm::DK_OptimizationRemarkMissed:
+        Ctx.diagnose(DiagnosticInfoOptimizationRemarkMissed(
+            D.PassName, *D.Fn, D.Loc, D.Message));
+        break;
+      case llvm::DK_OptimizationRemarkAnalysis:
+        Ctx.diagnose(DiagnosticInfoOptimizationRemarkAnalysis(
+            D.PassName, *D.Fn, D.Loc, D.Message));
+        break;
+      case llvm::DK_OptimizationFailure:
+        Ctx.diagnose(
+            DiagnosticInfoOptimizationFailure(*D.Fn, D.Loc, D.Message));
+        break;
+      default:
+        ClangDiags.Report(D.DiagID) << D.Message;
+        break;
+      }
+    }
+  }
+};
+}
+
+/// \brief Generate code for \p M, a part of the module, to \p OS. Returns
+/// false if the target can't emit code of the requested kind.
+static bool EmitPart(Module &M, TargetMachine *TM,
+                     const CodeGenOptions &CodeGenOpts,
+                     const LangOptions &LangOpts, BackendAction Action,
+                     raw_ostream &OS) {
+  formatted_raw_ostream FormattedOS(OS, formatted_raw_ostream::PRESERVE_STREAM);
+  PassManager PM;
+  PM.add(new DataLayoutPass());
+  llvm::Triple TargetTriple(M.getTargetTriple());
+  if (!addCodeGenPasses(&PM, TM, CodeGenOpts, LangOpts, TargetTriple, Action,
+                        FormattedOS))
+    return false;
+  PM.run(M);
+  return true;
+}
+
+/// \brief Generate code for the part of the module in \p Bitcode, in a
+/// context of its own.
+static void EmitPartition(StringRef Bitcode, TargetMachine *TM,
+                          const CodeGenOptions &CodeGenOpts,
+                          const LangOptions &LangOpts, BackendAction Action,
+                          raw_ostream &OS, PartitionDiagnostics &PD) {
+  // Like the module's own context, leave the filtering of remarks to the
+  // handlers the diagnostics are replayed through.
+  PD.Context.reset(new LLVMContext());
+  LLVMContext &Context = *PD.Context;
+  Context.setDiagnosticHandler(PartitionDiagnostics::handleDiagnostic, &PD);
+  Context.setInlineAsmDiagnosticHandler(
+      PartitionDiagnostics::handleInlineAsmDiagnostic, &PD);
+
+  ErrorOr<Module *> ModuleOrErr = parseBitcodeFile(
+      MemoryBufferRef(Bitcode, "<partition>"), Context);
+  if (std::error_code EC = ModuleOrErr.getError()) {
+    PD.add(diag::err_fe_backend_plugin, EC.message());
+    return;
+  }
+  PD.M.reset(ModuleOrErr.get());
+  if (!EmitPart(*PD.M, TM, CodeGenOpts, LangOpts, Action, OS))
+    PD.add(diag::err_fe_unable_to_interface_with_target, "");
+}
+
+void EmitAssemblyHelper::EmitPartitions(BackendAction Action,
+                                        raw_ostream &OS) {
+  unsigned NumPartitions = CodeGenOpts.ParallelCodeGenOutputs.size() + 1;
+  CodeGen::ModulePartitioner Partitioner(*TheModule, NumPartitions);
+
+  std::vector<std::unique_ptr<raw_fd_ostream> > Files;
+  SmallVector<raw_ostream *, 8> Outputs;
+  Outputs.push_back(&OS);
+  for (const std::string &Path : CodeGenOpts.ParallelCodeGenOutputs) {
+    std::error_code EC;
+    Files.emplace_back(new raw_fd_ostream(Path, EC, llvm::sys::fs::F_None));
+    if (EC) {
+      Diags.Report(diag::err_fe_unable_to_open_output) << Path
+                                                        << EC.message();
+      return;
+    }
+    Outputs.push_back(Files.back().get());
+  }
+
+  // LLVM contexts can't be shared between threads, so the parts after the
+  // first are cloned from the module one at a time, and handed to their
+  // threads as bitcode, which each thread reads into a context of its own.
+  // No thread holds more than its own part of the module. A part without
+  // definitions only needs an object for the relocatable link, so it is
+  // generated from an empty module instead.
+  std::vector<SmallString<0> > Bitcode(NumPartitions);
+  for (unsigned I = 1; I != NumPartitions; ++I) {
+    raw_svector_ostream BitcodeOS(Bitcode[I]);
+    if (Partitioner.isEmpty(I)) {
+      Module Empty(TheModule->getModuleIdentifier(), TheModule->getContext());
+      Empty.setTargetTriple(TheModule->getTargetTriple());
+      Empty.setDataLayout(TheModule->getDataLayoutStr());
+      WriteBitcodeToFile(&Empty, BitcodeOS);
+      continue;
+    }
+    std::unique_ptr<Module> Part(CloneModule(TheModule));
+    Partitioner.extractPartition(*Part, I);
+    WriteBitcodeToFile(Part.get(), BitcodeOS);
+  }
+
+  // The target machines are created up front, since that isn't thread-safe.
+  std::vector<std::unique_ptr<TargetMachine> > TMs(NumPartitions);
+  for (unsigned I = 1; I != NumPartitions; ++I)
+    TMs[I].reset(TM->getTarget().createTargetMachine(
+        TM->getTargetTriple(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+
+  std::vector<PartitionDiagnostics> PartDiags(NumPartitions);
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1; I != NumPartitions; ++I)
+    Threads.emplace_back([&, I] {
+      EmitPartition(Bitcode[I].str(), TMs[I].get(), CodeGenOpts, LangOpts,
+                    Action, *Outputs[I], PartDiags[I]);
+    });
+
+  // The first part is generated on this thread, in the module's context, so
+  // its diagnostics go straight to the module's handlers.
+  {
+    std::unique_ptr<Module> Part(CloneModule(TheModule));
+    Partitioner.extractPartition(*Part, 0);
+    if (!EmitPart(*Part, TM.get(), CodeGenOpts, LangOpts, Action, OS))
+      Diags.Report(diag::err_fe_unable_to_interface_with_target);
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  // Report the diagnostics of the other parts in a deterministic order,
+  // through the handlers of the module's context as if the module had been
+  // compiled as a whole.
+  for (const PartitionDiagnostics &PD : PartDiags)
+    PD.replay(TheModule->getContext(), Diags);
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
   llvm::formatted_raw_ostream FormattedOS;
@@ -572,6 +925,12 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
   if (UsesCodeGen && !TM) return;
   CreatePasses();
 
+  // With -parallel-codegen-output, the module is optimized as a whole, and
+  // then split for code generation.
+  bool SplitCodeGen = (Action == Backend_EmitAssembly ||
+                       Action == Backend_EmitObj) &&
+                      !CodeGenOpts.ParallelCodeGenOutputs.empty();
+
   switch (Action) {
   case Backend_EmitNothing:
     break;
@@ -586,6 +945,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
     break;
 
   default:
+    if (SplitCodeGen)
+      break;
     FormattedOS.setStream(*OS, formatted_raw_ostream::PRESERVE_STREAM);
     if (!AddEmitPasses(Action, FormattedOS))
       return;
@@ -599,6 +960,7 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
 
   if (PerFunctionPasses) {
     PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope TimeScope("PerFunctionPasses");
 
     PerFunctionPasses->doInitialization();
     for (Module::iterator I = TheModule->begin(),
@@ -610,13 +972,125 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
 
   if (PerModulePasses) {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("PerModulePasses");
     PerModulePasses->run(*TheModule);
   }
 
   if (CodeGenPasses) {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope TimeScope("CodeGenPasses");
     CodeGenPasses->run(*TheModule);
   }
+
+  if (SplitCodeGen) {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    TimeTraceScope TimeScope("ParallelCodeGen");
+    EmitPartitions(Action, *OS);
+  }
+}
+
+/// \brief The attribute that marks a function whose code has been generated
+/// while the module was being built, and whose body is a placeholder.
+static const char StreamedAttr[] = "clang-streamed-codegen";
+
+static bool isStreamed(const Function &F) {
+  return F.getAttributes().hasAttribute(AttributeSet::FunctionIndex,
+                                        StreamedAttr);
+}
+
+bool EmitAssemblyHelper::BeginStreaming(BackendAction Action,
+                                        raw_ostream &OS) {
+  TM.reset(CreateTargetMachine(/*MustCreateTM=*/true));
+  if (!TM)
+    return false;
+  CreatePasses();
+
+  StreamingPasses = new FunctionPassManager(TheModule);
+  StreamingPasses->add(new DataLayoutPass());
+  StreamingOS.setStream(OS, formatted_raw_ostream::PRESERVE_STREAM);
+  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  if (!addCodeGenPasses(StreamingPasses, TM.get(), CodeGenOpts, LangOpts,
+                        TargetTriple, Action, StreamingOS)) {
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+    return false;
+  }
+
+  // Before executing passes, print the final values of the LLVM options.
+  cl::PrintOptionValues();
+
+  PerFunctionPasses->doInitialization();
+  return true;
+}
+
+void EmitAssemblyHelper::StreamFunction(Function &F) {
+  TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
+  PrettyStackTraceString CrashInfo("Streaming code generation");
+
+  // This emits the module-level inline asm, so it is put off until there is
+  // code to generate.
+  if (!StreamingStarted) {
+    StreamingPasses->doInitialization();
+    StreamingStarted = true;
+  }
+
+  PerFunctionPasses->run(F);
+  StreamingPasses->run(F);
+
+  // Keep the function a definition, with its linkage and attributes, so that
+  // IR generation doesn't emit it again.
+  LLVMContext &Ctx = F.getContext();
+  F.dropAllReferences();
+  new UnreachableInst(Ctx, BasicBlock::Create(Ctx, "", &F));
+  F.addFnAttr(StreamedAttr);
+}
+
+void EmitAssemblyHelper::FinishStreaming() {
+  TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
+
+  {
+    PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope TimeScope("PerFunctionPasses");
+
+    for (Function &F : *TheModule)
+      if (!F.isDeclaration() && !isStreamed(F))
+        PerFunctionPasses->run(F);
+    PerFunctionPasses->doFinalization();
+  }
+
+  {
+    PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("PerModulePasses");
+    PerModulePasses->run(*TheModule);
+  }
+
+  PrettyStackTraceString CrashInfo("Code generation");
+  TimeTraceScope TimeScope("CodeGenPasses");
+  if (!StreamingStarted) {
+    StreamingPasses->doInitialization();
+    StreamingStarted = true;
+  }
+  for (Function &F : *TheModule)
+    if (!F.isDeclaration() && !isStreamed(F))
+      StreamingPasses->run(F);
+  StreamingPasses->doFinalization();
+  StreamingOS.flush();
+  StreamingFinished = true;
+}
+
+/// \brief Check the data layout of \p TM against the one clang's TargetInfo
+/// describes with \p TDesc, if any.
+static void checkDataLayout(DiagnosticsEngine &Diags, const TargetMachine *TM,
+                            StringRef TDesc) {
+  if (!TM || TDesc.empty())
+    return;
+  std::string DLDesc =
+      TM->getSubtargetImpl()->getDataLayout()->getStringRepresentation();
+  if (DLDesc != TDesc) {
+    unsigned DiagID = Diags.getCustomDiagID(
+        DiagnosticsEngine::Error, "backend data layout '%0' does not match "
+                                  "expected target description '%1'");
+    Diags.Report(DiagID) << DLDesc << TDesc;
+  }
 }
 
 void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
@@ -631,15 +1105,193 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
 
   // If an optional clang TargetInfo description string was passed in, use it to
   // verify the LLVM TargetMachine's DataLayout.
-  if (AsmHelper.TM && !TDesc.empty()) {
-    std::string DLDesc = AsmHelper.TM->getSubtargetImpl()
-                             ->getDataLayout()
-                             ->getStringRepresentation();
-    if (DLDesc != TDesc) {
-      unsigned DiagID = Diags.getCustomDiagID(
-          DiagnosticsEngine::Error, "backend data layout '%0' does not match "
-                                    "expected target description '%1'");
-      Diags.Report(DiagID) << DLDesc << TDesc;
+  checkDataLayout(Diags, AsmHelper.TM.get(), TDesc);
+}
+
+StreamingBackend::~StreamingBackend() {}
+
+/// \brief Whether code can be generated for \p F, a complete definition,
+/// before the rest of the module is built.
+///
+/// A function that takes part in always_inline inlining, or whose blocks
+/// have their address taken, is needed in IR form until the end. So is a
+/// function that refers to another one that is only declared so far, since
+/// its definition may still come with always_inline; \p Pending is set to
+/// that function.
+static bool isReadyForStreaming(const Function &F, const Function *&Pending) {
+  Pending = nullptr;
+  if (F.hasFnAttribute(Attribute::AlwaysInline))
+    return false;
+
+  // Look at every function that F calls or takes the address of, including
+  // through constant expressions.
+  SmallVector<const Constant *, 8> Worklist;
+  SmallPtrSet<const Constant *, 16> Visited;
+  for (const BasicBlock &BB : F) {
+    if (BB.hasAddressTaken())
+      return false;
+    for (const Instruction &I : BB)
+      for (const Use &Op : I.operands())
+        if (const Constant *C = dyn_cast<Constant>(Op.get()))
+          if (Visited.insert(C).second)
+            Worklist.push_back(C);
+  }
+
+  while (!Worklist.empty()) {
+    const Constant *C = Worklist.pop_back_val();
+    if (const Function *Callee = dyn_cast<Function>(C)) {
+      if (Callee->isIntrinsic())
+        continue;
+      if (Callee->hasFnAttribute(Attribute::AlwaysInline))
+        return false;
+      if (Callee->isDeclaration()) {
+        Pending = Callee;
+        return false;
+      }
+      continue;
+    }
+    // The initializers of global variables keep their own uses.
+    if (isa<GlobalValue>(C))
+      continue;
+    for (const Use &Op : C->operands())
+      if (const Constant *OpC = dyn_cast<Constant>(Op.get()))
+        if (Visited.insert(OpC).second)
+          Worklist.push_back(OpC);
+  }
+  return true;
+}
+
+namespace {
+class StreamingBackendImpl : public StreamingBackend {
+  DiagnosticsEngine &Diags;
+  Module *TheModule;
+  EmitAssemblyHelper AsmHelper;
+
+  /// Whether the code generator could be set up.
+  bool CanStream;
+
+  /// The module-level inline asm, as of when code generation started.
+  std::string ModuleAsm;
+  bool ReportedModuleAsm;
+
+  /// The definitions that IR generation completed since the last look, and
+  /// the ones to look at again.
+  std::vector<WeakVH> Worklist;
+
+  /// The functions that wait for each function that is only declared, to be
+  /// looked at again once it is defined.
+  DenseMap<const Function *, SmallVector<WeakVH, 2>> Waiting;
+
+  unsigned NumStreamed, NumAtEnd;
+  size_t PeakMallocUsage;
+
+  void checkModuleAsm();
+
+public:
+  StreamingBackendImpl(DiagnosticsEngine &Diags, const CodeGenOptions &CGOpts,
+                       const clang::TargetOptions &TOpts,
+                       const LangOptions &LOpts, Module *M,
+                       BackendAction Action, raw_ostream &OS)
+      : Diags(Diags), TheModule(M), AsmHelper(Diags, CGOpts, TOpts, LOpts, M),
+        ReportedModuleAsm(false), NumStreamed(0), NumAtEnd(0),
+        PeakMallocUsage(0) {
+    CanStream = AsmHelper.BeginStreaming(Action, OS);
+  }
+
+  void AddCompletedFunction(Function *F) override {
+    if (CanStream)
+      Worklist.push_back(F);
+  }
+  void EmitCompletedFunctions() override;
+  void Finish(StringRef TDesc) override;
+  void PrintStats() const override;
+};
+}
+
+void StreamingBackendImpl::checkModuleAsm() {
+  // Module-level inline asm is emitted ahead of the code for any function.
+  if (AsmHelper.hasStartedStreaming() && !ReportedModuleAsm &&
+      TheModule->getModuleInlineAsm() != ModuleAsm) {
+    Diags.Report(diag::err_fe_streaming_codegen_module_asm);
+    ReportedModuleAsm = true;
+  }
+}
+
+void StreamingBackendImpl::EmitCompletedFunctions() {
+  if (!CanStream || Diags.hasErrorOccurred())
+    return;
+  checkModuleAsm();
+  if (Worklist.empty())
+    return;
+
+  PeakMallocUsage = std::max(PeakMallocUsage, sys::Process::GetMallocUsage());
+  while (!Worklist.empty()) {
+    // The function may have been deleted or replaced since it was completed.
+    Value *V = Worklist.back();
+    Worklist.pop_back();
+    Function *F = dyn_cast_or_null<Function>(V);
+    if (!F || F->getParent() != TheModule || F->isDeclaration() ||
+        isStreamed(*F))
+      continue;
+
+    // The functions that waited for F to be defined can be looked at again.
+    auto W = Waiting.find(F);
+    if (W != Waiting.end()) {
+      Worklist.insert(Worklist.end(), W->second.begin(), W->second.end());
+      Waiting.erase(W);
     }
+
+    // A function that waits for nothing in particular isn't ready until the
+    // end: it keeps its calls to always_inline functions, for instance.
+    const Function *Pending;
+    if (!isReadyForStreaming(*F, Pending)) {
+      if (Pending)
+        Waiting[Pending].push_back(F);
+      continue;
+    }
+
+    if (!AsmHelper.hasStartedStreaming())
+      ModuleAsm = TheModule->getModuleInlineAsm();
+    AsmHelper.StreamFunction(*F);
+    ++NumStreamed;
   }
 }
+
+void StreamingBackendImpl::Finish(StringRef TDesc) {
+  if (!CanStream)
+    return;
+  checkModuleAsm();
+  PeakMallocUsage = std::max(PeakMallocUsage, sys::Process::GetMallocUsage());
+
+  for (Function &F : *TheModule)
+    if (!F.isDeclaration() && !isStreamed(F))
+      ++NumAtEnd;
+
+  AsmHelper.FinishStreaming();
+  checkDataLayout(Diags, AsmHelper.TM.get(), TDesc);
+}
+
+void StreamingBackendImpl::PrintStats() const {
+  llvm::errs() << "\n*** Streaming Code Generation Stats:\n";
+  llvm::errs() << "  " << NumStreamed
+               << " functions generated while building the module\n";
+  llvm::errs() << "  " << NumAtEnd
+               << " functions generated at the end of the module\n";
+  llvm::errs() << "  " << PeakMallocUsage
+               << " bytes peak heap usage during IR generation\n";
+}
+
+StreamingBackend *clang::CreateStreamingBackend(
+    DiagnosticsEngine &Diags, const CodeGenOptions &CGOpts,
+    const clang::TargetOptions &TOpts, const LangOptions &LOpts, Module *M,
+    BackendAction Action, raw_ostream *OS) {
+  // CompilerInvocation only leaves StreamingCodeGen set when the code can be
+  // streamed, as CodeGen has already shaped the IR for it.
+  if (!CGOpts.StreamingCodeGen)
+    return nullptr;
+  assert((Action == Backend_EmitAssembly || Action == Backend_EmitObj) &&
+         CGOpts.ParallelCodeGenOutputs.empty() &&
+         "StreamingCodeGen set for output that isn't streamed");
+
+  return new StreamingBackendImpl(Diags, CGOpts, TOpts, LOpts, M, Action, *OS);
+}
@@ -23,6 +23,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/RecordLayout.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Version.h"
@@ -37,13 +38,16 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 using namespace clang::CodeGen;
 
 CGDebugInfo::CGDebugInfo(CodeGenModule &CGM)
     : CGM(CGM), DebugKind(CGM.getCodeGenOpts().getDebugInfo()),
-      DBuilder(CGM.getModule()) {
+      DBuilder(CGM.getModule()), HomingManifestLoaded(false) {
   CreateCompileUnit();
 }
 
@@ -592,13 +596,28 @@ llvm::DIType CGDebugInfo::CreateType(const PointerType *Ty, llvm::DIFile Unit) {
 
 /// In C++ mode, types have linkage, so we can rely on the ODR and
 /// on their mangled names, if they're external.
-static SmallString<256> getUniqueTagTypeName(const TagType *Ty,
-                                             CodeGenModule &CGM,
-                                             llvm::DICompileUnit TheCU) {
+SmallString<256> CGDebugInfo::getUniqueTagTypeName(const TagType *Ty) {
   SmallString<256> FullName;
+  const TagDecl *TD = Ty->getDecl();
+
+  // Elsewhere, when types go in type units of their own, identify the types
+  // defined at file scope by the structure of their definition. Definitions
+  // that are the same in two translation units describe compatible types.
+  if (TheCU.getLanguage() != llvm::dwarf::DW_LANG_C_plus_plus &&
+      TheCU.getLanguage() != llvm::dwarf::DW_LANG_ObjC_plus_plus) {
+    const TagDecl *Def = TD->getDefinition();
+    if (CGM.getCodeGenOpts().DebugTypesSection && Def &&
+        Def->isCompleteDefinition() && !Def->isInvalidDecl() &&
+        Def->getDeclContext()->getRedeclContext()->isTranslationUnit()) {
+      FullName = Def->getName();
+      FullName += '.';
+      FullName += getStructuralTypeHash(Def);
+    }
+    return FullName;
+  }
+
   // FIXME: ODR should apply to ObjC++ exactly the same wasy it does to C++.
   // For now, only apply ODR with C++.
-  const TagDecl *TD = Ty->getDecl();
   if (TheCU.getLanguage() != llvm::dwarf::DW_LANG_C_plus_plus ||
       !TD->isExternallyVisible())
     return FullName;
@@ -614,6 +633,97 @@ static SmallString<256> getUniqueTagTypeName(const TagType *Ty,
   return FullName;
 }
 
+/// Hash the name, line and layout of a definition. The file name is left out,
+/// since a header is spelled differently by different translation units. As
+/// in the DWARF type signature computation, the types used by value are
+/// hashed with their structure. A type behind a pointer is hashed with its
+/// shallow hash, in which the types behind its own pointers are only told
+/// apart by name and by whether they are complete. That way a pointer to a
+/// complete type differs from one to an opaque type of the same name, and the
+/// hash of a recursive type stays finite.
+std::string CGDebugInfo::getStructuralTypeHash(const TagDecl *TD,
+                                               bool Shallow) {
+  auto &Cache = Shallow ? ShallowTypeHashCache : TypeHashCache;
+  auto I = Cache.find(TD);
+  if (I != Cache.end())
+    return I->second;
+
+  ASTContext &Ctx = CGM.getContext();
+  SmallString<256> Desc;
+  llvm::raw_svector_ostream OS(Desc);
+  OS << TD->getKindName() << ' ' << TD->getName();
+  PresumedLoc PLoc = Ctx.getSourceManager().getPresumedLoc(TD->getLocation());
+  if (PLoc.isValid())
+    OS << " line " << PLoc.getLine();
+
+  if (const auto *ED = dyn_cast<EnumDecl>(TD)) {
+    OS << " : " << ED->getIntegerType().getCanonicalType().getAsString();
+    for (const auto *Enum : ED->enumerators())
+      OS << "; " << Enum->getName() << " = "
+         << Enum->getInitVal().toString(10);
+  } else {
+    const auto *RD = cast<RecordDecl>(TD);
+    const ASTRecordLayout &Layout = Ctx.getASTRecordLayout(RD);
+    OS << " size " << Layout.getSize().getQuantity() << " align "
+       << Layout.getAlignment().getQuantity();
+    for (const auto *Field : RD->fields()) {
+      OS << "; " << Field->getName() << " at "
+         << Layout.getFieldOffset(Field->getFieldIndex());
+      if (Field->isBitField())
+        OS << " width " << Field->getBitWidthValue(Ctx);
+      OS << ' ';
+      describeTypeForHash(OS, Field->getType(), Shallow);
+    }
+  }
+  OS.flush();
+
+  llvm::MD5 Hash;
+  Hash.update(Desc);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Cache[TD] = Str.substr(0, 16);
+}
+
+void CGDebugInfo::describeTypeForHash(raw_ostream &OS, QualType Ty,
+                                      bool Shallow) {
+  ASTContext &Ctx = CGM.getContext();
+  bool BehindPointer = false;
+  for (;;) {
+    Ty = Ty.getCanonicalType();
+    if (const ConstantArrayType *AT = Ctx.getAsConstantArrayType(Ty)) {
+      OS << '[' << AT->getSize().getZExtValue() << ']';
+      Ty = AT->getElementType();
+    } else if (const PointerType *PT = Ty->getAs<PointerType>()) {
+      Qualifiers Quals = Ty.getQualifiers();
+      if (!Quals.empty())
+        OS << Quals.getAsString() << ' ';
+      OS << '*';
+      Ty = PT->getPointeeType();
+      BehindPointer = true;
+    } else {
+      break;
+    }
+  }
+
+  const TagType *TT = Ty->getAs<TagType>();
+  const TagDecl *Def = TT ? TT->getDecl()->getDefinition() : nullptr;
+  if (!Def || !Def->isCompleteDefinition() || Def->isInvalidDecl()) {
+    OS << Ty.getAsString();
+    return;
+  }
+  Qualifiers Quals = Ty.getQualifiers();
+  if (!Quals.empty())
+    OS << Quals.getAsString() << ' ';
+  if (!BehindPointer)
+    OS << '{' << getStructuralTypeHash(Def, Shallow) << '}';
+  else if (!Shallow)
+    OS << '{' << getStructuralTypeHash(Def, /*Shallow=*/true) << '}';
+  else
+    OS << '{' << Def->getKindName() << ' ' << Def->getName() << '}';
+}
+
 // Creates a forward declaration for a RecordDecl in the given context.
 llvm::DICompositeType
 CGDebugInfo::getOrCreateRecordFwdDecl(const RecordType *Ty,
@@ -636,7 +746,7 @@ CGDebugInfo::getOrCreateRecordFwdDecl(const RecordType *Ty,
   }
 
   // Create the type.
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  SmallString<256> FullName = getUniqueTagTypeName(Ty);
   llvm::DICompositeType RetTy = DBuilder.createReplaceableForwardDecl(
       Tag, RDName, Ctx, DefUnit, Line, 0, 0, 0, FullName);
   ReplaceMap.emplace_back(
@@ -1454,8 +1564,24 @@ void CGDebugInfo::completeType(const EnumDecl *ED) {
 
 void CGDebugInfo::completeType(const RecordDecl *RD) {
   if (DebugKind > CodeGenOptions::LimitedDebugInfo ||
-      !CGM.getLangOpts().CPlusPlus)
+      !CGM.getLangOpts().CPlusPlus) {
     completeRequiredType(RD);
+    return;
+  }
+
+  // The home of the classes defined in a header emits their definitions,
+  // whether or not it uses them, so that the other translation units can
+  // leave them out.
+  const CXXRecordDecl *CXXDecl = dyn_cast<CXXRecordDecl>(RD);
+  if (DebugKind != CodeGenOptions::LimitedDebugInfo ||
+      !CGM.getCodeGenOpts().DebugTypeHoming || !CXXDecl ||
+      CXXDecl->isDynamicClass())
+    return;
+  Optional<unsigned> Home = getManifestHome(CXXDecl);
+  if (!Home || *Home != *ThisManifestUnit)
+    return;
+  completeClassData(RD);
+  RetainedTypes.push_back(CGM.getContext().getRecordType(RD).getAsOpaquePtr());
 }
 
 void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
@@ -1466,6 +1592,9 @@ void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
     if (CXXDecl->isDynamicClass())
       return;
 
+  if (isHomedElsewhere(RD))
+    return;
+
   QualType Ty = CGM.getContext().getRecordType(RD);
   llvm::DIType T = getTypeOrNull(Ty);
   if (T && T.isForwardDecl())
@@ -1529,11 +1658,319 @@ static bool shouldOmitDefinition(CodeGenOptions::DebugInfoKind DebugKind,
   return false;
 }
 
+/// With -fdebug-type-homing, the definition of a class template
+/// specialization is at home where the specialization is explicitly
+/// instantiated, and the definition of any other class that has no vtable
+/// can be homed by the manifest.
+bool CGDebugInfo::isHomedElsewhere(const RecordDecl *RD) {
+  if (DebugKind != CodeGenOptions::LimitedDebugInfo ||
+      !CGM.getCodeGenOpts().DebugTypeHoming || !CGM.getLangOpts().CPlusPlus)
+    return false;
+
+  const CXXRecordDecl *CXXDecl = dyn_cast<CXXRecordDecl>(RD);
+  if (!CXXDecl || !CXXDecl->hasDefinition())
+    return false;
+  CXXDecl = CXXDecl->getDefinition();
+  if (CXXDecl->isDynamicClass())
+    return false;
+
+  StringRef Home;
+  if (CXXDecl->getTemplateSpecializationKind() ==
+      TSK_ExplicitInstantiationDeclaration) {
+    Home = "explicit instantiation";
+  } else {
+    Optional<unsigned> Unit = getManifestHome(CXXDecl);
+    if (!Unit || *Unit == *ThisManifestUnit)
+      return false;
+    Home = ManifestUnits[*Unit];
+  }
+  OmittedDefinitions[CXXDecl] = Home;
+  return true;
+}
+
+Optional<unsigned> CGDebugInfo::getManifestHome(const CXXRecordDecl *RD) {
+  if (CGM.getCodeGenOpts().DebugTypeHomingManifest.empty())
+    return None;
+
+  // The home has to emit the definition whether or not it uses the class, so
+  // only the classes that are the same entity everywhere, and that are not
+  // instantiated from templates, can be homed.
+  if (!RD->isExternallyVisible() || RD->isLambda())
+    return None;
+  for (const DeclContext *DC = RD; !DC->isFileContext();
+       DC = DC->getParent()) {
+    if (DC->isTransparentContext())
+      continue;
+    const CXXRecordDecl *Class = dyn_cast<CXXRecordDecl>(DC);
+    if (!Class || Class->isDependentContext() ||
+        Class->getTemplateSpecializationKind() != TSK_Undeclared)
+      return None;
+  }
+
+  // A class defined in the main file has no other home.
+  SourceManager &SM = CGM.getContext().getSourceManager();
+  FileID FID = SM.getFileID(SM.getExpansionLoc(RD->getLocation()));
+  const FileEntry *File = SM.getFileEntryForID(FID);
+  if (FID == SM.getMainFileID() || !File)
+    return None;
+
+  loadHomingManifest();
+  if (!ThisManifestUnit)
+    return None;
+  return getHeaderHome(File);
+}
+
+Optional<unsigned> CGDebugInfo::getHeaderHome(const FileEntry *File) {
+  auto Known = FileHomes.find(File);
+  if (Known != FileHomes.end())
+    return Known->second;
+
+  // Only look up the paths that end in the header's file name, and compare
+  // them by name before asking the file manager.
+  FileManager &FM = CGM.getContext().getSourceManager().getFileManager();
+  StringRef Name = File->getName();
+  Optional<unsigned> Home;
+  auto I = HeadersByName.find(llvm::sys::path::filename(Name));
+  if (I != HeadersByName.end()) {
+    for (StringRef Path : I->second) {
+      unsigned Unit = HeaderHomes[Path];
+      if ((!Home || Unit < *Home) && (Path == Name || FM.getFile(Path) == File))
+        Home = Unit;
+    }
+  }
+  FileHomes[File] = Home;
+  return Home;
+}
+
+/// The manifest is the concatenation of the make-style dependency files
+/// (as written by -MD) of the translation units of the program, in order.
+/// The first prerequisite of each rule is the source file of a translation
+/// unit, and the others are the files it includes. The file names are
+/// looked up from the working directory of this compilation, and only for
+/// the files that this compilation uses.
+void CGDebugInfo::loadHomingManifest() {
+  if (HomingManifestLoaded)
+    return;
+  HomingManifestLoaded = true;
+
+  StringRef Path = CGM.getCodeGenOpts().DebugTypeHomingManifest;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    DiagnosticsEngine &Diags = CGM.getDiags();
+    unsigned DiagID = Diags.getCustomDiagID(
+        DiagnosticsEngine::Error, "could not read homing manifest '%0': %1");
+    Diags.Report(DiagID) << Path << Buffer.getError().message();
+    return;
+  }
+
+  SourceManager &SM = CGM.getContext().getSourceManager();
+  FileManager &FM = SM.getFileManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  StringRef MainName = MainFile ? MainFile->getName() : "";
+  StringRef MainFileName = llvm::sys::path::filename(MainName);
+
+  StringRef Text = (*Buffer)->getBuffer();
+  std::vector<std::string> Prerequisites;
+  std::string Name;
+  bool InPrerequisites = false;
+  auto EndName = [&] {
+    if (!Name.empty()) {
+      if (InPrerequisites)
+        Prerequisites.push_back(Name);
+      else if (Name.back() == ':')
+        InPrerequisites = true;
+    }
+    Name.clear();
+  };
+  auto EndRule = [&] {
+    EndName();
+    // The rules that -MP adds for the headers have no prerequisites.
+    if (!Prerequisites.empty()) {
+      unsigned Unit = ManifestUnits.size();
+      StringRef Source = Prerequisites.front();
+      ManifestUnits.push_back(Prerequisites.front());
+      if (MainFile && !ThisManifestUnit &&
+          llvm::sys::path::filename(Source) == MainFileName &&
+          (Source == MainName || FM.getFile(Source) == MainFile))
+        ThisManifestUnit = Unit;
+      for (unsigned I = 1, E = Prerequisites.size(); I != E; ++I) {
+        auto Inserted = HeaderHomes.insert(std::make_pair(Prerequisites[I],
+                                                          Unit));
+        if (Inserted.second) {
+          StringRef Path = Inserted.first->getKey();
+          HeadersByName[llvm::sys::path::filename(Path)].push_back(Path);
+        }
+      }
+    }
+    Prerequisites.clear();
+    InPrerequisites = false;
+  };
+
+  for (size_t I = 0, E = Text.size(); I != E; ++I) {
+    char C = Text[I];
+    if (C == '\\' && I + 1 != E) {
+      char Next = Text[I + 1];
+      if (Next == '\n' || Next == '\r') {
+        // A continuation line.
+        EndName();
+        if (Next == '\r' && I + 2 != E && Text[I + 2] == '\n')
+          ++I;
+        ++I;
+        continue;
+      }
+      if (Next == ' ' || Next == '#') {
+        Name += Next;
+        ++I;
+        continue;
+      }
+    }
+    if (C == '$' && I + 1 != E && Text[I + 1] == '$') {
+      Name += '$';
+      ++I;
+      continue;
+    }
+    if (C == '\n')
+      EndRule();
+    else if (isWhitespace(C))
+      EndName();
+    else if (C == ':' && !InPrerequisites && !Name.empty() &&
+             (I + 1 == E || isWhitespace(Text[I + 1]))) {
+      Name += C;
+      EndName();
+    } else
+      Name += C;
+  }
+  EndRule();
+}
+
+/// Estimate the size of the DWARF for the definition of a type: a DIE for
+/// the type and for each of its members, each with its name and a few bytes
+/// of attributes. This errs on the high side, since the names are usually
+/// shared in the string section.
+static uint64_t estimateDefinitionSize(const TagDecl *TD, unsigned &Members) {
+  uint64_t Size = 8 + TD->getName().size() + 1;
+  Members = 0;
+  if (const EnumDecl *ED = dyn_cast<EnumDecl>(TD)) {
+    for (const auto *Enum : ED->enumerators()) {
+      Size += 4 + Enum->getName().size() + 1;
+      ++Members;
+    }
+    return Size;
+  }
+
+  const RecordDecl *RD = cast<RecordDecl>(TD);
+  for (const auto *Field : RD->fields()) {
+    Size += 12 + Field->getName().size() + 1;
+    ++Members;
+  }
+  const CXXRecordDecl *CXXDecl = dyn_cast<CXXRecordDecl>(RD);
+  if (!CXXDecl)
+    return Size;
+
+  Size += 8 * (CXXDecl->getNumBases() + CXXDecl->getNumVBases());
+  Members += CXXDecl->getNumBases() + CXXDecl->getNumVBases();
+  for (const auto *D : CXXDecl->decls()) {
+    if (const CXXMethodDecl *Method = dyn_cast<CXXMethodDecl>(D)) {
+      if (Method->isImplicit())
+        continue;
+      Size += 16 + Method->getNameAsString().size() + 1 +
+              4 * Method->getNumParams();
+      ++Members;
+    } else if (const VarDecl *Var = dyn_cast<VarDecl>(D)) {
+      Size += 12 + Var->getName().size() + 1;
+      ++Members;
+    }
+  }
+  if (const ClassTemplateSpecializationDecl *Spec =
+          dyn_cast<ClassTemplateSpecializationDecl>(CXXDecl)) {
+    Size += 8 * Spec->getTemplateArgs().size();
+    Members += Spec->getTemplateArgs().size();
+  }
+  return Size;
+}
+
+/// The report lists each tag type described in this translation unit, with
+/// the largest definitions first. The types left as declarations name the
+/// home of their definition where it is known.
+void CGDebugInfo::writeTypeReport() {
+  struct Entry {
+    std::string Name;
+    bool IsDefinition;
+    uint64_t Size;
+    unsigned Members;
+    StringRef Home;
+  };
+  std::vector<Entry> Entries;
+  PrintingPolicy Policy = CGM.getContext().getPrintingPolicy();
+  Policy.SuppressTagKeyword = true;
+  for (const auto &P : TypeCache) {
+    if (!P.second)
+      continue;
+    QualType Ty = QualType::getFromOpaquePtr(P.first);
+    const TagType *TT = dyn_cast<TagType>(Ty.getTypePtr());
+    if (!TT || Ty.hasLocalQualifiers())
+      continue;
+
+    const TagDecl *TD = TT->getDecl();
+    Entry E = {Ty.getAsString(Policy), false, 0, 0, StringRef()};
+    if (!llvm::DIType(cast<llvm::MDNode>(P.second)).isForwardDecl()) {
+      E.IsDefinition = true;
+      E.Size = estimateDefinitionSize(TD->getDefinition(), E.Members);
+    } else if (const TagDecl *Def = TD->getDefinition()) {
+      const CXXRecordDecl *CXXDecl = dyn_cast<CXXRecordDecl>(Def);
+      if (CXXDecl && CXXDecl->isDynamicClass())
+        E.Home = "vtable";
+      else if (const RecordDecl *RD = dyn_cast<RecordDecl>(Def))
+        E.Home = OmittedDefinitions.lookup(RD);
+    }
+    Entries.push_back(E);
+  }
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+    if (LHS.Size != RHS.Size)
+      return LHS.Size > RHS.Size;
+    return LHS.Name < RHS.Name;
+  });
+
+  StringRef File = CGM.getCodeGenOpts().DebugTypeReportFile;
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(File, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    DiagnosticsEngine &Diags = CGM.getDiags();
+    unsigned DiagID = Diags.getCustomDiagID(
+        DiagnosticsEngine::Error, "could not write type report '%0': %1");
+    Diags.Report(DiagID) << File << EC.message();
+    return;
+  }
+
+  unsigned Definitions = 0, Declarations = 0, Homed = 0;
+  uint64_t TotalSize = 0;
+  OS << "# type\tname\tkind\test-bytes\tmembers\thome\n";
+  for (const Entry &E : Entries) {
+    OS << "type\t" << E.Name << '\t'
+       << (E.IsDefinition ? "definition" : "declaration") << '\t' << E.Size
+       << '\t' << E.Members << '\t' << (E.Home.empty() ? "-" : E.Home)
+       << '\n';
+    if (E.IsDefinition)
+      ++Definitions;
+    else
+      ++Declarations;
+    if (!E.Home.empty())
+      ++Homed;
+    TotalSize += E.Size;
+  }
+  OS << "# total\tdefinitions\tdeclarations\thomed-elsewhere\test-bytes\n";
+  OS << "total\t" << Definitions << '\t' << Declarations << '\t' << Homed
+     << '\t' << TotalSize << '\n';
+}
+
 /// CreateType - get structure or union type.
 llvm::DIType CGDebugInfo::CreateType(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
   llvm::DICompositeType T(getTypeOrNull(QualType(Ty, 0)));
-  if (T || shouldOmitDefinition(DebugKind, RD, CGM.getLangOpts())) {
+  if (T || shouldOmitDefinition(DebugKind, RD, CGM.getLangOpts()) ||
+      isHomedElsewhere(RD)) {
     if (!T)
       T = getOrCreateRecordFwdDecl(
           Ty, getContextDescriptor(cast<Decl>(RD->getDeclContext())));
@@ -1915,7 +2352,7 @@ llvm::DIType CGDebugInfo::CreateEnumType(const EnumType *Ty) {
     Align = CGM.getContext().getTypeAlign(ED->getTypeForDecl());
   }
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  SmallString<256> FullName = getUniqueTagTypeName(Ty);
 
   // If this is just a forward declaration, construct an appropriately
   // marked node and just return it.
@@ -1946,7 +2383,7 @@ llvm::DIType CGDebugInfo::CreateTypeDefinition(const EnumType *Ty) {
     Align = CGM.getContext().getTypeAlign(ED->getTypeForDecl());
   }
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  SmallString<256> FullName = getUniqueTagTypeName(Ty);
 
   // Create DIEnumerator elements for each enumerator.
   SmallVector<llvm::Metadata *, 16> Enumerators;
@@ -2239,7 +2676,7 @@ llvm::DICompositeType CGDebugInfo::CreateLimitedType(const RecordType *Ty) {
   uint64_t Align = CGM.getContext().getTypeAlign(Ty);
   llvm::DICompositeType RealDecl;
 
-  SmallString<256> FullName = getUniqueTagTypeName(Ty, CGM, TheCU);
+  SmallString<256> FullName = getUniqueTagTypeName(Ty);
 
   if (RD->isUnion())
     RealDecl = DBuilder.createUnionType(RDContext, RDName, DefUnit, Line, Size,
@@ -3413,6 +3850,9 @@ void CGDebugInfo::finalize() {
          RE = RetainedTypes.end(); RI != RE; ++RI)
     DBuilder.retainType(llvm::DIType(cast<llvm::MDNode>(TypeCache[*RI])));
 
+  if (!CGM.getCodeGenOpts().DebugTypeReportFile.empty())
+    writeTypeReport();
+
   DBuilder.finalize();
 }
 
@@ -20,6 +20,8 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/ValueHandle.h"
@@ -37,6 +39,7 @@ namespace clang {
   class ClassTemplateSpecializationDecl;
   class GlobalDecl;
   class UsingDecl;
+  class FileEntry;
 
 namespace CodeGen {
   class CodeGenModule;
@@ -115,6 +118,39 @@ class CGDebugInfo {
       NamespaceAliasCache;
   llvm::DenseMap<const Decl *, llvm::TrackingMDRef> StaticDataMemberCache;
 
+  /// TypeHashCache - Cache of the structural hashes of tag type definitions,
+  /// in hex.
+  llvm::DenseMap<const TagDecl *, std::string> TypeHashCache;
+
+  /// ShallowTypeHashCache - Cache of the shallow structural hashes of tag
+  /// type definitions, which are used for the types behind pointers.
+  llvm::DenseMap<const TagDecl *, std::string> ShallowTypeHashCache;
+
+  /// HomingManifestLoaded - Whether the -fdebug-type-homing-manifest has
+  /// been read.
+  bool HomingManifestLoaded;
+
+  /// ManifestUnits - The translation units listed in the homing manifest, in
+  /// order, and the position of this one among them, if it is listed.
+  std::vector<std::string> ManifestUnits;
+  Optional<unsigned> ThisManifestUnit;
+
+  /// HeaderHomes - The first translation unit of the homing manifest that
+  /// includes each header, by the path the manifest lists it under.
+  llvm::StringMap<unsigned> HeaderHomes;
+
+  /// HeadersByName - The paths in HeaderHomes, by their last component, so
+  /// that only the paths that can name a header need to be looked up.
+  llvm::StringMap<SmallVector<StringRef, 1>> HeadersByName;
+
+  /// FileHomes - The home of each header that a class was defined in, as
+  /// found in HeaderHomes, if any.
+  llvm::DenseMap<const FileEntry *, Optional<unsigned>> FileHomes;
+
+  /// OmittedDefinitions - The classes whose definition was left out because
+  /// it has a home elsewhere, and the name of that home.
+  llvm::DenseMap<const RecordDecl *, StringRef> OmittedDefinitions;
+
   /// Helper functions for getOrCreateType.
   unsigned Checksum(const ObjCInterfaceDecl *InterfaceDecl);
   llvm::DIType CreateType(const BuiltinType *Ty);
@@ -331,6 +367,39 @@ private:
   llvm::DICompositeType getOrCreateRecordFwdDecl(const RecordType *,
                                                  llvm::DIDescriptor);
 
+  /// getUniqueTagTypeName - Get the identifier of a tag type that is the
+  /// same in every translation unit, or an empty string if it has none.
+  SmallString<256> getUniqueTagTypeName(const TagType *Ty);
+
+  /// getStructuralTypeHash - Get a hash of the definition \p TD, which is
+  /// the same in every translation unit that sees the same definition. The
+  /// \p Shallow hash only looks at whether the types behind pointers are
+  /// complete.
+  std::string getStructuralTypeHash(const TagDecl *TD, bool Shallow = false);
+
+  /// describeTypeForHash - Describe a type used in a definition that is
+  /// being hashed.
+  void describeTypeForHash(raw_ostream &OS, QualType Ty, bool Shallow);
+
+  /// loadHomingManifest - Read the -fdebug-type-homing-manifest.
+  void loadHomingManifest();
+
+  /// getHeaderHome - Get the position in the homing manifest of the first
+  /// translation unit that includes a header.
+  Optional<unsigned> getHeaderHome(const FileEntry *File);
+
+  /// getManifestHome - Get the position in the homing manifest of the
+  /// translation unit that is the home of the definition of a class, if the
+  /// class can be homed by the manifest.
+  Optional<unsigned> getManifestHome(const CXXRecordDecl *RD);
+
+  /// isHomedElsewhere - Whether the definition of a class is left out of
+  /// this translation unit with -fdebug-type-homing.
+  bool isHomedElsewhere(const RecordDecl *RD);
+
+  /// writeTypeReport - Write the -fdebug-type-report.
+  void writeTypeReport();
+
   /// createContextChain - Create a set of decls for the context chain.
   llvm::DIDescriptor createContextChain(const Decl *Decl);
 
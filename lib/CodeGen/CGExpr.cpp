@@ -3350,6 +3350,8 @@ RValue CodeGenFunction::EmitCall(QualType CalleeType, llvm::Value *Callee,
     }
   }
 
+  PGO.emitValueSiteCounters(*this, E, Callee);
+
   CallArgList Args;
   EmitCallArgs(Args, dyn_cast<FunctionProtoType>(FnType), E->arg_begin(),
                E->arg_end(), E->getDirectCallee(), /*ParamsToSkip*/ 0,
@@ -3381,7 +3383,11 @@ RValue CodeGenFunction::EmitCall(QualType CalleeType, llvm::Value *Callee,
     Callee = Builder.CreateBitCast(Callee, CalleeTy, "callee.knr.cast");
   }
 
-  return EmitCall(FnInfo, Callee, ReturnValue, Args, TargetDecl);
+  llvm::Instruction *CallOrInvoke = nullptr;
+  RValue RV =
+      EmitCall(FnInfo, Callee, ReturnValue, Args, TargetDecl, &CallOrInvoke);
+  PGO.applyValueSiteProfile(E, CallOrInvoke);
+  return RV;
 }
 
 LValue CodeGenFunction::
@@ -72,14 +72,14 @@ static RequiredArgs commonEmitCXXMemberOrOperatorCall(
 RValue CodeGenFunction::EmitCXXMemberOrOperatorCall(
     const CXXMethodDecl *MD, llvm::Value *Callee, ReturnValueSlot ReturnValue,
     llvm::Value *This, llvm::Value *ImplicitParam, QualType ImplicitParamTy,
-    const CallExpr *CE) {
+    const CallExpr *CE, llvm::Instruction **CallOrInvoke) {
   const FunctionProtoType *FPT = MD->getType()->castAs<FunctionProtoType>();
   CallArgList Args;
   RequiredArgs required = commonEmitCXXMemberOrOperatorCall(
       *this, MD, Callee, ReturnValue, This, ImplicitParam, ImplicitParamTy, CE,
       Args);
   return EmitCall(CGM.getTypes().arrangeCXXMethodCall(Args, FPT, required),
-                  Callee, ReturnValue, Args, MD);
+                  Callee, ReturnValue, Args, MD, CallOrInvoke);
 }
 
 RValue CodeGenFunction::EmitCXXStructorCall(
@@ -257,6 +257,7 @@ RValue CodeGenFunction::EmitCXXMemberOrOperatorMemberCallExpr(
     Callee = CGM.GetAddrOfFunction(GlobalDecl(Ctor, Ctor_Complete), Ty);
   } else if (UseVirtualCall) {
     Callee = CGM.getCXXABI().getVirtualFunctionPointer(*this, MD, This, Ty);
+    PGO.emitValueSiteCounters(*this, CE, Callee);
   } else {
     if (getLangOpts().AppleKext && MD->isVirtual() && HasQualifier)
       Callee = BuildAppleKextVirtualCall(MD, Qualifier, Ty);
@@ -272,8 +273,13 @@ RValue CodeGenFunction::EmitCXXMemberOrOperatorMemberCallExpr(
         *this, MD, This, UseVirtualCall);
   }
 
-  return EmitCXXMemberOrOperatorCall(MD, Callee, ReturnValue, This,
-                                     /*ImplicitParam=*/nullptr, QualType(), CE);
+  llvm::Instruction *CallOrInvoke = nullptr;
+  RValue RV = EmitCXXMemberOrOperatorCall(MD, Callee, ReturnValue, This,
+                                          /*ImplicitParam=*/nullptr, QualType(),
+                                          CE, &CallOrInvoke);
+  if (UseVirtualCall)
+    PGO.applyValueSiteProfile(CE, CallOrInvoke);
+  return RV;
 }
 
 RValue
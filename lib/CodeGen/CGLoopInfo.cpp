@@ -8,11 +8,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "CGLoopInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Metadata.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace clang;
 using namespace CodeGen;
 using namespace llvm;
@@ -73,13 +79,33 @@ void LoopAttributes::clear() {
   VectorizerEnable = LoopAttributes::VecUnspecified;
 }
 
-LoopInfo::LoopInfo(BasicBlock *Header, const LoopAttributes &Attrs)
-    : LoopID(nullptr), Header(Header), Attrs(Attrs) {
+LoopInfo::LoopInfo(BasicBlock *Header, const LoopAttributes &Attrs,
+                   ReportedLoop *Report)
+    : LoopID(nullptr), Header(Header), Attrs(Attrs), Report(Report) {
   LoopID = createMetadata(Header->getContext(), Attrs);
 }
 
-void LoopInfoStack::push(BasicBlock *Header) {
-  Active.push_back(LoopInfo(Header, StagedAttrs));
+/// \brief Record the attributes of a loop in its report entry, spelled as the
+/// equivalent '#pragma clang loop' hints.
+static void reportAttributes(ReportedLoop &Report,
+                             const LoopAttributes &Attrs) {
+  if (Attrs.IsParallel)
+    Report.addHint("parallel");
+  if (Attrs.VectorizerEnable != LoopAttributes::VecUnspecified)
+    Report.addHint(Attrs.VectorizerEnable == LoopAttributes::VecEnable
+                       ? "vectorize(enable)"
+                       : "vectorize(disable)");
+  if (Attrs.VectorizerWidth > 0)
+    Report.addHint("vectorize_width(" + utostr(Attrs.VectorizerWidth) + ")");
+  if (Attrs.VectorizerUnroll > 0)
+    Report.addHint("interleave_count(" + utostr(Attrs.VectorizerUnroll) +
+                   ")");
+}
+
+void LoopInfoStack::push(BasicBlock *Header, ReportedLoop *Report) {
+  if (Report)
+    reportAttributes(*Report, StagedAttrs);
+  Active.push_back(LoopInfo(Header, StagedAttrs, Report));
   // Clear the attributes so nested loops do not inherit them.
   StagedAttrs.clear();
 }
@@ -109,3 +135,139 @@ void LoopInfoStack::InsertHelper(Instruction *I) const {
   if (L.getAttributes().IsParallel && I->mayReadOrWriteMemory())
     I->setMetadata("llvm.mem.parallel_loop_access", L.getLoopID());
 }
+
+void ReportedLoop::addHint(StringRef Hint) {
+  if (std::find(Hints.begin(), Hints.end(), Hint) == Hints.end())
+    Hints.push_back(Hint.str());
+}
+
+ReportedLoop *LoopReport::getLoop(StringRef File, unsigned Line,
+                                  unsigned Column, unsigned EndLine,
+                                  const char *Kind, StringRef Function) {
+  std::string Key;
+  raw_string_ostream(Key) << File << ':' << Line << ':' << Column;
+  ReportedLoop *&Loop = LoopsByLocation[Key];
+  if (Loop)
+    return Loop;
+
+  Loops.push_back(llvm::make_unique<ReportedLoop>());
+  Loop = Loops.back().get();
+  Loop->Kind = Kind;
+  Loop->Function = Function.str();
+  Loop->File = File.str();
+  Loop->Line = Line;
+  Loop->Column = Column;
+  Loop->EndLine = EndLine;
+
+  // Nested loops start after the loops that contain them, so the innermost
+  // loop containing a line is the one that starts last.
+  unsigned FileNo =
+      FileNumbers.insert(std::make_pair(File, FileNumbers.size()))
+          .first->second;
+  for (unsigned L = Line; L <= EndLine; ++L) {
+    ReportedLoop *&Innermost = LoopsByLine[std::make_pair(FileNo, L)];
+    if (!Innermost || Line > Innermost->Line ||
+        (Line == Innermost->Line && Column > Innermost->Column))
+      Innermost = Loop;
+  }
+  return Loop;
+}
+
+/// \brief Whether the remarks of \p Pass are about the loops it transforms,
+/// rather than about an instruction that happens to be in a loop.
+static bool isLoopPass(StringRef Pass) {
+  return StringSwitch<bool>(Pass)
+      .Cases("loop-vectorize", "loop-unroll", "loop-unswitch", true)
+      .Cases("loop-idiom", "loop-rotate", "loop-deletion", "licm", true)
+      .Cases("indvars", "loop-reduce", "loop-simplify", true)
+      .Default(false);
+}
+
+void LoopReport::addRemark(StringRef File, unsigned Line, StringRef Pass,
+                           const char *Kind, StringRef Message) {
+  llvm::StringMap<unsigned>::const_iterator F = FileNumbers.find(File);
+  if (F == FileNumbers.end())
+    return;
+  auto I = LoopsByLine.find(std::make_pair(F->second, Line));
+  if (I == LoopsByLine.end())
+    return;
+
+  // A remark of a loop pass is about the innermost loop containing its line.
+  // Other passes, such as the inliner, only make remarks about a loop if they
+  // are located where the loop starts; a loop starting on the line would be
+  // the innermost one.
+  ReportedLoop *Innermost = I->second;
+  if (!isLoopPass(Pass) && Innermost->Line != Line)
+    return;
+
+  // Each emission of a loop in a template gets the same remarks.
+  for (const auto &R : Innermost->Remarks)
+    if (R.Pass == Pass && StringRef(R.Kind) == Kind && R.Message == Message)
+      return;
+  ReportedLoop::Remark R = {Pass.str(), Kind, Message.str()};
+  Innermost->Remarks.push_back(R);
+}
+
+/// \brief Write \p S as a JSON string.
+static void writeString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (unsigned char C : S) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C == '\n')
+      OS << "\\n";
+    else if (C == '\t')
+      OS << "\\t";
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void LoopReport::write(raw_ostream &OS) const {
+  std::vector<const ReportedLoop *> Sorted;
+  for (const auto &Loop : Loops)
+    Sorted.push_back(Loop.get());
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const ReportedLoop *A, const ReportedLoop *B) {
+    if (A->File != B->File)
+      return A->File < B->File;
+    if (A->Line != B->Line)
+      return A->Line < B->Line;
+    return A->Column < B->Column;
+  });
+
+  OS << "{\n  \"loops\": [";
+  for (unsigned I = 0, E = Sorted.size(); I != E; ++I) {
+    const ReportedLoop &Loop = *Sorted[I];
+    OS << (I ? ",\n" : "\n") << "    {\n      \"file\": ";
+    writeString(OS, Loop.File);
+    OS << ",\n      \"line\": " << Loop.Line
+       << ",\n      \"column\": " << Loop.Column
+       << ",\n      \"end-line\": " << Loop.EndLine
+       << ",\n      \"kind\": ";
+    writeString(OS, Loop.Kind);
+    OS << ",\n      \"function\": ";
+    writeString(OS, Loop.Function);
+
+    OS << ",\n      \"hints\": [";
+    for (unsigned H = 0, HE = Loop.Hints.size(); H != HE; ++H) {
+      OS << (H ? ", " : "");
+      writeString(OS, Loop.Hints[H]);
+    }
+
+    OS << "],\n      \"remarks\": [";
+    for (unsigned R = 0, RE = Loop.Remarks.size(); R != RE; ++R) {
+      const ReportedLoop::Remark &Remark = Loop.Remarks[R];
+      OS << (R ? ",\n" : "\n") << "        {\"pass\": ";
+      writeString(OS, Remark.Pass);
+      OS << ", \"kind\": \"" << Remark.Kind << "\", \"message\": ";
+      writeString(OS, Remark.Message);
+      OS << "}";
+    }
+    OS << (Loop.Remarks.empty() ? "]" : "\n      ]") << "\n    }";
+  }
+  OS << (Sorted.empty() ? "]" : "\n  ]") << "\n}\n";
+}
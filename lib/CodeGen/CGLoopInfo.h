@@ -15,15 +15,21 @@
 #ifndef LLVM_CLANG_LIB_CODEGEN_CGLOOPINFO_H
 #define LLVM_CLANG_LIB_CODEGEN_CGLOOPINFO_H
 
+#include "clang/Basic/LLVM.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Support/Compiler.h"
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace llvm {
 class BasicBlock;
 class Instruction;
 class MDNode;
+class raw_ostream;
 } // end namespace llvm
 
 namespace clang {
@@ -50,11 +56,79 @@ struct LoopAttributes {
   unsigned VectorizerUnroll;
 };
 
+/// \brief A source loop described by -floop-report.
+struct ReportedLoop {
+  /// \brief A remark of the optimizer about the loop.
+  struct Remark {
+    std::string Pass;
+    /// \brief One of "passed", "missed", "analysis" or "failure".
+    const char *Kind;
+    std::string Message;
+  };
+
+  /// \brief The class name of the loop statement, such as "ForStmt".
+  const char *Kind;
+  /// \brief The function the loop was first emitted in.
+  std::string Function;
+  std::string File;
+  unsigned Line, Column, EndLine;
+  /// \brief The hints applied to the loop, spelled as in the pragma.
+  std::vector<std::string> Hints;
+  std::vector<Remark> Remarks;
+
+  /// \brief Record that \p Hint was applied to the loop. A loop emitted more
+  /// than once, such as one in a template, only lists a hint once.
+  void addHint(StringRef Hint);
+};
+
+/// \brief The loops of a translation unit, the hints applied to them and what
+/// the optimizer decided about them.
+///
+/// Loops are identified by their source location, so that each instantiation
+/// of a loop in a template contributes to the same entry. Remarks from the
+/// loop passes of the backend are attributed to the innermost loop whose lines
+/// contain the remark's location, as the debug locations of the remarks carry
+/// no column unless -gcolumn-info is in effect. Remarks from other passes are
+/// only attributed to a loop that starts on the remark's line.
+class LoopReport {
+  LoopReport(const LoopReport &) LLVM_DELETED_FUNCTION;
+  void operator=(const LoopReport &) LLVM_DELETED_FUNCTION;
+
+  std::vector<std::unique_ptr<ReportedLoop>> Loops;
+  /// \brief The loops by "file:line:column".
+  llvm::StringMap<ReportedLoop *> LoopsByLocation;
+
+  /// \brief The files that contain loops, numbered in the order they are
+  /// seen.
+  llvm::StringMap<unsigned> FileNumbers;
+  /// \brief The innermost loop that contains each line, by file number and
+  /// line.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, ReportedLoop *> LoopsByLine;
+
+public:
+  LoopReport() {}
+
+  /// \brief Get the entry for the loop at the given location, creating it if
+  /// this is the first time the loop is emitted.
+  ReportedLoop *getLoop(StringRef File, unsigned Line, unsigned Column,
+                        unsigned EndLine, const char *Kind,
+                        StringRef Function);
+
+  /// \brief Attribute a remark of pass \p Pass about \p File:\p Line to its
+  /// loop. Remarks that are not about a loop are dropped.
+  void addRemark(StringRef File, unsigned Line, StringRef Pass,
+                 const char *Kind, StringRef Message);
+
+  /// \brief Write the report as JSON, with the loops in source order.
+  void write(llvm::raw_ostream &OS) const;
+};
+
 /// \brief Information used when generating a structured loop.
 class LoopInfo {
 public:
   /// \brief Construct a new LoopInfo for the loop with entry Header.
-  LoopInfo(llvm::BasicBlock *Header, const LoopAttributes &Attrs);
+  LoopInfo(llvm::BasicBlock *Header, const LoopAttributes &Attrs,
+           ReportedLoop *Report = nullptr);
 
   /// \brief Get the loop id metadata for this loop.
   llvm::MDNode *getLoopID() const { return LoopID; }
@@ -65,6 +139,9 @@ public:
   /// \brief Get the set of attributes active for this loop.
   const LoopAttributes &getAttributes() const { return Attrs; }
 
+  /// \brief Get the report entry of this loop, if loops are being reported.
+  ReportedLoop *getReport() const { return Report; }
+
 private:
   /// \brief Loop ID metadata.
   llvm::MDNode *LoopID;
@@ -72,6 +149,8 @@ private:
   llvm::BasicBlock *Header;
   /// \brief The attributes for this loop.
   LoopAttributes Attrs;
+  /// \brief The report entry of this loop.
+  ReportedLoop *Report;
 };
 
 /// \brief A stack of loop information corresponding to loop nesting levels.
@@ -85,8 +164,9 @@ public:
   LoopInfoStack() {}
 
   /// \brief Begin a new structured loop. The set of staged attributes will be
-  /// applied to the loop and then cleared.
-  void push(llvm::BasicBlock *Header);
+  /// applied to the loop and then cleared. If \p Report is given, the staged
+  /// attributes are recorded in it as hints.
+  void push(llvm::BasicBlock *Header, ReportedLoop *Report = nullptr);
 
   /// \brief End the current loop.
   void pop();
@@ -94,6 +174,11 @@ public:
   /// \brief Return the top loop id metadata.
   llvm::MDNode *getCurLoopID() const { return getInfo().getLoopID(); }
 
+  /// \brief Return the report entry of the top loop, if any.
+  ReportedLoop *getCurLoopReport() const {
+    return hasInfo() ? getInfo().getReport() : nullptr;
+  }
+
   /// \brief Return true if the top loop is parallel.
   bool getCurLoopParallel() const {
     return hasInfo() ? getInfo().getAttributes().IsParallel : false;
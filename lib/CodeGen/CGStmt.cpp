@@ -594,6 +594,7 @@ void CodeGenFunction::EmitCondBrHints(llvm::LLVMContext &Context,
   //
   // FIXME: Should this really start with a size of 1?
   SmallVector<llvm::Metadata *, 2> Metadata(1);
+  ReportedLoop *Report = LoopStack.getCurLoopReport();
   for (const auto *Attr : Attrs) {
     const LoopHintAttr *LH = dyn_cast<LoopHintAttr>(Attr);
 
@@ -631,6 +632,17 @@ void CodeGenFunction::EmitCondBrHints(llvm::LLVMContext &Context,
       ValueInt = static_cast<int>(ValueAPS.getSExtValue());
     }
 
+    if (Report) {
+      std::string Hint = LoopHintAttr::getOptionName(Option);
+      if (ValueExpr)
+        Hint += "(" + llvm::itostr(ValueInt) + ")";
+      else if (State == LoopHintAttr::Disable)
+        Hint += "(disable)";
+      else
+        Hint += Option == LoopHintAttr::Unroll ? "(full)" : "(enable)";
+      Report->addHint(Hint);
+    }
+
     llvm::Constant *Value;
     llvm::MDString *Name;
     switch (Option) {
@@ -677,6 +689,21 @@ void CodeGenFunction::EmitCondBrHints(llvm::LLVMContext &Context,
   }
 }
 
+ReportedLoop *CodeGenFunction::getReportedLoop(const Stmt &S) {
+  LoopReport *Report = CGM.getLoopReport();
+  if (!Report)
+    return nullptr;
+
+  SourceManager &SM = getContext().getSourceManager();
+  PresumedLoc Begin = SM.getPresumedLoc(SM.getExpansionLoc(S.getLocStart()));
+  PresumedLoc End = SM.getPresumedLoc(SM.getExpansionLoc(S.getLocEnd()));
+  if (Begin.isInvalid() || End.isInvalid())
+    return nullptr;
+  return Report->getLoop(Begin.getFilename(), Begin.getLine(),
+                         Begin.getColumn(), End.getLine(),
+                         S.getStmtClassName(), CurFn->getName());
+}
+
 void CodeGenFunction::EmitWhileStmt(const WhileStmt &S,
                                     ArrayRef<const Attr *> WhileAttrs) {
   RegionCounter Cnt = getPGORegionCounter(&S);
@@ -686,7 +713,7 @@ void CodeGenFunction::EmitWhileStmt(const WhileStmt &S,
   JumpDest LoopHeader = getJumpDestInCurrentScope("while.cond");
   EmitBlock(LoopHeader.getBlock());
 
-  LoopStack.push(LoopHeader.getBlock());
+  LoopStack.push(LoopHeader.getBlock(), getReportedLoop(S));
 
   // Create an exit block for when the condition fails, which will
   // also become the break target.
@@ -780,7 +807,7 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S,
   // Emit the body of the loop.
   llvm::BasicBlock *LoopBody = createBasicBlock("do.body");
 
-  LoopStack.push(LoopBody);
+  LoopStack.push(LoopBody, getReportedLoop(S));
 
   EmitBlockWithFallThrough(LoopBody, Cnt);
   {
@@ -847,7 +874,7 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S,
   llvm::BasicBlock *CondBlock = Continue.getBlock();
   EmitBlock(CondBlock);
 
-  LoopStack.push(CondBlock);
+  LoopStack.push(CondBlock, getReportedLoop(S));
 
   // If the for loop doesn't have an increment we can just use the
   // condition as the continue block.  Otherwise we'll need to create
@@ -947,7 +974,7 @@ CodeGenFunction::EmitCXXForRangeStmt(const CXXForRangeStmt &S,
   llvm::BasicBlock *CondBlock = createBasicBlock("for.cond");
   EmitBlock(CondBlock);
 
-  LoopStack.push(CondBlock);
+  LoopStack.push(CondBlock, getReportedLoop(S));
 
   // If there are any cleanups between here and the loop-exit scope,
   // create a block to stage a loop exit along.
@@ -277,7 +277,10 @@ void CodeGenFunction::EmitOMPInnerLoop(const OMPLoopDirective &S,
   // Start the loop with a block that tests the condition.
   auto CondBlock = createBasicBlock("omp.inner.for.cond");
   EmitBlock(CondBlock);
-  LoopStack.push(CondBlock);
+  // Report the loop under the statement it was written as.
+  LoopStack.push(CondBlock,
+                 getReportedLoop(*cast<CapturedStmt>(S.getAssociatedStmt())
+                                      ->getCapturedStmt()));
 
   // If there are any cleanups between here and the loop-exit scope,
   // create a block to stage a loop exit along.
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "CGLoopInfo.h"
 #include "CoverageMappingGen.h"
 #include "clang/CodeGen/CodeGenAction.h"
 #include "clang/AST/ASTConsumer.h"
@@ -31,6 +32,7 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/Timer.h"
@@ -51,10 +53,26 @@ namespace clang {
 
     Timer LLVMIRGeneration;
 
+    /// The loops to describe in the -floop-report file, if any.
+    std::unique_ptr<CodeGen::LoopReport> Loops;
+
     std::unique_ptr<CodeGenerator> Gen;
 
     std::unique_ptr<llvm::Module> TheModule, LinkModule;
 
+    /// Generates code for functions as they are completed, with
+    /// -fstreaming-codegen.
+    std::unique_ptr<StreamingBackend> Streamer;
+
+    /// StreamCompletedFunctions - Generate code for the functions that are
+    /// complete, if streaming.
+    void StreamCompletedFunctions() {
+      if (!Streamer || Diags.hasErrorOccurred())
+        return;
+      BackendDiagnosticsRAII Handlers(TheModule->getContext(), this);
+      Streamer->EmitCompletedFunctions();
+    }
+
   public:
     BackendConsumer(BackendAction action, DiagnosticsEngine &_Diags,
                     const CodeGenOptions &compopts,
@@ -66,8 +84,10 @@ namespace clang {
         : Diags(_Diags), Action(action), CodeGenOpts(compopts),
           TargetOpts(targetopts), LangOpts(langopts), AsmOutStream(OS),
           Context(), LLVMIRGeneration("LLVM IR Generation Time"),
+          Loops(compopts.LoopReportFile.empty() ? nullptr
+                                                : new CodeGen::LoopReport()),
           Gen(CreateLLVMCodeGen(Diags, infile, compopts,
-                                targetopts, C, CoverageInfo)),
+                                targetopts, C, CoverageInfo, Loops.get())),
           LinkModule(LinkModule) {
       llvm::TimePassesIsEnabled = TimePasses;
     }
@@ -91,6 +111,13 @@ namespace clang {
 
       if (llvm::TimePassesIsEnabled)
         LLVMIRGeneration.stopTimer();
+
+      if (!LinkModule)
+        Streamer.reset(CreateStreamingBackend(Diags, CodeGenOpts, TargetOpts,
+                                              LangOpts, TheModule.get(),
+                                              Action, AsmOutStream));
+      if (Streamer)
+        Gen->SetStreamingBackend(Streamer.get());
     }
 
     bool HandleTopLevelDecl(DeclGroupRef D) override {
@@ -106,6 +133,7 @@ namespace clang {
       if (llvm::TimePassesIsEnabled)
         LLVMIRGeneration.stopTimer();
 
+      StreamCompletedFunctions();
       return true;
     }
 
@@ -120,6 +148,8 @@ namespace clang {
 
       if (llvm::TimePassesIsEnabled)
         LLVMIRGeneration.stopTimer();
+
+      StreamCompletedFunctions();
     }
 
     void HandleTranslationUnit(ASTContext &C) override {
@@ -159,26 +189,38 @@ namespace clang {
           return;
       }
 
-      // Install an inline asm handler so that diagnostics get printed through
-      // our diagnostics hooks.
-      LLVMContext &Ctx = TheModule->getContext();
-      LLVMContext::InlineAsmDiagHandlerTy OldHandler =
-        Ctx.getInlineAsmDiagnosticHandler();
-      void *OldContext = Ctx.getInlineAsmDiagnosticContext();
-      Ctx.setInlineAsmDiagnosticHandler(InlineAsmDiagHandler, this);
+      // Have the diagnostics from the backend printed through our hooks.
+      BackendDiagnosticsRAII Handlers(TheModule->getContext(), this);
 
-      LLVMContext::DiagnosticHandlerTy OldDiagnosticHandler =
-          Ctx.getDiagnosticHandler();
-      void *OldDiagnosticContext = Ctx.getDiagnosticContext();
-      Ctx.setDiagnosticHandler(DiagnosticHandler, this);
+      if (Streamer)
+        Streamer->Finish(C.getTargetInfo().getTargetDescription());
+      else
+        EmitBackendOutput(Diags, CodeGenOpts, TargetOpts, LangOpts,
+                          C.getTargetInfo().getTargetDescription(),
+                          TheModule.get(), Action, AsmOutStream);
 
-      EmitBackendOutput(Diags, CodeGenOpts, TargetOpts, LangOpts,
-                        C.getTargetInfo().getTargetDescription(),
-                        TheModule.get(), Action, AsmOutStream);
+      if (Loops)
+        WriteLoopReport();
+    }
 
-      Ctx.setInlineAsmDiagnosticHandler(OldHandler, OldContext);
+    /// WriteLoopReport - Write the loops and the optimizer's remarks about
+    /// them to the -floop-report file.
+    void WriteLoopReport() {
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(CodeGenOpts.LoopReportFile, EC,
+                              llvm::sys::fs::F_Text);
+      if (EC) {
+        Diags.Report(diag::err_fe_unable_to_open_output)
+            << CodeGenOpts.LoopReportFile << EC.message();
+        return;
+      }
+      Loops->write(OS);
+    }
 
-      Ctx.setDiagnosticHandler(OldDiagnosticHandler, OldDiagnosticContext);
+    void PrintStats() override {
+      Gen->PrintStats();
+      if (Streamer)
+        Streamer->PrintStats();
     }
 
     void HandleTagDeclDefinition(TagDecl *D) override {
@@ -213,6 +255,32 @@ namespace clang {
       Gen->HandleDependentLibrary(Opts);
     }
 
+    /// BackendDiagnosticsRAII - Installs an inline asm handler and a
+    /// diagnostic handler so that the diagnostics from the backend get printed
+    /// through our diagnostics hooks, while it is in scope.
+    class BackendDiagnosticsRAII {
+      LLVMContext &Ctx;
+      LLVMContext::InlineAsmDiagHandlerTy OldHandler;
+      void *OldContext;
+      LLVMContext::DiagnosticHandlerTy OldDiagnosticHandler;
+      void *OldDiagnosticContext;
+
+    public:
+      BackendDiagnosticsRAII(LLVMContext &Ctx, BackendConsumer *Consumer)
+          : Ctx(Ctx), OldHandler(Ctx.getInlineAsmDiagnosticHandler()),
+            OldContext(Ctx.getInlineAsmDiagnosticContext()),
+            OldDiagnosticHandler(Ctx.getDiagnosticHandler()),
+            OldDiagnosticContext(Ctx.getDiagnosticContext()) {
+        Ctx.setInlineAsmDiagnosticHandler(InlineAsmDiagHandler, Consumer);
+        Ctx.setDiagnosticHandler(DiagnosticHandler, Consumer);
+      }
+
+      ~BackendDiagnosticsRAII() {
+        Ctx.setInlineAsmDiagnosticHandler(OldHandler, OldContext);
+        Ctx.setDiagnosticHandler(OldDiagnosticHandler, OldDiagnosticContext);
+      }
+    };
+
     static void InlineAsmDiagHandler(const llvm::SMDiagnostic &SM,void *Context,
                                      unsigned LocCookie) {
       SourceLocation Loc = SourceLocation::getFromRawEncoding(LocCookie);
@@ -251,6 +319,11 @@ namespace clang {
         const llvm::DiagnosticInfoOptimizationRemarkAnalysis &D);
     void OptimizationFailureHandler(
         const llvm::DiagnosticInfoOptimizationFailure &D);
+    /// Attribute a remark or optimization failure to its loop in the
+    /// -floop-report file. If the -Rpass flag for remarks of this kind has a
+    /// \p Pattern, only the remarks of the passes it matches are kept.
+    void ReportLoopRemark(const llvm::DiagnosticInfoOptimizationBase &D,
+                          const char *Kind, const llvm::Regex *Pattern);
   };
   
   void BackendConsumer::anchor() {}
@@ -460,8 +533,24 @@ void BackendConsumer::EmitOptimizationMessage(
         << Filename << Line << Column;
 }
 
+void BackendConsumer::ReportLoopRemark(
+    const llvm::DiagnosticInfoOptimizationBase &D, const char *Kind,
+    const llvm::Regex *Pattern) {
+  if (!Loops)
+    return;
+  if (Pattern && !Pattern->match(D.getPassName()))
+    return;
+  StringRef Filename;
+  unsigned Line, Column;
+  D.getLocation(&Filename, &Line, &Column);
+  if (Line > 0)
+    Loops->addRemark(Filename, Line, D.getPassName() ? D.getPassName() : "",
+                     Kind, D.getMsg().str());
+}
+
 void BackendConsumer::OptimizationRemarkHandler(
     const llvm::DiagnosticInfoOptimizationRemark &D) {
+  ReportLoopRemark(D, "passed", CodeGenOpts.OptimizationRemarkPattern.get());
   // Optimization remarks are active only if the -Rpass flag has a regular
   // expression that matches the name of the pass name in \p D.
   if (CodeGenOpts.OptimizationRemarkPattern &&
@@ -471,6 +560,8 @@ void BackendConsumer::OptimizationRemarkHandler(
 
 void BackendConsumer::OptimizationRemarkHandler(
     const llvm::DiagnosticInfoOptimizationRemarkMissed &D) {
+  ReportLoopRemark(D, "missed",
+                   CodeGenOpts.OptimizationRemarkMissedPattern.get());
   // Missed optimization remarks are active only if the -Rpass-missed
   // flag has a regular expression that matches the name of the pass
   // name in \p D.
@@ -482,6 +573,8 @@ void BackendConsumer::OptimizationRemarkHandler(
 
 void BackendConsumer::OptimizationRemarkHandler(
     const llvm::DiagnosticInfoOptimizationRemarkAnalysis &D) {
+  ReportLoopRemark(D, "analysis",
+                   CodeGenOpts.OptimizationRemarkAnalysisPattern.get());
   // Optimization analysis remarks are active only if the -Rpass-analysis
   // flag has a regular expression that matches the name of the pass
   // name in \p D.
@@ -493,6 +586,7 @@ void BackendConsumer::OptimizationRemarkHandler(
 
 void BackendConsumer::OptimizationFailureHandler(
     const llvm::DiagnosticInfoOptimizationFailure &D) {
+  ReportLoopRemark(D, "failure", /*Pattern=*/nullptr);
   EmitOptimizationMessage(D, diag::warn_fe_backend_optimization_failure);
 }
 
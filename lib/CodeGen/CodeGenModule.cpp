@@ -38,6 +38,7 @@
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
@@ -50,14 +51,39 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ProfileData/InstrProfWriter.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace CodeGen;
 
 static const char AnnotationSection[] = "llvm.metadata";
 
+/// The name of the record that carries the maximum function count of the
+/// whole profile into a profile subset. It can't be the name of a function.
+static const char PGOSubsetMaxCountName[] = "<maximum function count>";
+
+/// Open an indexed profile without reading it. The file is mapped rather
+/// than read, so that only the pages of the index and of the records that
+/// are looked up are ever loaded, and so that the compilations sharing a
+/// profile also share its pages.
+static std::error_code createIndexedProfileReader(
+    StringRef Path, std::unique_ptr<llvm::IndexedInstrProfReader> &Result) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (std::error_code EC = Buffer.getError())
+    return EC;
+  if (!llvm::IndexedInstrProfReader::hasFormat(**Buffer))
+    return llvm::instrprof_error::bad_magic;
+  Result.reset(new llvm::IndexedInstrProfReader(std::move(*Buffer)));
+  return Result->readHeader();
+}
+
 static CGCXXABI *createCXXABI(CodeGenModule &CGM) {
   switch (CGM.getTarget().getCXXABI().getKind()) {
   case TargetCXXABI::GenericAArch64:
@@ -76,7 +102,8 @@ static CGCXXABI *createCXXABI(CodeGenModule &CGM) {
 CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
                              llvm::Module &M, const llvm::DataLayout &TD,
                              DiagnosticsEngine &diags,
-                             CoverageSourceInfo *CoverageInfo)
+                             CoverageSourceInfo *CoverageInfo,
+                             LoopReport *Loops)
     : Context(C), LangOpts(C.getLangOpts()), CodeGenOpts(CGO), TheModule(M),
       Diags(diags), TheDataLayout(TD), Target(C.getTargetInfo()),
       ABI(createCXXABI(*this)), VMContext(M.getContext()), TBAA(nullptr),
@@ -84,12 +111,14 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
       ObjCRuntime(nullptr), OpenCLRuntime(nullptr), OpenMPRuntime(nullptr),
       CUDARuntime(nullptr), DebugInfo(nullptr), ARCData(nullptr),
       NoObjCARCExceptionsMetadata(nullptr), RRData(nullptr), PGOReader(nullptr),
-      CFConstantStringClassRef(nullptr), ConstantStringClassRef(nullptr),
-      NSConstantStringType(nullptr), NSConcreteGlobalBlock(nullptr),
-      NSConcreteStackBlock(nullptr), BlockObjectAssign(nullptr),
-      BlockObjectDispose(nullptr), BlockDescriptorType(nullptr),
-      GenericBlockLiteralType(nullptr), LifetimeStartFn(nullptr),
-      LifetimeEndFn(nullptr), SanitizerMD(new SanitizerMetadata(*this)) {
+      Streamer(nullptr), CFConstantStringClassRef(nullptr),
+      ConstantStringClassRef(nullptr), NSConstantStringType(nullptr),
+      NSConcreteGlobalBlock(nullptr), NSConcreteStackBlock(nullptr),
+      BlockObjectAssign(nullptr), BlockObjectDispose(nullptr),
+      BlockDescriptorType(nullptr), GenericBlockLiteralType(nullptr),
+      LifetimeStartFn(nullptr),
+      LifetimeEndFn(nullptr), SanitizerMD(new SanitizerMetadata(*this)),
+      Loops(Loops) {
 
   // Initialize the type cache.
   llvm::LLVMContext &LLVMContext = M.getContext();
@@ -140,14 +169,21 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
   RRData = new RREntrypoints();
 
   if (!CodeGenOpts.InstrProfileInput.empty()) {
-    if (std::error_code EC = llvm::IndexedInstrProfReader::create(
+    if (std::error_code EC = createIndexedProfileReader(
             CodeGenOpts.InstrProfileInput, PGOReader)) {
       unsigned DiagID = Diags.getCustomDiagID(DiagnosticsEngine::Error,
                                               "Could not read profile: %0");
       getDiags().Report(DiagID) << EC.message();
+      PGOReader.reset();
+    } else if (!CodeGenOpts.InstrProfileSubsetOutput.empty()) {
+      PGOSubset.reset(new llvm::InstrProfWriter());
     }
   }
 
+  if (CodeGenOpts.ProfileIndirectCalls &&
+      (CodeGenOpts.ProfileInstrGenerate || PGOReader))
+    IndirectCalls.reset(new IndirectCallTargets());
+
   // If coverage mapping generation is enabled, create the
   // CoverageMappingModuleGen object.
   if (CodeGenOpts.CoverageMapping)
@@ -347,6 +383,8 @@ void CodeGenModule::Release() {
       AddGlobalCtor(ObjCInitFunction);
   if (PGOReader && PGOStats.hasDiagnostics())
     PGOStats.reportDiagnostics(getDiags(), getCodeGenOpts().MainFileName);
+  if (PGOSubset)
+    writePGOSubset();
   EmitCtorList(GlobalCtors, "llvm.global_ctors");
   EmitCtorList(GlobalDtors, "llvm.global_dtors");
   EmitGlobalAnnotations();
@@ -420,6 +458,10 @@ void CodeGenModule::Release() {
 void CodeGenModule::UpdateCompletedType(const TagDecl *TD) {
   // Make sure that this type is translated.
   Types.UpdateCompletedType(TD);
+
+  if (IndirectCalls)
+    if (const CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(TD))
+      IndirectCalls->addClass(RD);
 }
 
 llvm::MDNode *CodeGenModule::getTBAAInfo(QualType QTy) {
@@ -951,6 +993,35 @@ void CodeGenModule::emitLLVMUsed() {
   emitUsed(*this, "llvm.compiler.used", LLVMCompilerUsed);
 }
 
+void CodeGenModule::addToPGOSubset(StringRef FuncName, uint64_t FunctionHash,
+                                   ArrayRef<uint64_t> Counts) {
+  // The writer adds up the counts of a function that is added twice.
+  if (!PGOSubset || !PGOSubsetFunctions.insert(FuncName).second)
+    return;
+  PGOSubset->addFunctionCounts(FuncName, FunctionHash, Counts);
+}
+
+/// The subset is an indexed profile that gives the same results as the whole
+/// profile when this translation unit is compiled with it. Besides the
+/// functions that were found in the profile, it has to carry the maximum
+/// function count of the whole profile, which decides which functions are
+/// hot or cold.
+void CodeGenModule::writePGOSubset() {
+  uint64_t MaxCount = PGOReader->getMaximumFunctionCount();
+  PGOSubset->addFunctionCounts(PGOSubsetMaxCountName, 0, MaxCount);
+
+  StringRef Path = CodeGenOpts.InstrProfileSubsetOutput;
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    unsigned DiagID = Diags.getCustomDiagID(
+        DiagnosticsEngine::Error, "Could not write profile subset '%0': %1");
+    getDiags().Report(DiagID) << Path << EC.message();
+    return;
+  }
+  PGOSubset->write(OS);
+}
+
 void CodeGenModule::AppendLinkerOptions(StringRef Opts) {
   auto *MDOpts = llvm::MDString::get(getLLVMContext(), Opts);
   LinkerOptionsMetadata.push_back(llvm::MDNode::get(getLLVMContext(), MDOpts));
@@ -1109,6 +1180,11 @@ void CodeGenModule::EmitDeferred() {
       continue;
 
     // Otherwise, emit the definition and move on to the next one.
+    TimeTraceScope TimeScope("EmitDeferred", [&]() -> std::string {
+      if (const auto *ND = dyn_cast<NamedDecl>(D.getDecl()))
+        return ND->getQualifiedNameAsString();
+      return "";
+    });
     EmitGlobalDefinition(D, GV);
   }
 }
@@ -3134,6 +3210,10 @@ void CodeGenModule::EmitTopLevelDecl(Decl *D) {
         cast<FunctionDecl>(D)->isLateTemplateParsed())
       return;
 
+    if (IndirectCalls) {
+      IndirectCalls->addFunction(getContext(), cast<FunctionDecl>(D));
+      IndirectCalls->addAddressesTaken(D);
+    }
     EmitGlobal(cast<FunctionDecl>(D));
     // Always provide some coverage mapping
     // even for the functions that aren't emitted.
@@ -3145,6 +3225,8 @@ void CodeGenModule::EmitTopLevelDecl(Decl *D) {
     if (cast<VarDecl>(D)->getDescribedVarTemplate())
       return;
   case Decl::VarTemplateSpecialization:
+    if (IndirectCalls)
+      IndirectCalls->addAddressesTaken(D);
     EmitGlobal(cast<VarDecl>(D));
     break;
 
@@ -30,6 +30,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ValueHandle.h"
@@ -44,10 +45,12 @@ class DataLayout;
 class FunctionType;
 class LLVMContext;
 class IndexedInstrProfReader;
+class InstrProfWriter;
 }
 
 namespace clang {
 class TargetCodeGenInfo;
+class StreamingBackend;
 class ASTContext;
 class AtomicType;
 class FunctionDecl;
@@ -89,6 +92,8 @@ class CGCUDARuntime;
 class BlockFieldFlags;
 class FunctionArgList;
 class CoverageMappingModuleGen;
+class IndirectCallTargets;
+class LoopReport;
 
 struct OrderGlobalInits {
   unsigned int priority;
@@ -307,6 +312,19 @@ class CodeGenModule : public CodeGenTypeCache {
   std::unique_ptr<llvm::IndexedInstrProfReader> PGOReader;
   InstrProfStats PGOStats;
 
+  /// The profile data used by this translation unit, for
+  /// -fprofile-instr-subset, and the functions it has data for.
+  std::unique_ptr<llvm::InstrProfWriter> PGOSubset;
+  llvm::StringSet<> PGOSubsetFunctions;
+
+  /// The functions that indirect calls are profiled against, for
+  /// -fprofile-instr-indirect-calls.
+  std::unique_ptr<IndirectCallTargets> IndirectCalls;
+
+  /// The backend that generates code for functions as soon as their bodies
+  /// are complete, if any.
+  StreamingBackend *Streamer;
+
   // A set of references that have only been seen via a weakref so far. This is
   // used to remove the weak of the reference if we ever see a direct reference
   // or a definition.
@@ -484,11 +502,15 @@ class CodeGenModule : public CodeGenTypeCache {
   llvm::DenseMap<const Decl *, bool> DeferredEmptyCoverageMappingDecls;
 
   std::unique_ptr<CoverageMappingModuleGen> CoverageMapping;
+
+  /// \brief The loops described by -floop-report, owned by the caller.
+  LoopReport *Loops;
 public:
   CodeGenModule(ASTContext &C, const CodeGenOptions &CodeGenOpts,
                 llvm::Module &M, const llvm::DataLayout &TD,
                 DiagnosticsEngine &Diags,
-                CoverageSourceInfo *CoverageInfo = nullptr);
+                CoverageSourceInfo *CoverageInfo = nullptr,
+                LoopReport *Loops = nullptr);
 
   ~CodeGenModule();
 
@@ -537,10 +559,24 @@ public:
   InstrProfStats &getPGOStats() { return PGOStats; }
   llvm::IndexedInstrProfReader *getPGOReader() const { return PGOReader.get(); }
 
+  /// Add the counts of a function to the profile subset, if one is being
+  /// written.
+  void addToPGOSubset(StringRef FuncName, uint64_t FunctionHash,
+                      ArrayRef<uint64_t> Counts);
+
+  IndirectCallTargets *getIndirectCallTargets() const {
+    return IndirectCalls.get();
+  }
+
+  StreamingBackend *getStreamingBackend() const { return Streamer; }
+  void setStreamingBackend(StreamingBackend *S) { Streamer = S; }
+
   CoverageMappingModuleGen *getCoverageMapping() const {
     return CoverageMapping.get();
   }
 
+  LoopReport *getLoopReport() const { return Loops; }
+
   llvm::Constant *getStaticLocalDeclAddress(const VarDecl *D) {
     return StaticLocalDeclMap[D];
   }
@@ -1173,6 +1209,9 @@ private:
   /// Emit the llvm.used and llvm.compiler.used metadata.
   void emitLLVMUsed();
 
+  /// Write the profile data used by this translation unit.
+  void writePGOSubset();
+
   /// \brief Emit the link options introduced by imported modules.
   void EmitModuleLinkOptions();
 
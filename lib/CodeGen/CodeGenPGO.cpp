@@ -26,8 +26,10 @@
 using namespace clang;
 using namespace CodeGen;
 
-void CodeGenPGO::setFuncName(StringRef Name,
-                             llvm::GlobalValue::LinkageTypes Linkage) {
+/// \brief Get the name a function with the given symbol name and linkage
+/// has in the profile.
+static std::string getPGOFuncName(CodeGenModule &CGM, StringRef Name,
+                                  llvm::GlobalValue::LinkageTypes Linkage) {
   StringRef RawFuncName = Name;
 
   // Function names may be prefixed with a binary '1' to indicate
@@ -36,7 +38,7 @@ void CodeGenPGO::setFuncName(StringRef Name,
   if (RawFuncName[0] == '\1')
     RawFuncName = RawFuncName.substr(1);
 
-  FuncName = RawFuncName;
+  std::string FuncName = RawFuncName;
   if (llvm::GlobalValue::isLocalLinkage(Linkage)) {
     // For local symbols, prepend the main file name to distinguish them.
     // Do not include the full path in the file name since there's no guarantee
@@ -47,17 +49,26 @@ void CodeGenPGO::setFuncName(StringRef Name,
     else
       FuncName = FuncName.insert(0, CGM.getCodeGenOpts().MainFileName + ":");
   }
-
-  // If we're generating a profile, create a variable for the name.
-  if (CGM.getCodeGenOpts().ProfileInstrGenerate)
-    createFuncNameVar(Linkage);
+  return FuncName;
 }
 
-void CodeGenPGO::setFuncName(llvm::Function *Fn) {
-  setFuncName(Fn->getName(), Fn->getLinkage());
+/// \brief Get the hash of the profile name of a function, by which indirect
+/// call sites refer to it.
+static uint64_t getPGOFuncNameHash(CodeGenModule &CGM, GlobalDecl GD) {
+  llvm::MD5 MD5;
+  MD5.update(getPGOFuncName(CGM, CGM.getMangledName(GD),
+                            CGM.getFunctionLinkage(GD)));
+  llvm::MD5::MD5Result Result;
+  MD5.final(Result);
+  using namespace llvm::support;
+  return endian::read<uint64_t, little, unaligned>(Result);
 }
 
-void CodeGenPGO::createFuncNameVar(llvm::GlobalValue::LinkageTypes Linkage) {
+/// \brief Create the variable that holds the profile name \p Name of a
+/// function with the given linkage.
+static llvm::GlobalVariable *
+createPGONameVar(CodeGenModule &CGM, StringRef Name,
+                 llvm::GlobalValue::LinkageTypes Linkage) {
   // Usually, we want to match the function's linkage, but
   // available_externally and extern_weak both have the wrong semantics.
   if (Linkage == llvm::GlobalValue::ExternalWeakLinkage)
@@ -66,14 +77,174 @@ void CodeGenPGO::createFuncNameVar(llvm::GlobalValue::LinkageTypes Linkage) {
     Linkage = llvm::GlobalValue::LinkOnceODRLinkage;
 
   auto *Value =
-      llvm::ConstantDataArray::getString(CGM.getLLVMContext(), FuncName, false);
-  FuncNameVar =
+      llvm::ConstantDataArray::getString(CGM.getLLVMContext(), Name, false);
+  auto *NameVar =
       new llvm::GlobalVariable(CGM.getModule(), Value->getType(), true, Linkage,
-                               Value, "__llvm_profile_name_" + FuncName);
+                               Value, "__llvm_profile_name_" + Name);
 
   // Hide the symbol so that we correctly get a copy for each executable.
-  if (!llvm::GlobalValue::isLocalLinkage(FuncNameVar->getLinkage()))
-    FuncNameVar->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  if (!llvm::GlobalValue::isLocalLinkage(NameVar->getLinkage()))
+    NameVar->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  return NameVar;
+}
+
+void CodeGenPGO::setFuncName(StringRef Name,
+                             llvm::GlobalValue::LinkageTypes Linkage) {
+  FuncName = getPGOFuncName(CGM, Name, Linkage);
+
+  // If we're generating a profile, create a variable for the name.
+  if (CGM.getCodeGenOpts().ProfileInstrGenerate)
+    createFuncNameVar(Linkage);
+}
+
+void CodeGenPGO::setFuncName(llvm::Function *Fn) {
+  setFuncName(Fn->getName(), Fn->getLinkage());
+}
+
+void CodeGenPGO::createFuncNameVar(llvm::GlobalValue::LinkageTypes Linkage) {
+  FuncNameVar = createPGONameVar(CGM, FuncName, Linkage);
+}
+
+void
+CodeGenPGO::createValueSiteNameVar(llvm::GlobalValue::LinkageTypes Linkage) {
+  ValueSiteNameVar = createPGONameVar(CGM, ValueSiteFuncName, Linkage);
+}
+
+void IndirectCallTargets::addOverrider(const CXXMethodDecl *Base,
+                                       const CXXMethodDecl *MD) {
+  Base = Base->getCanonicalDecl();
+  SmallVectorImpl<const CXXMethodDecl *> &List = Overriders[Base];
+  if (std::find(List.begin(), List.end(), MD) != List.end())
+    return;
+  List.push_back(MD);
+  for (CXXMethodDecl::method_iterator I = Base->begin_overridden_methods(),
+                                      E = Base->end_overridden_methods();
+       I != E; ++I)
+    addOverrider(*I, MD);
+}
+
+void IndirectCallTargets::addClass(const CXXRecordDecl *RD) {
+  if (RD->isDependentContext())
+    return;
+  for (const CXXMethodDecl *MD : RD->methods()) {
+    // Destructors are called through the vtable, but the slot holds a
+    // different function for each kind of destructor.
+    if (!MD->isVirtual() || isa<CXXDestructorDecl>(MD))
+      continue;
+    MD = MD->getCanonicalDecl();
+    for (CXXMethodDecl::method_iterator I = MD->begin_overridden_methods(),
+                                        E = MD->end_overridden_methods();
+         I != E; ++I)
+      addOverrider(*I, MD);
+  }
+}
+
+void IndirectCallTargets::addFunction(ASTContext &Ctx, const FunctionDecl *FD) {
+  if (isa<CXXMethodDecl>(FD))
+    return;
+  FD = FD->getCanonicalDecl();
+  if (!IndexedFunctions.insert(FD).second)
+    return;
+  const Type *T = Ctx.getCanonicalType(FD->getType()).getTypePtr();
+  FunctionsByType[T].push_back(FD);
+}
+
+namespace {
+/// A RecursiveASTVisitor that finds the functions whose address a
+/// declaration takes.
+struct FindAddressesTaken : public RecursiveASTVisitor<FindAddressesTaken> {
+  llvm::SmallPtrSetImpl<const FunctionDecl *> &AddressTaken;
+  /// The callees of the direct calls seen so far.
+  llvm::SmallPtrSet<const Expr *, 8> DirectCallees;
+
+  FindAddressesTaken(llvm::SmallPtrSetImpl<const FunctionDecl *> &AddressTaken)
+      : AddressTaken(AddressTaken) {}
+
+  // Unevaluated operands don't take the address of what they name.
+  bool TraverseUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *E) {
+    return true;
+  }
+  bool TraverseCXXNoexceptExpr(CXXNoexceptExpr *E) { return true; }
+  bool TraverseCXXTypeidExpr(CXXTypeidExpr *E) { return true; }
+  bool TraverseDecltypeTypeLoc(DecltypeTypeLoc TL) { return true; }
+
+  bool VisitCallExpr(CallExpr *E) {
+    if (E->getDirectCallee())
+      DirectCallees.insert(E->getCallee()->IgnoreParenImpCasts());
+    return true;
+  }
+
+  bool VisitDeclRefExpr(DeclRefExpr *E) {
+    if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(E->getDecl()))
+      if (!DirectCallees.count(E))
+        AddressTaken.insert(FD->getCanonicalDecl());
+    return true;
+  }
+};
+}
+
+void IndirectCallTargets::addAddressesTaken(const Decl *D) {
+  FindAddressesTaken(AddressTaken).TraverseDecl(const_cast<Decl *>(D));
+}
+
+/// \brief Check whether \p FD can be the target of a call.
+static bool isCallableTarget(const FunctionDecl *FD) {
+  FD = FD->getMostRecentDecl();
+  return !FD->isPure() && !FD->isDeleted();
+}
+
+void
+IndirectCallTargets::getTargets(ASTContext &Ctx, const CallExpr *E,
+                                SmallVectorImpl<GlobalDecl> &Targets) const {
+  // Find the virtual function called, if this is a virtual call.
+  const CXXMethodDecl *MD = nullptr;
+  if (const CXXMemberCallExpr *CE = dyn_cast<CXXMemberCallExpr>(E)) {
+    const MemberExpr *ME =
+        dyn_cast<MemberExpr>(CE->getCallee()->IgnoreParens());
+    if (!ME || ME->hasQualifier())
+      return;
+    MD = dyn_cast<CXXMethodDecl>(ME->getMemberDecl());
+    if (!MD || !MD->isVirtual() || isa<CXXDestructorDecl>(MD))
+      return;
+  } else if (isa<CXXOperatorCallExpr>(E)) {
+    MD = dyn_cast_or_null<CXXMethodDecl>(E->getCalleeDecl());
+    if (MD && !MD->isVirtual())
+      return;
+  }
+
+  if (MD) {
+    MD = MD->getCanonicalDecl();
+    if (isCallableTarget(MD))
+      Targets.push_back(GlobalDecl(MD));
+    auto I = Overriders.find(MD);
+    if (I == Overriders.end())
+      return;
+    for (const CXXMethodDecl *O : I->second) {
+      if (Targets.size() == MaxTargets)
+        break;
+      if (isCallableTarget(O))
+        Targets.push_back(GlobalDecl(O));
+    }
+    return;
+  }
+
+  // Otherwise, look for a call through a function pointer.
+  if (isa<CUDAKernelCallExpr>(E) || E->getDirectCallee())
+    return;
+  const PointerType *PT = E->getCallee()->getType()->getAs<PointerType>();
+  if (!PT)
+    return;
+  const Type *T = Ctx.getCanonicalType(PT->getPointeeType()).getTypePtr();
+  auto I = FunctionsByType.find(T);
+  if (I == FunctionsByType.end())
+    return;
+  // Only functions whose address has been taken are candidates.
+  for (const FunctionDecl *FD : I->second) {
+    if (Targets.size() == MaxTargets)
+      break;
+    if (AddressTaken.count(FD) && isCallableTarget(FD))
+      Targets.push_back(GlobalDecl(FD));
+  }
 }
 
 namespace {
@@ -146,9 +317,18 @@ const unsigned PGOHash::TooBig;
     PGOHash Hash;
     /// The map of statements to counters.
     llvm::DenseMap<const Stmt *, unsigned> &CounterMap;
-
-    MapRegionCounters(llvm::DenseMap<const Stmt *, unsigned> &CounterMap)
-        : NextCounter(0), CounterMap(CounterMap) {}
+    /// The functions indirect calls are profiled against, if they are.
+    const IndirectCallTargets *CallTargets;
+    ASTContext &Context;
+    /// The indirect call sites and their targets, in the order they were
+    /// found. Their counters follow the region counters.
+    SmallVector<std::pair<const Expr *, SmallVector<GlobalDecl, 4>>, 8> Sites;
+
+    MapRegionCounters(llvm::DenseMap<const Stmt *, unsigned> &CounterMap,
+                      const IndirectCallTargets *CallTargets,
+                      ASTContext &Context)
+        : NextCounter(0), CounterMap(CounterMap), CallTargets(CallTargets),
+          Context(Context) {}
 
     // Blocks and lambdas are handled as separate functions, so we need not
     // traverse them in the parent context.
@@ -175,6 +355,10 @@ const unsigned PGOHash::TooBig;
     }
 
     bool VisitStmt(const Stmt *S) {
+      if (CallTargets)
+        if (const CallExpr *E = dyn_cast<CallExpr>(S))
+          mapValueSite(E);
+
       auto Type = getHashType(S);
       if (Type == PGOHash::None)
         return true;
@@ -183,6 +367,13 @@ const unsigned PGOHash::TooBig;
       Hash.combine(Type);
       return true;
     }
+
+    void mapValueSite(const CallExpr *E) {
+      SmallVector<GlobalDecl, 4> Targets;
+      CallTargets->getTargets(Context, E, Targets);
+      if (!Targets.empty())
+        Sites.push_back(std::make_pair(E, Targets));
+    }
     PGOHash::HashType getHashType(const Stmt *S) {
       switch (S->getStmtClass()) {
       default:
@@ -678,11 +869,14 @@ void CodeGenPGO::assignRegionCounters(const Decl *D, llvm::Function *Fn) {
   setFuncName(Fn);
 
   mapRegionCounters(D);
+  if (ValueSiteMap && InstrumentRegions)
+    createValueSiteNameVar(Fn->getLinkage());
   if (CGM.getCodeGenOpts().CoverageMapping)
     emitCounterRegionMapping(D);
   if (PGOReader) {
     SourceManager &SM = CGM.getContext().getSourceManager();
     loadRegionCounts(PGOReader, SM.isInMainFile(D->getLocation()));
+    loadValueSiteCounts(PGOReader);
     computeRegionCounts(D);
     applyFunctionAttributes(PGOReader, Fn);
   }
@@ -690,7 +884,8 @@ void CodeGenPGO::assignRegionCounters(const Decl *D, llvm::Function *Fn) {
 
 void CodeGenPGO::mapRegionCounters(const Decl *D) {
   RegionCounterMap.reset(new llvm::DenseMap<const Stmt *, unsigned>);
-  MapRegionCounters Walker(*RegionCounterMap);
+  MapRegionCounters Walker(*RegionCounterMap, CGM.getIndirectCallTargets(),
+                           CGM.getContext());
   if (const FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(D))
     Walker.TraverseDecl(const_cast<FunctionDecl *>(FD));
   else if (const ObjCMethodDecl *MD = dyn_cast_or_null<ObjCMethodDecl>(D))
@@ -702,14 +897,60 @@ void CodeGenPGO::mapRegionCounters(const Decl *D) {
   assert(Walker.NextCounter > 0 && "no entry counter mapped for decl");
   NumRegionCounters = Walker.NextCounter;
   FunctionHash = Walker.Hash.finalize();
+
+  ValueSiteMap.reset();
+  NumValueSiteCounters = 0;
+  if (Walker.Sites.empty())
+    return;
+
+  // Give each indirect call site a counter for its executions and one for
+  // each of its targets, in a record of their own. The targets are hashed
+  // into the hash of that record, so that counts are not applied to a site
+  // that was profiled against different targets.
+  ValueSiteMap.reset(new llvm::DenseMap<const Expr *, ValueSite>);
+  ValueSiteFuncName = FuncName + ".vp";
+  llvm::MD5 MD5;
+  auto HashWord = [&MD5](uint64_t Word) {
+    using namespace llvm::support;
+    uint64_t Swapped = endian::byte_swap<uint64_t, little>(Word);
+    MD5.update(llvm::makeArrayRef((uint8_t *)&Swapped, sizeof(Swapped)));
+  };
+  HashWord(Walker.Sites.size());
+  for (const auto &Site : Walker.Sites) {
+    ValueSite &VS = (*ValueSiteMap)[Site.first];
+    VS.FirstCounter = NumValueSiteCounters;
+    NumValueSiteCounters += 1 + Site.second.size();
+    HashWord(Site.second.size());
+    for (GlobalDecl GD : Site.second) {
+      VS.Targets.push_back(GD);
+      VS.TargetHashes.push_back(getPGOFuncNameHash(CGM, GD));
+      HashWord(VS.TargetHashes.back());
+    }
+  }
+  llvm::MD5::MD5Result Result;
+  MD5.final(Result);
+  using namespace llvm::support;
+  ValueSiteHash = endian::read<uint64_t, little, unaligned>(Result);
+}
+
+/// \brief Check whether coverage mapping is emitted for the function \p D.
+static bool isCoverageMapped(CodeGenModule &CGM, const Decl *D) {
+  SourceManager &SM = CGM.getContext().getSourceManager();
+  auto Loc = D->getBody()->getLocStart();
+  // Don't map the functions inside the system headers, or, with
+  // -fcoverage-mapping-main-file-only, outside the main file.
+  if (SM.isInSystemHeader(Loc))
+    return false;
+  if (CGM.getCodeGenOpts().CoverageMappingMainFileOnly &&
+      !SM.isInMainFile(SM.getExpansionLoc(Loc)))
+    return false;
+  return true;
 }
 
 void CodeGenPGO::emitCounterRegionMapping(const Decl *D) {
   if (SkipCoverageMapping)
     return;
-  // Don't map the functions inside the system headers
-  auto Loc = D->getBody()->getLocStart();
-  if (CGM.getContext().getSourceManager().isInSystemHeader(Loc))
+  if (!isCoverageMapped(CGM, D))
     return;
 
   std::string CoverageMapping;
@@ -734,9 +975,7 @@ CodeGenPGO::emitEmptyCounterMapping(const Decl *D, StringRef FuncName,
     return;
   setFuncName(FuncName, Linkage);
 
-  // Don't map the functions inside the system headers
-  auto Loc = D->getBody()->getLocStart();
-  if (CGM.getContext().getSourceManager().isInSystemHeader(Loc))
+  if (!isCoverageMapped(CGM, D))
     return;
 
   std::string CoverageMapping;
@@ -796,6 +1035,96 @@ void CodeGenPGO::emitCounterIncrement(CGBuilderTy &Builder, unsigned Counter) {
                       Builder.getInt32(Counter));
 }
 
+void CodeGenPGO::emitValueSiteCounters(CodeGenFunction &CGF, const Expr *E,
+                                       llvm::Value *Callee) {
+  if (!CGM.getCodeGenOpts().ProfileInstrGenerate || !ValueSiteMap)
+    return;
+  auto I = ValueSiteMap->find(E);
+  if (I == ValueSiteMap->end())
+    return;
+  const ValueSite &VS = I->second;
+
+  CGBuilderTy &Builder = CGF.Builder;
+  auto *I8PtrTy = llvm::Type::getInt8PtrTy(CGM.getLLVMContext());
+  auto EmitIncrement = [&](unsigned Counter) {
+    Builder.CreateCall4(
+        CGM.getIntrinsic(llvm::Intrinsic::instrprof_increment),
+        llvm::ConstantExpr::getBitCast(ValueSiteNameVar, I8PtrTy),
+        Builder.getInt64(ValueSiteHash), Builder.getInt32(NumValueSiteCounters),
+        Builder.getInt32(Counter));
+  };
+
+  // Count the executions of the site, then compare the callee against each
+  // target in turn and count the one that matches, if any. Only targets
+  // that the module already refers to are compared against: referring to
+  // another one would emit a deferred definition, or leave an undefined
+  // reference to a function that no one defines. Their calls are counted
+  // only in the total.
+  EmitIncrement(VS.FirstCounter);
+  llvm::Value *CalleePtr = Builder.CreateBitCast(Callee, I8PtrTy);
+  llvm::BasicBlock *Done = CGF.createBasicBlock("pgo.vp.end");
+  for (unsigned Target = 0, N = VS.Targets.size(); Target != N; ++Target) {
+    llvm::GlobalValue *Addr =
+        CGM.GetGlobalValue(CGM.getMangledName(VS.Targets[Target]));
+    if (!Addr)
+      continue;
+    llvm::BasicBlock *Count = CGF.createBasicBlock("pgo.vp.count");
+    llvm::BasicBlock *Next = CGF.createBasicBlock("pgo.vp.next");
+    Builder.CreateCondBr(
+        Builder.CreateICmpEQ(CalleePtr,
+                             llvm::ConstantExpr::getBitCast(Addr, I8PtrTy)),
+        Count, Next);
+    CGF.EmitBlock(Count);
+    EmitIncrement(VS.FirstCounter + 1 + Target);
+    Builder.CreateBr(Done);
+    CGF.EmitBlock(Next);
+  }
+  CGF.EmitBlock(Done);
+}
+
+void CodeGenPGO::applyValueSiteProfile(const Expr *E, llvm::Instruction *Call) {
+  if (ValueSiteCounts.empty() || !ValueSiteMap || !Call)
+    return;
+  auto I = ValueSiteMap->find(E);
+  if (I == ValueSiteMap->end())
+    return;
+  const ValueSite &VS = I->second;
+  uint64_t Total = ValueSiteCounts[VS.FirstCounter];
+  if (!Total)
+    return;
+
+  // Record the targets that were called, most frequent first, in the form
+  // of value profile metadata:
+  //   !{!"VP", i32 0, i64 <total>, i64 <target hash>, i64 <count>, ...}
+  SmallVector<std::pair<uint64_t, uint64_t>, 4> Counts;
+  for (unsigned Target = 0, N = VS.Targets.size(); Target != N; ++Target)
+    if (uint64_t Count = ValueSiteCounts[VS.FirstCounter + 1 + Target])
+      Counts.push_back(std::make_pair(Count, VS.TargetHashes[Target]));
+  if (Counts.empty())
+    return;
+  std::stable_sort(Counts.begin(), Counts.end(),
+                   [](const std::pair<uint64_t, uint64_t> &LHS,
+                      const std::pair<uint64_t, uint64_t> &RHS) {
+    return LHS.first > RHS.first;
+  });
+
+  llvm::LLVMContext &Ctx = CGM.getLLVMContext();
+  llvm::Type *Int64Ty = llvm::Type::getInt64Ty(Ctx);
+  SmallVector<llvm::Metadata *, 8> Ops;
+  Ops.push_back(llvm::MDString::get(Ctx, "VP"));
+  Ops.push_back(llvm::ConstantAsMetadata::get(
+      llvm::ConstantInt::get(llvm::Type::getInt32Ty(Ctx), 0)));
+  Ops.push_back(
+      llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(Int64Ty, Total)));
+  for (const auto &Count : Counts) {
+    Ops.push_back(llvm::ConstantAsMetadata::get(
+        llvm::ConstantInt::get(Int64Ty, Count.second)));
+    Ops.push_back(llvm::ConstantAsMetadata::get(
+        llvm::ConstantInt::get(Int64Ty, Count.first)));
+  }
+  Call->setMetadata(llvm::LLVMContext::MD_prof, llvm::MDNode::get(Ctx, Ops));
+}
+
 void CodeGenPGO::loadRegionCounts(llvm::IndexedInstrProfReader *PGOReader,
                                   bool IsInMainFile) {
   CGM.getPGOStats().addVisited(IsInMainFile);
@@ -810,7 +1139,24 @@ void CodeGenPGO::loadRegionCounts(llvm::IndexedInstrProfReader *PGOReader,
       // TODO: Consider a more specific warning for this case.
       CGM.getPGOStats().addMismatched(IsInMainFile);
     RegionCounts.clear();
+    return;
+  }
+  CGM.addToPGOSubset(FuncName, FunctionHash, RegionCounts);
+}
+
+void CodeGenPGO::loadValueSiteCounts(llvm::IndexedInstrProfReader *PGOReader) {
+  ValueSiteCounts.clear();
+  if (!ValueSiteMap)
+    return;
+  // A missing or mismatched record only loses the value profile; the region
+  // counts of the function still apply.
+  if (PGOReader->getFunctionCounts(ValueSiteFuncName, ValueSiteHash,
+                                   ValueSiteCounts) ||
+      ValueSiteCounts.size() != NumValueSiteCounters) {
+    ValueSiteCounts.clear();
+    return;
   }
+  CGM.addToPGOSubset(ValueSiteFuncName, ValueSiteHash, ValueSiteCounts);
 }
 
 /// \brief Calculate what to divide by to scale weights.
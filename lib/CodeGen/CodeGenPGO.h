@@ -26,6 +26,47 @@ namespace clang {
 namespace CodeGen {
 class RegionCounter;
 
+/// The functions that indirect calls are profiled against, with
+/// -fprofile-instr-indirect-calls.
+///
+/// An indirect call site gets a counter for each of the functions that it
+/// might call and that the AST makes known before the calling function is
+/// emitted: the overriders of the called virtual function in the classes
+/// defined so far, or the functions of the called type whose address the
+/// declarations handed to CodeGen so far take. Nothing here depends on what
+/// CodeGen has emitted, so the instrumented and the optimized compilations
+/// see the same functions in the same order.
+class IndirectCallTargets {
+  /// The virtual functions that override each virtual function, directly or
+  /// indirectly.
+  llvm::DenseMap<const CXXMethodDecl *, SmallVector<const CXXMethodDecl *, 4>>
+      Overriders;
+  /// The functions declared at namespace scope, by canonical type.
+  llvm::DenseMap<const Type *, SmallVector<const FunctionDecl *, 4>>
+      FunctionsByType;
+  /// The functions in FunctionsByType.
+  llvm::SmallPtrSet<const FunctionDecl *, 32> IndexedFunctions;
+  /// The functions whose address is taken as a value, rather than only
+  /// named as the callee of a direct call or in an unevaluated operand.
+  llvm::SmallPtrSet<const FunctionDecl *, 32> AddressTaken;
+
+  void addOverrider(const CXXMethodDecl *Base, const CXXMethodDecl *MD);
+
+public:
+  /// The most functions a site is profiled against.
+  static const unsigned MaxTargets = 16;
+
+  void addClass(const CXXRecordDecl *RD);
+  void addFunction(ASTContext &Ctx, const FunctionDecl *FD);
+  /// Record the functions whose address the body or the initializer of
+  /// \p D takes.
+  void addAddressesTaken(const Decl *D);
+
+  /// Get the functions that \p E might call, if it is an indirect call.
+  void getTargets(ASTContext &Ctx, const CallExpr *E,
+                  SmallVectorImpl<GlobalDecl> &Targets) const;
+};
+
 /// Per-function PGO state. This class should generally not be used directly,
 /// but instead through the CodeGenFunction and RegionCounter types.
 class CodeGenPGO {
@@ -40,6 +81,28 @@ private:
   std::unique_ptr<llvm::DenseMap<const Stmt *, uint64_t>> StmtCountMap;
   std::vector<uint64_t> RegionCounts;
   uint64_t CurrentRegionCount;
+
+public:
+  /// An indirect call site: the counter of its executions, followed by a
+  /// counter for each of the functions it is profiled against.
+  struct ValueSite {
+    unsigned FirstCounter;
+    SmallVector<GlobalDecl, 4> Targets;
+    /// The hashes of the profile names of the targets.
+    SmallVector<uint64_t, 4> TargetHashes;
+  };
+
+private:
+  /// The counters of the indirect call sites live in a profile record of
+  /// their own, named after the function with a ".vp" suffix, so that the
+  /// region counters and the function hash don't depend on the targets.
+  std::unique_ptr<llvm::DenseMap<const Expr *, ValueSite>> ValueSiteMap;
+  std::string ValueSiteFuncName;
+  llvm::GlobalVariable *ValueSiteNameVar;
+  unsigned NumValueSiteCounters;
+  uint64_t ValueSiteHash;
+  std::vector<uint64_t> ValueSiteCounts;
+
   /// \brief A flag that is set to true when this function doesn't need
   /// to have coverage mapping data.
   bool SkipCoverageMapping;
@@ -47,6 +110,7 @@ private:
 public:
   CodeGenPGO(CodeGenModule &CGM)
       : CGM(CGM), NumRegionCounters(0), FunctionHash(0), CurrentRegionCount(0),
+        ValueSiteNameVar(nullptr), NumValueSiteCounters(0), ValueSiteHash(0),
         SkipCoverageMapping(false) {}
 
   /// Whether or not we have PGO region data for the current function. This is
@@ -88,6 +152,15 @@ public:
       setCurrentRegionCount(Count);
   }
 
+  /// Emit the counters of the indirect call \p E to \p Callee, if it is a
+  /// value profiling site.
+  void emitValueSiteCounters(CodeGenFunction &CGF, const Expr *E,
+                             llvm::Value *Callee);
+
+  /// Annotate the instruction for the indirect call \p E with the profiled
+  /// counts of its targets.
+  void applyValueSiteProfile(const Expr *E, llvm::Instruction *Call);
+
   /// Calculate branch weights appropriate for PGO data
   llvm::MDNode *createBranchWeights(uint64_t TrueCount, uint64_t FalseCount);
   llvm::MDNode *createBranchWeights(ArrayRef<uint64_t> Weights);
@@ -109,11 +182,13 @@ private:
   void setFuncName(StringRef Name, llvm::GlobalValue::LinkageTypes Linkage);
   void createFuncNameVar(llvm::GlobalValue::LinkageTypes Linkage);
   void mapRegionCounters(const Decl *D);
+  void createValueSiteNameVar(llvm::GlobalValue::LinkageTypes Linkage);
   void computeRegionCounts(const Decl *D);
   void applyFunctionAttributes(llvm::IndexedInstrProfReader *PGOReader,
                                llvm::Function *Fn);
   void loadRegionCounts(llvm::IndexedInstrProfReader *PGOReader,
                         bool IsInMainFile);
+  void loadValueSiteCounts(llvm::IndexedInstrProfReader *PGOReader);
   void emitCounterVariables();
   void emitCounterRegionMapping(const Decl *D);
 
@@ -15,11 +15,13 @@
 #include "CodeGenFunction.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Lex/Lexer.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
 #include "llvm/ProfileData/CoverageMappingReader.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LEB128.h"
 
 using namespace clang;
 using namespace CodeGen;
@@ -1076,24 +1078,15 @@ static void dump(llvm::raw_ostream &OS, const CoverageMappingRecord &Function) {
 void CoverageMappingModuleGen::addFunctionMappingRecord(
     llvm::GlobalVariable *FunctionName, StringRef FunctionNameValue,
     uint64_t FunctionHash, const std::string &CoverageMapping) {
-  llvm::LLVMContext &Ctx = CGM.getLLVMContext();
-  auto *Int32Ty = llvm::Type::getInt32Ty(Ctx);
-  auto *Int64Ty = llvm::Type::getInt64Ty(Ctx);
-  auto *Int8PtrTy = llvm::Type::getInt8PtrTy(Ctx);
-  if (!FunctionRecordTy) {
-    llvm::Type *FunctionRecordTypes[] = {Int8PtrTy, Int32Ty, Int32Ty, Int64Ty};
-    FunctionRecordTy =
-        llvm::StructType::get(Ctx, makeArrayRef(FunctionRecordTypes));
-  }
-
-  llvm::Constant *FunctionRecordVals[] = {
-      llvm::ConstantExpr::getBitCast(FunctionName, Int8PtrTy),
-      llvm::ConstantInt::get(Int32Ty, FunctionNameValue.size()),
-      llvm::ConstantInt::get(Int32Ty, CoverageMapping.size()),
-      llvm::ConstantInt::get(Int64Ty, FunctionHash)};
-  FunctionRecords.push_back(llvm::ConstantStruct::get(
-      FunctionRecordTy, makeArrayRef(FunctionRecordVals)));
-  CoverageMappings += CoverageMapping;
+  FunctionMapping Mapping = {FunctionName, FunctionNameValue, FunctionHash,
+                             CoverageMapping};
+  // The profile name of a function has the function's linkage.
+  llvm::GlobalValue::LinkageTypes Linkage = FunctionName->getLinkage();
+  if (llvm::GlobalValue::isLinkOnceODRLinkage(Linkage) ||
+      llvm::GlobalValue::isWeakODRLinkage(Linkage))
+    SharedFunctionMappings.push_back(std::move(Mapping));
+  else
+    FunctionMappings.push_back(std::move(Mapping));
 
   if (CGM.getCodeGenOpts().DumpCoverageMapping) {
     // Dump the coverage mapping data for this function by decoding the
@@ -1118,26 +1111,60 @@ void CoverageMappingModuleGen::addFunctionMappingRecord(
   }
 }
 
-void CoverageMappingModuleGen::emit() {
-  if (FunctionRecords.empty())
-    return;
+uint64_t CoverageMappingModuleGen::emitMappings(
+    ArrayRef<FunctionMapping> Mappings, ArrayRef<std::string> Filenames,
+    llvm::GlobalValue::LinkageTypes Linkage, const Twine &Name,
+    unsigned &NumBlockFiles) {
+  NumBlockFiles = 0;
+  if (Mappings.empty())
+    return 0;
   llvm::LLVMContext &Ctx = CGM.getLLVMContext();
   auto *Int32Ty = llvm::Type::getInt32Ty(Ctx);
+  auto *Int64Ty = llvm::Type::getInt64Ty(Ctx);
+  auto *Int8PtrTy = llvm::Type::getInt8PtrTy(Ctx);
 
-  // Create the filenames and merge them with coverage mappings
-  llvm::SmallVector<std::string, 16> FilenameStrs;
+  // Create the function records, and renumber the files that the mappings
+  // refer to so that the block's filename table has only those files. An
+  // encoded mapping starts with the number of files it refers to, followed
+  // by their IDs.
+  llvm::SmallDenseMap<unsigned, unsigned, 8> BlockFileIDs;
   llvm::SmallVector<StringRef, 16> FilenameRefs;
-  FilenameStrs.resize(FileEntries.size());
-  FilenameRefs.resize(FileEntries.size());
-  for (const auto &Entry : FileEntries) {
-    llvm::SmallString<256> Path(Entry.first->getName());
-    llvm::sys::fs::make_absolute(Path);
+  std::vector<llvm::Constant *> FunctionRecords;
+  std::string CoverageMappings;
+  for (const auto &Mapping : Mappings) {
+    std::string Renumbered;
+    llvm::raw_string_ostream OS(Renumbered);
+    const uint8_t *Data =
+        reinterpret_cast<const uint8_t *>(Mapping.CoverageMapping.data());
+    const uint8_t *End = Data + Mapping.CoverageMapping.size();
+    unsigned N;
+    uint64_t NumFileIDs = llvm::decodeULEB128(Data, &N);
+    Data += N;
+    llvm::encodeULEB128(NumFileIDs, OS);
+    for (uint64_t I = 0; I < NumFileIDs; ++I) {
+      unsigned FileID = llvm::decodeULEB128(Data, &N);
+      Data += N;
+      auto Entry =
+          BlockFileIDs.insert(std::make_pair(FileID, FilenameRefs.size()));
+      if (Entry.second)
+        FilenameRefs.push_back(Filenames[FileID]);
+      llvm::encodeULEB128(Entry.first->second, OS);
+    }
+    OS << StringRef(reinterpret_cast<const char *>(Data), End - Data);
+    OS.flush();
 
-    auto I = Entry.second;
-    FilenameStrs[I] = std::move(std::string(Path.begin(), Path.end()));
-    FilenameRefs[I] = FilenameStrs[I];
+    llvm::Constant *FunctionRecordVals[] = {
+        llvm::ConstantExpr::getBitCast(Mapping.FunctionName, Int8PtrTy),
+        llvm::ConstantInt::get(Int32Ty, Mapping.FunctionNameValue.size()),
+        llvm::ConstantInt::get(Int32Ty, Renumbered.size()),
+        llvm::ConstantInt::get(Int64Ty, Mapping.FunctionHash)};
+    FunctionRecords.push_back(llvm::ConstantStruct::get(
+        FunctionRecordTy, makeArrayRef(FunctionRecordVals)));
+    CoverageMappings += Renumbered;
   }
+  NumBlockFiles = FilenameRefs.size();
 
+  // Merge the filenames with the coverage mappings.
   std::string FilenamesAndCoverageMappings;
   llvm::raw_string_ostream OS(FilenamesAndCoverageMappings);
   CoverageFilenamesSectionWriter(FilenameRefs).write(OS);
@@ -1174,15 +1201,70 @@ void CoverageMappingModuleGen::emit() {
   auto CovDataVal =
       llvm::ConstantStruct::get(CovDataTy, makeArrayRef(TUDataVals));
   auto CovData = new llvm::GlobalVariable(CGM.getModule(), CovDataTy, true,
-                                          llvm::GlobalValue::InternalLinkage,
-                                          CovDataVal,
-                                          "__llvm_coverage_mapping");
+                                          Linkage, CovDataVal, Name);
 
+  // Like the profile names, blocks that other translation units may emit too
+  // are hidden, so that each executable gets its own copy.
+  if (!CovData->hasLocalLinkage()) {
+    CovData->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    if (CGM.supportsCOMDAT())
+      CovData->setComdat(CGM.getModule().getOrInsertComdat(CovData->getName()));
+  }
   CovData->setSection(getCoverageSection(CGM));
   CovData->setAlignment(8);
 
   // Make sure the data doesn't get deleted.
   CGM.addUsedGlobal(CovData);
+  return CGM.getDataLayout().getTypeAllocSize(CovDataTy);
+}
+
+void CoverageMappingModuleGen::emit() {
+  if (FunctionMappings.empty() && SharedFunctionMappings.empty())
+    return;
+  llvm::LLVMContext &Ctx = CGM.getLLVMContext();
+  auto *Int32Ty = llvm::Type::getInt32Ty(Ctx);
+  auto *Int64Ty = llvm::Type::getInt64Ty(Ctx);
+  auto *Int8PtrTy = llvm::Type::getInt8PtrTy(Ctx);
+  llvm::Type *FunctionRecordTypes[] = {Int8PtrTy, Int32Ty, Int32Ty, Int64Ty};
+  FunctionRecordTy =
+      llvm::StructType::get(Ctx, makeArrayRef(FunctionRecordTypes));
+
+  // Create the filenames
+  std::vector<std::string> Filenames(FileEntries.size());
+  for (const auto &Entry : FileEntries) {
+    llvm::SmallString<256> Path(Entry.first->getName());
+    llvm::sys::fs::make_absolute(Path);
+    Filenames[Entry.second] = Path.str();
+  }
+
+  // A function that other translation units may emit as well, such as an
+  // inline function in a header, gets a block of its own. The block is named
+  // after the function and its hash, so the linker keeps just one copy of it
+  // and the files it refers to.
+  for (const auto &Mapping : SharedFunctionMappings) {
+    unsigned NumBlockFiles;
+    SharedMappingBytes += emitMappings(
+        Mapping, Filenames, llvm::GlobalValue::LinkOnceODRLinkage,
+        "__llvm_coverage_mapping_" + Mapping.FunctionNameValue + "_" +
+            llvm::utohexstr(Mapping.FunctionHash),
+        NumBlockFiles);
+  }
+
+  MappingBytes =
+      emitMappings(FunctionMappings, Filenames,
+                   llvm::GlobalValue::InternalLinkage,
+                   "__llvm_coverage_mapping", NumFiles);
+}
+
+void CoverageMappingModuleGen::printStats() const {
+  llvm::errs() << "\n*** Coverage Mapping Stats:\n";
+  llvm::errs() << "  " << FunctionMappings.size()
+               << " functions mapped in the translation unit's block, "
+               << MappingBytes << " bytes, " << NumFiles << " files\n";
+  llvm::errs() << "  " << SharedFunctionMappings.size()
+               << " functions mapped in blocks shared with other "
+                  "translation units, "
+               << SharedMappingBytes << " bytes\n";
 }
 
 unsigned CoverageMappingModuleGen::getFileID(const FileEntry *File) {
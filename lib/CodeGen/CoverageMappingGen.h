@@ -50,16 +50,42 @@ class CodeGenModule;
 /// \brief Organizes the cross-function state that is used while generating
 /// code coverage mapping data.
 class CoverageMappingModuleGen {
+  /// \brief The coverage mapping of a function, whose file IDs are those of
+  /// the translation unit.
+  struct FunctionMapping {
+    llvm::GlobalVariable *FunctionName;
+    std::string FunctionNameValue;
+    uint64_t FunctionHash;
+    std::string CoverageMapping;
+  };
+
   CodeGenModule &CGM;
   CoverageSourceInfo &SourceInfo;
   llvm::SmallDenseMap<const FileEntry *, unsigned, 8> FileEntries;
-  std::vector<llvm::Constant *> FunctionRecords;
+  /// \brief The functions whose mappings are emitted with the translation
+  /// unit's.
+  std::vector<FunctionMapping> FunctionMappings;
+  /// \brief The functions that may be emitted by other translation units as
+  /// well, whose mappings are emitted on their own so the linker can keep
+  /// just one copy.
+  std::vector<FunctionMapping> SharedFunctionMappings;
   llvm::StructType *FunctionRecordTy;
-  std::string CoverageMappings;
+
+  /// \brief Statistics for -print-stats.
+  unsigned NumFiles;
+  uint64_t MappingBytes, SharedMappingBytes;
+
+  /// \brief Emit a block of coverage mapping data for \p Mappings, with a
+  /// table of just the files they refer to, and return its size.
+  uint64_t emitMappings(ArrayRef<FunctionMapping> Mappings,
+                        ArrayRef<std::string> Filenames,
+                        llvm::GlobalValue::LinkageTypes Linkage,
+                        const Twine &Name, unsigned &NumBlockFiles);
 
 public:
   CoverageMappingModuleGen(CodeGenModule &CGM, CoverageSourceInfo &SourceInfo)
-      : CGM(CGM), SourceInfo(SourceInfo), FunctionRecordTy(nullptr) {}
+      : CGM(CGM), SourceInfo(SourceInfo), FunctionRecordTy(nullptr),
+        NumFiles(0), MappingBytes(0), SharedMappingBytes(0) {}
 
   CoverageSourceInfo &getSourceInfo() const {
     return SourceInfo;
@@ -75,6 +101,9 @@ public:
   /// \brief Emit the coverage mapping data for a translation unit.
   void emit();
 
+  /// \brief Print the sizes of the emitted coverage mapping data.
+  void printStats() const;
+
   /// \brief Return the coverage mapping translation unit file id
   /// for the given file.
   unsigned getFileID(const FileEntry *File);
@@ -3102,12 +3102,19 @@ static StructorCodegen getCodegenToUse(CodeGenModule &CGM,
   }
   llvm::GlobalValue::LinkageTypes Linkage = CGM.getFunctionLinkage(AliasDecl);
 
+  // With streaming code generation, the code for the callers of the complete
+  // structor may already have been generated, so they can't be redirected to
+  // the base structor.
+  StructorCodegen Replace = CGM.getCodeGenOpts().StreamingCodeGen
+                                ? StructorCodegen::Emit
+                                : StructorCodegen::RAUW;
+
   if (llvm::GlobalValue::isDiscardableIfUnused(Linkage))
-    return StructorCodegen::RAUW;
+    return Replace;
 
   // FIXME: Should we allow available_externally aliases?
   if (!llvm::GlobalAlias::isValidLinkage(Linkage))
-    return StructorCodegen::RAUW;
+    return Replace;
 
   if (llvm::GlobalValue::isWeakForLinker(Linkage)) {
     // Only ELF supports COMDATs with arbitrary names (C5/D5).
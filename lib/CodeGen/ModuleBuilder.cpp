@@ -14,6 +14,7 @@
 #include "clang/CodeGen/ModuleBuilder.h"
 #include "CGDebugInfo.h"
 #include "CodeGenModule.h"
+#include "CoverageMappingGen.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/Expr.h"
@@ -47,6 +48,7 @@ namespace {
     };
 
     CoverageSourceInfo *CoverageInfo;
+    CodeGen::LoopReport *Loops;
 
   protected:
     std::unique_ptr<llvm::Module> M;
@@ -55,9 +57,10 @@ namespace {
   public:
     CodeGeneratorImpl(DiagnosticsEngine &diags, const std::string& ModuleName,
                       const CodeGenOptions &CGO, llvm::LLVMContext& C,
-                      CoverageSourceInfo *CoverageInfo = nullptr)
+                      CoverageSourceInfo *CoverageInfo = nullptr,
+                      CodeGen::LoopReport *Loops = nullptr)
       : Diags(diags), CodeGenOpts(CGO), HandlingTopLevelDecls(0),
-        CoverageInfo(CoverageInfo),
+        CoverageInfo(CoverageInfo), Loops(Loops),
         M(new llvm::Module(ModuleName, C)) {}
 
     virtual ~CodeGeneratorImpl() {}
@@ -83,6 +86,10 @@ namespace {
 
     llvm::Module *ReleaseModule() override { return M.release(); }
 
+    void SetStreamingBackend(StreamingBackend *S) override {
+      Builder->setStreamingBackend(S);
+    }
+
     void Initialize(ASTContext &Context) override {
       Ctx = &Context;
 
@@ -90,7 +97,7 @@ namespace {
       M->setDataLayout(Ctx->getTargetInfo().getTargetDescription());
       TD.reset(new llvm::DataLayout(Ctx->getTargetInfo().getTargetDescription()));
       Builder.reset(new CodeGen::CodeGenModule(Context, CodeGenOpts, *M, *TD,
-                                               Diags, CoverageInfo));
+                                               Diags, CoverageInfo, Loops));
 
       for (size_t i = 0, e = CodeGenOpts.DependentLibraries.size(); i < e; ++i)
         HandleDependentLibrary(CodeGenOpts.DependentLibraries[i]);
@@ -197,6 +204,14 @@ namespace {
         Builder->Release();
     }
 
+    void PrintStats() override {
+      if (!Builder)
+        return;
+      if (CodeGen::CoverageMappingModuleGen *CoverageMapping =
+              Builder->getCoverageMapping())
+        CoverageMapping->printStats();
+    }
+
     void CompleteTentativeDefinition(VarDecl *D) override {
       if (Diags.hasErrorOccurred())
         return;
@@ -236,6 +251,8 @@ CodeGenerator *clang::CreateLLVMCodeGen(DiagnosticsEngine &Diags,
                                         const CodeGenOptions &CGO,
                                         const TargetOptions &/*TO*/,
                                         llvm::LLVMContext& C,
-                                        CoverageSourceInfo *CoverageInfo) {
-  return new CodeGeneratorImpl(Diags, ModuleName, CGO, C, CoverageInfo);
+                                        CoverageSourceInfo *CoverageInfo,
+                                        CodeGen::LoopReport *Loops) {
+  return new CodeGeneratorImpl(Diags, ModuleName, CGO, C, CoverageInfo,
+                               Loops);
 }
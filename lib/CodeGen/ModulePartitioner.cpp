@@ -0,0 +1,379 @@
+//===--- ModulePartitioner.cpp - Split a module for codegen ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Class which splits an optimized module into partitions whose code can be
+// generated independently.
+//
+//===----------------------------------------------------------------------===//
+#include "ModulePartitioner.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DebugInfo.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MD5.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+using namespace CodeGen;
+
+/// \brief Whether \p GV is one of the globals with a special meaning to the
+/// code generator, such as llvm.used and llvm.global_ctors.
+static bool isSpecialGlobal(const llvm::GlobalValue &GV) {
+  return GV.getName().startswith("llvm.");
+}
+
+/// \brief Whether \p GV is a list of used globals, which is split along with
+/// the globals it lists. The other special globals go in the first partition.
+static bool isUsedList(const llvm::GlobalValue &GV) {
+  return GV.getName() == "llvm.used" || GV.getName() == "llvm.compiler.used";
+}
+
+/// \brief Estimate the time it takes to generate code for \p GV.
+static unsigned getCost(const llvm::GlobalValue &GV) {
+  unsigned Cost = 1;
+  if (const auto *F = dyn_cast<llvm::Function>(&GV))
+    for (const llvm::BasicBlock &BB : *F)
+      Cost += BB.size();
+  return Cost;
+}
+
+/// \brief Collect the globals whose definitions use \p V.
+static void collectUsers(const llvm::Value *V,
+                         llvm::SmallPtrSetImpl<const llvm::Value *> &Visited,
+                         SmallVectorImpl<const llvm::GlobalValue *> &Users) {
+  for (const llvm::User *U : V->users()) {
+    if (const auto *I = dyn_cast<llvm::Instruction>(U))
+      Users.push_back(I->getParent()->getParent());
+    else if (const auto *GV = dyn_cast<llvm::GlobalValue>(U))
+      Users.push_back(GV);
+    else if (Visited.insert(U).second)
+      collectUsers(U, Visited, Users);
+  }
+}
+
+/// \brief Collect the names of the symbols the module-level inline asm of
+/// \p M may refer to. This over-approximates: every token that could be a
+/// symbol is collected, both as it is and without a leading underscore, for
+/// targets that prefix the names of globals.
+static void collectAsmNames(const llvm::Module &M, llvm::StringSet<> &Names) {
+  StringRef Asm = M.getModuleInlineAsm();
+  auto IsSymbolChar = [](char C) {
+    return isIdentifierBody(C, /*AllowDollar=*/true) || C == '.';
+  };
+  while (!Asm.empty()) {
+    size_t Len = 0;
+    while (Len != Asm.size() && IsSymbolChar(Asm[Len]))
+      ++Len;
+    if (Len) {
+      StringRef Name = Asm.substr(0, Len);
+      Names.insert(Name);
+      if (Name.startswith("_"))
+        Names.insert(Name.substr(1));
+    }
+    Asm = Asm.substr(Len ? Len : 1);
+  }
+}
+
+/// \brief Hash the names of the definitions \p M exports, which no other
+/// module linked with it defines as well.
+static std::string getModuleHash(const llvm::Module &M) {
+  llvm::MD5 Hash;
+  Hash.update(M.getModuleIdentifier());
+  auto AddName = [&](const llvm::GlobalValue &GV) {
+    if (!GV.isDeclaration() && !GV.hasLocalLinkage()) {
+      Hash.update(GV.getName());
+      Hash.update(StringRef("", 1));
+    }
+  };
+  for (const llvm::GlobalVariable &GV : M.globals())
+    AddName(GV);
+  for (const llvm::Function &F : M)
+    AddName(F);
+  for (const llvm::GlobalAlias &GA : M.aliases())
+    AddName(GA);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Str.str().substr(0, 16);
+}
+
+ModulePartitioner::ModulePartitioner(llvm::Module &M,
+                                     unsigned NumPartitions) {
+  // Collect the definitions, in module order. They are found by name in the
+  // copies of the module, so the unnamed ones get a name.
+  SmallVector<llvm::GlobalValue *, 256> Definitions;
+  for (llvm::GlobalVariable &GV : M.globals())
+    if (!GV.isDeclaration() && !isSpecialGlobal(GV))
+      Definitions.push_back(&GV);
+  for (llvm::Function &F : M)
+    if (!F.isDeclaration())
+      Definitions.push_back(&F);
+  for (llvm::GlobalAlias &GA : M.aliases())
+    Definitions.push_back(&GA);
+  for (llvm::GlobalValue *GV : Definitions)
+    if (!GV->hasName())
+      GV->setName("__unnamed");
+
+  // Group the definitions that have to be emitted together.
+  llvm::EquivalenceClasses<const llvm::GlobalValue *> Groups;
+  llvm::DenseMap<const llvm::Comdat *, const llvm::GlobalValue *> Comdats;
+  for (llvm::GlobalValue *GV : Definitions) {
+    Groups.insert(GV);
+    if (const auto *GA = dyn_cast<llvm::GlobalAlias>(GV)) {
+      if (const llvm::GlobalObject *Base = GA->getBaseObject())
+        Groups.unionSets(GA, Base);
+      continue;
+    }
+
+    if (const llvm::Comdat *C = cast<llvm::GlobalObject>(GV)->getComdat()) {
+      auto Inserted = Comdats.insert(std::make_pair(C, GV));
+      if (!Inserted.second)
+        Groups.unionSets(GV, Inserted.first->second);
+    }
+
+    // A blockaddress can't refer to a function in another module.
+    for (const llvm::User *U : GV->users()) {
+      if (!isa<llvm::BlockAddress>(U))
+        continue;
+      llvm::SmallPtrSet<const llvm::Value *, 8> Visited;
+      SmallVector<const llvm::GlobalValue *, 8> Users;
+      collectUsers(U, Visited, Users);
+      for (const llvm::GlobalValue *User : Users)
+        if (!isSpecialGlobal(*User))
+          Groups.unionSets(GV, User);
+    }
+  }
+
+  // The definitions the module-level asm refers to go with the asm, in the
+  // first partition. A local one can't be renamed, since the asm refers to
+  // it by name, so its users go there as well.
+  const llvm::GlobalValue *AsmGroup = nullptr;
+  llvm::StringSet<> AsmNames;
+  collectAsmNames(M, AsmNames);
+  for (llvm::GlobalValue *GV : Definitions) {
+    StringRef Name = GV->getName();
+    if (Name.startswith("\1"))
+      Name = Name.substr(1);
+    if (!AsmNames.count(Name))
+      continue;
+    if (!AsmGroup)
+      AsmGroup = GV;
+    Groups.unionSets(AsmGroup, GV);
+    if (!GV->hasLocalLinkage())
+      continue;
+    llvm::SmallPtrSet<const llvm::Value *, 8> Visited;
+    SmallVector<const llvm::GlobalValue *, 8> Users;
+    collectUsers(GV, Visited, Users);
+    for (const llvm::GlobalValue *User : Users)
+      if (!isSpecialGlobal(*User))
+        Groups.unionSets(GV, User);
+  }
+
+  SmallVector<std::pair<const llvm::GlobalValue *, unsigned>, 64> Order;
+  {
+    llvm::MapVector<const llvm::GlobalValue *, unsigned> GroupCost;
+    for (const llvm::GlobalValue *GV : Definitions)
+      GroupCost[Groups.getLeaderValue(GV)] += getCost(*GV);
+    Order.append(GroupCost.begin(), GroupCost.end());
+  }
+
+  // The debug info of a compile unit can't be split, so a module with debug
+  // info is generated as a whole.
+  if (M.getNamedMetadata("llvm.dbg.cu"))
+    NumPartitions = 1;
+
+  // Assign the most expensive groups first, each to the partition with the
+  // least work so far. Ties are broken by module order. The group of the
+  // module-level asm is placed in the first partition before the others.
+  std::stable_sort(Order.begin(), Order.end(),
+                   [](const std::pair<const llvm::GlobalValue *, unsigned> &A,
+                      const std::pair<const llvm::GlobalValue *, unsigned> &B) {
+    return A.second > B.second;
+  });
+  std::vector<uint64_t> Load(NumPartitions);
+  llvm::DenseMap<const llvm::GlobalValue *, unsigned> GroupPartition;
+  if (AsmGroup) {
+    AsmGroup = Groups.getLeaderValue(AsmGroup);
+    for (const auto &Group : Order)
+      if (Group.first == AsmGroup)
+        Load[0] += Group.second;
+    GroupPartition[AsmGroup] = 0;
+  }
+  for (const auto &Group : Order) {
+    if (Group.first == AsmGroup)
+      continue;
+    unsigned P = std::min_element(Load.begin(), Load.end()) - Load.begin();
+    Load[P] += Group.second;
+    GroupPartition[Group.first] = P;
+  }
+
+  llvm::DenseMap<const llvm::GlobalValue *, unsigned> Partition;
+  NumDefinitions.assign(NumPartitions, 0);
+  for (const llvm::GlobalValue *GV : Definitions) {
+    unsigned P = GroupPartition[Groups.getLeaderValue(GV)];
+    Partition[GV] = P;
+    ++NumDefinitions[P];
+  }
+
+  // Local symbols used from another partition become hidden external ones,
+  // with a name that no other module defines.
+  std::string Suffix;
+  for (llvm::GlobalValue *GV : Definitions) {
+    if (!GV->hasLocalLinkage())
+      continue;
+
+    llvm::SmallPtrSet<const llvm::Value *, 8> Visited;
+    SmallVector<const llvm::GlobalValue *, 8> Users;
+    collectUsers(GV, Visited, Users);
+    unsigned Home = Partition[GV];
+    bool UsedElsewhere = false;
+    for (const llvm::GlobalValue *User : Users) {
+      if (isUsedList(*User))
+        continue;
+      unsigned UserPartition =
+          isSpecialGlobal(*User) ? 0 : Partition.lookup(User);
+      if (UserPartition != Home) {
+        UsedElsewhere = true;
+        break;
+      }
+    }
+    if (!UsedElsewhere)
+      continue;
+
+    if (Suffix.empty())
+      Suffix = ".llvm." + getModuleHash(M);
+    GV->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    GV->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    GV->setName(llvm::Twine(GV->getName()) + Suffix);
+  }
+
+  for (const llvm::GlobalValue *GV : Definitions)
+    PartitionOf[GV->getName()] = Partition[GV];
+}
+
+/// \brief Remove from the list \p Name of used globals the globals that
+/// \p M doesn't define.
+static void filterUsedList(llvm::Module &M, StringRef Name) {
+  llvm::GlobalVariable *Used = M.getNamedGlobal(Name);
+  if (!Used || !Used->hasInitializer())
+    return;
+  const auto *Init = dyn_cast<llvm::ConstantArray>(Used->getInitializer());
+  if (!Init)
+    return;
+
+  SmallVector<llvm::Constant *, 16> Kept;
+  for (const llvm::Use &Op : Init->operands()) {
+    llvm::Constant *C = cast<llvm::Constant>(Op.get());
+    if (!cast<llvm::GlobalValue>(C->stripPointerCasts())->isDeclaration())
+      Kept.push_back(C);
+  }
+  if (Kept.size() == Init->getNumOperands())
+    return;
+  if (Kept.empty()) {
+    Used->eraseFromParent();
+    return;
+  }
+
+  llvm::ArrayType *Ty =
+      llvm::ArrayType::get(Init->getType()->getElementType(), Kept.size());
+  auto *NewUsed = new llvm::GlobalVariable(
+      M, Ty, /*isConstant=*/false, Used->getLinkage(),
+      llvm::ConstantArray::get(Ty, Kept), "", Used);
+  NewUsed->setSection(Used->getSection());
+  NewUsed->takeName(Used);
+  Used->eraseFromParent();
+}
+
+bool ModulePartitioner::isEmpty(unsigned Partition) const {
+  return Partition != 0 && (Partition >= NumDefinitions.size() ||
+                            NumDefinitions[Partition] == 0);
+}
+
+void ModulePartitioner::extractPartition(llvm::Module &M,
+                                         unsigned Partition) const {
+  auto InPartition = [&](const llvm::GlobalValue &GV) {
+    llvm::StringMap<unsigned>::const_iterator I =
+        PartitionOf.find(GV.getName());
+    return I == PartitionOf.end() || I->second == Partition;
+  };
+
+  // An alias can't refer to a declaration, so aliases are replaced with
+  // declarations before their aliasees are.
+  for (llvm::Module::alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E;) {
+    llvm::GlobalAlias &GA = *I++;
+    if (InPartition(GA))
+      continue;
+
+    llvm::Type *Ty = GA.getType()->getElementType();
+    llvm::GlobalValue *Decl;
+    if (auto *FTy = dyn_cast<llvm::FunctionType>(Ty)) {
+      Decl = llvm::Function::Create(FTy, llvm::GlobalValue::ExternalLinkage,
+                                    "", &M);
+    } else {
+      auto *Var = new llvm::GlobalVariable(
+          M, Ty, /*isConstant=*/false, llvm::GlobalValue::ExternalLinkage,
+          nullptr, "", nullptr, llvm::GlobalVariable::NotThreadLocal,
+          GA.getType()->getAddressSpace());
+      if (const auto *Base =
+              dyn_cast_or_null<llvm::GlobalVariable>(GA.getBaseObject()))
+        Var->setThreadLocalMode(Base->getThreadLocalMode());
+      Decl = Var;
+    }
+    Decl->takeName(&GA);
+    Decl->setVisibility(GA.getVisibility());
+    GA.replaceAllUsesWith(
+        llvm::ConstantExpr::getPointerCast(Decl, GA.getType()));
+    GA.eraseFromParent();
+  }
+
+  for (llvm::Function &F : M) {
+    if (F.isDeclaration() || InPartition(F))
+      continue;
+    F.deleteBody();
+    F.setComdat(nullptr);
+  }
+
+  for (llvm::Module::global_iterator I = M.global_begin(),
+                                     E = M.global_end();
+       I != E;) {
+    llvm::GlobalVariable &GV = *I++;
+    if (isSpecialGlobal(GV)) {
+      if (Partition != 0 && !isUsedList(GV))
+        GV.eraseFromParent();
+      continue;
+    }
+    if (GV.isDeclaration() || InPartition(GV))
+      continue;
+    GV.setInitializer(nullptr);
+    GV.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    GV.setComdat(nullptr);
+  }
+
+  filterUsedList(M, "llvm.used");
+  filterUsedList(M, "llvm.compiler.used");
+
+  // Module-level inline asm and debug info go in the first partition.
+  if (Partition != 0) {
+    M.setModuleInlineAsm("");
+    llvm::StripDebugInfo(M);
+  }
+}
@@ -0,0 +1,70 @@
+//===--- ModulePartitioner.h - Split a module for codegen -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Class which splits an optimized module into partitions whose code can be
+// generated independently.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_CLANG_LIB_CODEGEN_MODULEPARTITIONER_H
+#define LLVM_CLANG_LIB_CODEGEN_MODULEPARTITIONER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+
+namespace llvm {
+class Module;
+}
+
+namespace clang {
+namespace CodeGen {
+
+/// \brief Splits a module along global boundaries into partitions of about
+/// the same size, each of which can be compiled to an object file of its own.
+///
+/// Globals that have to be emitted together, such as the members of a comdat,
+/// an alias and its aliasee, or the functions whose blocks are referenced by
+/// a blockaddress, are kept in the same partition. The definitions that the
+/// module-level asm refers to are kept with the asm. Local symbols referenced
+/// from another partition are given hidden external linkage and a name that
+/// is unique to the module. The assignment depends only on the contents of
+/// the module, so that the output is deterministic.
+class ModulePartitioner {
+  ModulePartitioner(const ModulePartitioner &) LLVM_DELETED_FUNCTION;
+  void operator=(const ModulePartitioner &) LLVM_DELETED_FUNCTION;
+
+  /// \brief The partition of each definition, by name.
+  llvm::StringMap<unsigned> PartitionOf;
+
+  /// \brief The number of definitions in each partition.
+  SmallVector<unsigned, 8> NumDefinitions;
+
+public:
+  /// \brief Assign the definitions of \p M to \p NumPartitions partitions,
+  /// and externalize the local symbols that are used across partitions.
+  ///
+  /// A module with debug info is kept in the first partition, since the
+  /// debug info of a compile unit can't be split.
+  ModulePartitioner(llvm::Module &M, unsigned NumPartitions);
+
+  /// \brief Whether partition \p Partition has no definitions. The first
+  /// partition, which holds the module-level asm and the special globals,
+  /// is never empty.
+  bool isEmpty(unsigned Partition) const;
+
+  /// \brief Turn \p M, a copy of the module the partitioner was created
+  /// for, into partition \p Partition, by dropping the definitions that
+  /// belong to other partitions.
+  void extractPartition(llvm::Module &M, unsigned Partition) const;
+};
+
+}  // end namespace CodeGen
+}  // end namespace clang
+
+#endif
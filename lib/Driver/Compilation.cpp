@@ -14,9 +14,15 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace clang::driver;
 using namespace clang;
@@ -122,35 +128,47 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
-                                    llvm::sys::fs::F_Append |
-                                        llvm::sys::fs::F_Text);
-      if (EC) {
-        getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        delete OS;
-        return 1;
-      }
+/// PrintCommand - Print a command about to be executed, for -v and
+/// CC_PRINT_OPTIONS.
+///
+/// \return False if the command must not be run.
+static bool PrintCommand(const Compilation &C, const Command &Cmd) {
+  const Driver &D = C.getDriver();
+  if ((!D.CCPrintOptions && !C.getArgs().hasArg(options::OPT_v)) ||
+      D.CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (D.CCPrintOptions && D.CCPrintOptionsFilename) {
+    std::error_code EC;
+    OS = new llvm::raw_fd_ostream(D.CCPrintOptionsFilename, EC,
+                                  llvm::sys::fs::F_Append |
+                                      llvm::sys::fs::F_Text);
+    if (EC) {
+      D.Diag(clang::diag::err_drv_cc_print_options_failure) << EC.message();
+      delete OS;
+      return false;
     }
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (D.CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  Cmd.Print(*OS, "\n", /*Quote=*/D.CCPrintOptions);
 
-    if (OS != &llvm::errs())
-      delete OS;
+  if (OS != &llvm::errs())
+    delete OS;
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommand(*this, C)) {
+    FailingCommand = &C;
+    return 1;
   }
 
   std::string Error;
@@ -207,6 +225,201 @@ void Compilation::ExecuteJob(const Job &J,
   }
 }
 
+namespace {
+/// \brief A command run by Compilation::ExecuteJobs.
+struct ParallelCommand {
+  enum StateKind { Waiting, Running, Finished, Skipped };
+
+  const Command *Cmd;
+
+  /// The earlier commands producing the inputs of this one.
+  SmallVector<unsigned, 4> Deps;
+
+  StateKind State;
+  std::thread Thread;
+
+  /// The files the output of the command is written to, and the redirections
+  /// naming them.
+  SmallString<128> OutputFile, ErrorFile;
+  StringRef OutputFileRef, ErrorFileRef;
+  const StringRef *Redirects[3];
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res;
+
+  ParallelCommand()
+      : Cmd(nullptr), State(Waiting), ExecutionFailed(false), Res(0) {}
+
+  bool failed() const { return State == Finished && (Res || ExecutionFailed); }
+};
+}
+
+static void CollectCommands(const Job &J,
+                            SmallVectorImpl<const Command *> &Commands) {
+  if (const Command *C = dyn_cast<Command>(&J)) {
+    Commands.push_back(C);
+    return;
+  }
+  for (const auto &Job : *cast<JobList>(&J))
+    CollectCommands(Job, Commands);
+}
+
+static void CollectActions(const Action *A,
+                           llvm::SmallPtrSetImpl<const Action *> &Actions) {
+  if (!Actions.insert(A).second)
+    return;
+  for (Action::const_iterator AI = A->begin(), AE = A->end(); AI != AE; ++AI)
+    CollectActions(*AI, Actions);
+}
+
+/// \brief Redirect the output of \p PC to temporary files, so that it can
+/// be written once the commands before it have finished.
+static bool RedirectOutput(ParallelCommand &PC) {
+  if (llvm::sys::fs::createTemporaryFile("clang-job", "out", PC.OutputFile) ||
+      llvm::sys::fs::createTemporaryFile("clang-job", "err", PC.ErrorFile)) {
+    if (!PC.OutputFile.empty())
+      llvm::sys::fs::remove(PC.OutputFile.str());
+    return false;
+  }
+  PC.OutputFileRef = PC.OutputFile.str();
+  PC.ErrorFileRef = PC.ErrorFile.str();
+  PC.Redirects[0] = nullptr;
+  PC.Redirects[1] = &PC.OutputFileRef;
+  PC.Redirects[2] = &PC.ErrorFileRef;
+  return true;
+}
+
+/// \brief Write the buffered output of a command to \p OS, and remove the
+/// file that held it.
+static void ReplayOutput(StringRef File, raw_ostream &OS) {
+  if (File.empty())
+    return;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(File);
+  if (Buffer) {
+    OS << (*Buffer)->getBuffer();
+    OS.flush();
+  }
+  llvm::sys::fs::remove(File);
+}
+
+void Compilation::ExecuteJobs(const JobList &Jobs,
+                              FailingCommandList &FailingCommands,
+                              unsigned MaxParallelJobs) const {
+  SmallVector<const Command *, 16> Commands;
+  CollectCommands(Jobs, Commands);
+
+  // Output redirected for diagnostics can't be buffered.
+  if (MaxParallelJobs <= 1 || Commands.size() <= 1 || Redirects) {
+    ExecuteJob(Jobs, FailingCommands);
+    return;
+  }
+
+  // A command depends on the earlier commands whose source action is among
+  // the inputs of its own, which is also what InputsOk checks.
+  std::vector<ParallelCommand> State(Commands.size());
+  for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+    State[I].Cmd = Commands[I];
+    llvm::SmallPtrSet<const Action *, 16> Inputs;
+    CollectActions(&Commands[I]->getSource(), Inputs);
+    for (unsigned J = 0; J != I; ++J)
+      if (Inputs.count(&Commands[J]->getSource()))
+        State[I].Deps.push_back(J);
+  }
+
+  std::mutex Mutex;
+  std::condition_variable CommandFinished;
+  unsigned NumRunning = 0;
+  unsigned NextToReport = 0;
+  // Whether a command is running in the driver process, which it can't share
+  // with any other command.
+  bool InProcessRunning = false;
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true) {
+    // Start the commands whose inputs are ready, earliest first.
+    for (unsigned I = NextToReport, E = State.size();
+         I != E && NumRunning < MaxParallelJobs && !InProcessRunning; ++I) {
+      ParallelCommand &PC = State[I];
+      if (PC.State != ParallelCommand::Waiting)
+        continue;
+
+      bool Ready = true, InputsOk = true;
+      for (unsigned D : PC.Deps) {
+        const ParallelCommand &Dep = State[D];
+        if (Dep.State == ParallelCommand::Skipped || Dep.failed())
+          InputsOk = false;
+        else if (Dep.State != ParallelCommand::Finished)
+          Ready = false;
+      }
+      if (!InputsOk) {
+        PC.State = ParallelCommand::Skipped;
+        continue;
+      }
+      if (!Ready)
+        continue;
+
+      // If the output can't be buffered, let the command write it directly.
+      const StringRef **CmdRedirects =
+          RedirectOutput(PC) ? PC.Redirects : nullptr;
+
+      // A cc1 command without redirections runs in the driver process, so
+      // it has to wait for the running commands, and run alone.
+      bool InProcess = !CmdRedirects && isa<CC1Command>(PC.Cmd);
+      if (InProcess && NumRunning)
+        break;
+      InProcessRunning = InProcess;
+
+      PC.State = ParallelCommand::Running;
+      ++NumRunning;
+      PC.Thread = std::thread([&PC, CmdRedirects, &Mutex, &CommandFinished,
+                               &NumRunning, &InProcessRunning] {
+        bool ExecutionFailed;
+        std::string Error;
+        int Res = PC.Cmd->Execute(CmdRedirects, &Error, &ExecutionFailed);
+
+        std::lock_guard<std::mutex> Guard(Mutex);
+        PC.Res = Res;
+        PC.Error = std::move(Error);
+        PC.ExecutionFailed = ExecutionFailed;
+        PC.State = ParallelCommand::Finished;
+        --NumRunning;
+        InProcessRunning = false;
+        CommandFinished.notify_one();
+      });
+    }
+
+    // Report the commands that are done, in order.
+    for (; NextToReport != State.size(); ++NextToReport) {
+      ParallelCommand &PC = State[NextToReport];
+      if (PC.State == ParallelCommand::Skipped)
+        continue;
+      if (PC.State != ParallelCommand::Finished)
+        break;
+      PC.Thread.join();
+
+      bool Printed = PrintCommand(*this, *PC.Cmd);
+      ReplayOutput(PC.OutputFile, llvm::outs());
+      ReplayOutput(PC.ErrorFile, llvm::errs());
+      if (!PC.Error.empty()) {
+        assert(PC.Res && "Error string set with 0 result code!");
+        getDriver().Diag(clang::diag::err_drv_command_failure) << PC.Error;
+      }
+
+      int Res = PC.ExecutionFailed ? 1 : PC.Res;
+      if (!Printed && !Res)
+        Res = 1;
+      if (Res)
+        FailingCommands.push_back(std::make_pair(Res, PC.Cmd));
+    }
+
+    if (NextToReport == State.size())
+      break;
+    CommandFinished.wait(Lock);
+  }
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
@@ -51,7 +51,7 @@ Driver::Driver(StringRef ClangExecutable,
     ClangExecutable(ClangExecutable), SysRoot(DEFAULT_SYSROOT),
     UseStdLib(true), DefaultTargetTriple(DefaultTargetTriple),
     DefaultImageName("a.out"),
-    DriverTitle("clang LLVM compiler"),
+    DriverTitle("clang LLVM compiler"), CC1Main(nullptr),
     CCPrintOptionsFilename(nullptr), CCPrintHeadersFilename(nullptr),
     CCLogDiagnosticsFilename(nullptr),
     CCCPrintBindings(false),
@@ -585,6 +585,15 @@ int Driver::ExecuteCompilation(Compilation &C,
     return 0;
   }
 
+  // Run up to -j commands at the same time.
+  unsigned MaxParallelJobs = 1;
+  if (Arg *A = C.getArgs().getLastArg(options::OPT_j)) {
+    if (StringRef(A->getValue()).getAsInteger(10, MaxParallelJobs) ||
+        MaxParallelJobs == 0)
+      Diag(clang::diag::err_drv_invalid_int_value)
+          << A->getAsString(C.getArgs()) << A->getValue();
+  }
+
   // If there were errors building the compilation, quit now.
   if (Diags.hasErrorOccurred())
     return 1;
@@ -592,7 +601,7 @@ int Driver::ExecuteCompilation(Compilation &C,
   // Set up response file names for each command, if necessary
   setUpResponseFiles(C, C.getJobs());
 
-  C.ExecuteJob(C.getJobs(), FailingCommands);
+  C.ExecuteJobs(C.getJobs(), FailingCommands, MaxParallelJobs);
 
   // Remove temp files.
   C.CleanupFileList(C.getTempFiles());
@@ -1444,6 +1453,9 @@ void Driver::BuildJobs(Compilation &C) const {
   // Claim --driver-mode, it was handled earlier.
   (void) C.getArgs().hasArg(options::OPT_driver_mode);
 
+  // Claim -j, it is handled when the jobs are executed.
+  (void) C.getArgs().hasArg(options::OPT_j);
+
   for (ArgList::const_iterator it = C.getArgs().begin(), ie = C.getArgs().end();
        it != ie; ++it) {
     Arg *A = *it;
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Job.h"
@@ -17,6 +18,8 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
@@ -30,7 +33,12 @@ Job::~Job() {}
 Command::Command(const Action &_Source, const Tool &_Creator,
                  const char *_Executable,
                  const ArgStringList &_Arguments)
-    : Job(CommandClass), Source(_Source), Creator(_Creator),
+    : Command(CommandClass, _Source, _Creator, _Executable, _Arguments) {}
+
+Command::Command(JobClass Kind, const Action &_Source, const Tool &_Creator,
+                 const char *_Executable,
+                 const ArgStringList &_Arguments)
+    : Job(Kind), Source(_Source), Creator(_Creator),
       Executable(_Executable), Arguments(_Arguments),
       ResponseFile(nullptr) {}
 
@@ -253,6 +261,44 @@ int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
                                    /*memoryLimit*/ 0, ErrMsg, ExecutionFailed);
 }
 
+CC1Command::CC1Command(const Action &Source_, const Tool &Creator_,
+                       const char *Executable_,
+                       const ArgStringList &Arguments_, CC1ToolFunc CC1Main_)
+    : Command(CC1CommandClass, Source_, Creator_, Executable_, Arguments_),
+      CC1Main(CC1Main_) {}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  // The tool shares our standard streams, so only a new process can have
+  // them redirected. This also keeps commands run in parallel with -j out of
+  // the driver process, which the tool can't share with another instance.
+  if (Redirects)
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  // A response file only exists to get around the command line length limit
+  // of the system, so the arguments are passed directly instead.
+  SmallVector<const char*, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  // Catch crashes in the tool, and report them with a negative status like
+  // a signal would be, so that crash diagnostics are still generated.
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  int Res = 0;
+  if (!CRC.RunSafely([&] { Res = CC1Main(Argv); })) {
+    // The tool didn't get to remove the handler it installed, and the next
+    // tool run in this process would fail to install its own. Nor did it
+    // get to stop its time trace, which the next run would start again.
+    llvm::remove_fatal_error_handler();
+    clang::timeTraceProfilerCleanup();
+    return -1;
+  }
+  return Res;
+}
+
 FallbackCommand::FallbackCommand(const Action &Source_, const Tool &Creator_,
                                  const char *Executable_,
                                  const ArgStringList &Arguments_,
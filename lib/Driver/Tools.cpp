@@ -2447,6 +2447,62 @@ static std::string getMSCompatibilityVersion(const char *VersionStr) {
       llvm::utostr_32(Build);
 }
 
+/// \brief The number of parts to generate the code for \p Output in with
+/// -fparallel-codegen, or 1 if it is generated as a whole.
+static unsigned getParallelCodeGenParts(const ToolChain &TC,
+                                        const ArgList &Args,
+                                        const InputInfo &Output) {
+  Arg *A = Args.getLastArg(options::OPT_fparallel_codegen_EQ);
+  if (!A)
+    return 1;
+  unsigned Parts;
+  if (StringRef(A->getValue()).getAsInteger(10, Parts) || Parts == 0) {
+    TC.getDriver().Diag(diag::err_drv_invalid_int_value)
+        << A->getAsString(Args) << A->getValue();
+    return 1;
+  }
+
+  // The parts are combined with a relocatable link, which link.exe can't do.
+  if (Output.getType() != types::TY_Object || !Output.isFilename() ||
+      StringRef(Output.getFilename()) == "-" ||
+      TC.getTriple().isWindowsMSVCEnvironment())
+    return 1;
+
+  // The debug info of a compile unit can't be split, so all the code would
+  // end up in the first part.
+  if (Arg *G = Args.getLastArg(options::OPT_g_Group))
+    if (!G->getOption().matches(options::OPT_g0))
+      return 1;
+  return Parts;
+}
+
+/// \brief Whether the -cc1 command \p CmdArgs should be run in the driver
+/// process instead of a process of its own.
+static bool shouldRunCC1InProcess(Compilation &C, const ArgList &Args,
+                                  const ArgStringList &CmdArgs) {
+  if (!Args.hasFlag(options::OPT_fintegrated_cc1,
+                    options::OPT_fno_integrated_cc1, false))
+    return false;
+  if (!C.getDriver().CC1Main)
+    return false;
+
+  // Without -disable-free, cc1 shuts down LLVM when it's done, which would
+  // leave nothing for the next command.
+  if (C.isForDiagnostics())
+    return false;
+
+  // The -mllvm options, and the options the backend passes on to LLVM, are
+  // parsed into global state, which can only be done once per process.
+  for (const char *Arg : CmdArgs)
+    if (llvm::StringSwitch<bool>(Arg)
+            .Cases("-mllvm", "-backend-option", "-ftime-report", true)
+            .Cases("-mdebug-pass", "-mlimit-float-precision",
+                   "-mno-global-merge", true)
+            .Default(false))
+      return false;
+  return true;
+}
+
 void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                          const InputInfo &Output,
                          const InputInfoList &Inputs,
@@ -2823,6 +2879,9 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   if (Args.hasFlag(options::OPT_fstrict_enums, options::OPT_fno_strict_enums,
                    false))
     CmdArgs.push_back("-fstrict-enums");
+  if (Args.hasFlag(options::OPT_fstreaming_codegen,
+                   options::OPT_fno_streaming_codegen, false))
+    CmdArgs.push_back("-fstreaming-codegen");
   if (!Args.hasFlag(options::OPT_foptimize_sibling_calls,
                     options::OPT_fno_optimize_sibling_calls))
     CmdArgs.push_back("-mdisable-tail-calls");
@@ -3203,6 +3262,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   if (Args.hasFlag(options::OPT_fdebug_types_section,
                    options::OPT_fno_debug_types_section, false)) {
+    CmdArgs.push_back("-fdebug-types-section");
     CmdArgs.push_back("-backend-option");
     CmdArgs.push_back("-generate-type-units");
   }
@@ -3231,6 +3291,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     A->render(Args, CmdArgs);
   else if (Args.hasArg(options::OPT_fprofile_instr_use))
     CmdArgs.push_back("-fprofile-instr-use=pgo-data");
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_instr_subset_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_instr_indirect_calls);
 
   if (Args.hasArg(options::OPT_ftest_coverage) ||
       Args.hasArg(options::OPT_coverage))
@@ -3247,6 +3309,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   if (Args.hasArg(options::OPT_fcoverage_mapping))
     CmdArgs.push_back("-fcoverage-mapping");
+  Args.AddLastArg(CmdArgs, options::OPT_fcoverage_mapping_main_file_only);
 
   if (C.getArgs().hasArg(options::OPT_c) ||
       C.getArgs().hasArg(options::OPT_S)) {
@@ -3497,6 +3560,13 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fconstexpr_cache_size_EQ)) {
+    CmdArgs.push_back("-fconstexpr-cache-size");
+    CmdArgs.push_back(A->getValue());
+  }
+
+  Args.AddLastArg(CmdArgs, options::OPT_fexperimental_constexpr_interpreter);
+
   if (Arg *A = Args.getLastArg(options::OPT_fbracket_depth_EQ)) {
     CmdArgs.push_back("-fbracket-depth");
     CmdArgs.push_back(A->getValue());
@@ -3586,6 +3656,12 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fheinous_gnu_extensions);
   Args.AddLastArg(CmdArgs, options::OPT_fstandalone_debug);
   Args.AddLastArg(CmdArgs, options::OPT_fno_standalone_debug);
+  if (Args.hasFlag(options::OPT_fdebug_type_homing,
+                   options::OPT_fno_debug_type_homing, false))
+    CmdArgs.push_back("-fdebug-type-homing");
+  Args.AddLastArg(CmdArgs, options::OPT_fdebug_type_homing_manifest_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fdebug_type_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_floop_report_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_fno_operator_names);
   // AltiVec language extensions aren't relevant for assembling.
   if (!isa<PreprocessJobAction>(JA) || 
@@ -3620,6 +3696,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace);
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_instantiation_report_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -4286,6 +4364,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fno_spell_checking))
     CmdArgs.push_back("-fno-spell-checking");
 
+  if (Arg *A = Args.getLastArg(options::OPT_ftypo_correction_time_budget_EQ)) {
+    CmdArgs.push_back("-ftypo-correction-time-budget");
+    CmdArgs.push_back(A->getValue());
+  }
+
 
   // -fno-asm-blocks is default.
   if (Args.hasFlag(options::OPT_fasm_blocks, options::OPT_fno_asm_blocks,
@@ -4411,14 +4494,31 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       (*it)->render(Args, CmdArgs);
   }
 
+  // With -fparallel-codegen, the code for the object is generated in parts,
+  // which are then combined by a relocatable link.
+  ArgStringList CodeGenParts;
+  unsigned NumCodeGenParts =
+      getParallelCodeGenParts(getToolChain(), Args, Output);
+  for (unsigned I = 0; NumCodeGenParts > 1 && I != NumCodeGenParts; ++I) {
+    const char *Part = C.getArgs().MakeArgString(D.GetTemporaryPath(
+        llvm::sys::path::stem(Output.getFilename()), "o"));
+    C.addTempFile(Part);
+    CodeGenParts.push_back(Part);
+  }
+
   if (Output.getType() == types::TY_Dependencies) {
     // Handled with other dependency code.
   } else if (Output.isFilename()) {
     CmdArgs.push_back("-o");
-    CmdArgs.push_back(Output.getFilename());
+    CmdArgs.push_back(CodeGenParts.empty() ? Output.getFilename()
+                                           : CodeGenParts[0]);
   } else {
     assert(Output.isNothing() && "Invalid output.");
   }
+  for (unsigned I = 1, E = CodeGenParts.size(); I < E; ++I) {
+    CmdArgs.push_back("-parallel-codegen-output");
+    CmdArgs.push_back(CodeGenParts[I]);
+  }
 
   for (const auto &II : Inputs) {
     addDashXForInput(Args, II, CmdArgs);
@@ -4472,10 +4572,22 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
         getCLFallback()->GetCommand(C, JA, Output, Inputs, Args, LinkingOutput);
     C.addCommand(llvm::make_unique<FallbackCommand>(JA, *this, Exec, CmdArgs,
                                                     std::move(CLCommand)));
+  } else if (shouldRunCC1InProcess(C, Args, CmdArgs)) {
+    C.addCommand(llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs,
+                                               D.CC1Main));
   } else {
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs));
   }
 
+  if (!CodeGenParts.empty()) {
+    ArgStringList LinkArgs;
+    LinkArgs.push_back("-r");
+    LinkArgs.push_back("-o");
+    LinkArgs.push_back(Output.getFilename());
+    LinkArgs.append(CodeGenParts.begin(), CodeGenParts.end());
+    const char *Linker = Args.MakeArgString(getToolChain().GetLinkerPath());
+    C.addCommand(llvm::make_unique<Command>(JA, *this, Linker, LinkArgs));
+  }
 
   // Handle the debug info splitting at object creation time if we're
   // creating an object.
@@ -8,7 +8,9 @@
 //===----------------------------------------------------------------------===//
 //
 //  This file defines the ChainedIncludesSource class, which converts headers
-//  to chained PCHs in memory, mainly used for testing.
+//  to chained PCHs in memory, mainly used for testing. The chained PCHs can
+//  optionally be cached on disk, so that only the headers from the first
+//  changed one onwards need to be reparsed.
 //
 //===----------------------------------------------------------------------===//
 
@@ -20,7 +22,11 @@
 #include "clang/Parse/ParseAST.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 using namespace clang;
 
@@ -76,18 +82,20 @@ static ASTReader *
 createASTReader(CompilerInstance &CI, StringRef pchFile,
                 SmallVectorImpl<std::unique_ptr<llvm::MemoryBuffer>> &MemBufs,
                 SmallVectorImpl<std::string> &bufNames,
-                ASTDeserializationListener *deserialListener = nullptr) {
+                ASTDeserializationListener *deserialListener = nullptr,
+                bool DisableValidation = true,
+                unsigned ClientLoadCapabilities = ASTReader::ARR_None) {
   Preprocessor &PP = CI.getPreprocessor();
   std::unique_ptr<ASTReader> Reader;
   Reader.reset(new ASTReader(PP, CI.getASTContext(), /*isysroot=*/"",
-                             /*DisableValidation=*/true));
+                             DisableValidation));
   for (unsigned ti = 0; ti < bufNames.size(); ++ti) {
     StringRef sr(bufNames[ti]);
     Reader->addInMemoryBuffer(sr, std::move(MemBufs[ti]));
   }
   Reader->setDeserializationListener(deserialListener);
   switch (Reader->ReadAST(pchFile, serialization::MK_PCH, SourceLocation(),
-                          ASTReader::ARR_None)) {
+                          ClientLoadCapabilities)) {
   case ASTReader::Success:
     // Set the predefines buffer as suggested by the PCH reader.
     PP.setPredefines(Reader->getSuggestedPredefines());
@@ -104,6 +112,96 @@ createASTReader(CompilerInstance &CI, StringRef pchFile,
   return nullptr;
 }
 
+/// \brief Compute the path of the on-disk cache entry for the PCH of the
+/// \p Index'th chained include.
+///
+/// The name depends on the configuration of the compilation and on all the
+/// headers up to and including this one, so that each prefix of the chain
+/// has its own entry.
+static std::string getChainedIncludeCachePath(CompilerInstance &CI,
+                                              ArrayRef<std::string> Includes,
+                                              unsigned Index) {
+  llvm::hash_code Code = llvm::hash_value(CI.getInvocation().getModuleHash());
+  for (unsigned I = 0; I <= Index; ++I)
+    Code = llvm::hash_combine(Code, Includes[I]);
+
+  SmallString<128> Path(CI.getPreprocessorOpts().ChainedIncludesCachePath);
+  llvm::sys::path::append(Path, llvm::sys::path::filename(Includes[Index]));
+  Path += "-";
+  Path += llvm::APInt(64, size_t(Code)).toString(36, /*Signed=*/false);
+  Path += ".pch";
+  return Path.str();
+}
+
+/// \brief Write the PCH for a chained include into the on-disk cache.
+///
+/// Failure to write the cache is not an error; the PCH will simply be
+/// rebuilt next time.
+static void writeChainedIncludeCache(StringRef Path, StringRef Contents) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return;
+
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath.str(), FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath.str());
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath.str(), Path))
+    llvm::sys::fs::remove(TempPath.str());
+}
+
+/// \brief Create the compiler instance that builds the PCH of one chained
+/// include, with a fresh preprocessor and AST context.
+static std::unique_ptr<CompilerInstance>
+createChainedIncludeInstance(CompilerInstance &CI,
+                             const FrontendInputFile &InputFile) {
+  std::unique_ptr<CompilerInvocation> CInvok;
+  CInvok.reset(new CompilerInvocation(CI.getInvocation()));
+  
+  CInvok->getPreprocessorOpts().ChainedIncludes.clear();
+  CInvok->getPreprocessorOpts().ChainedIncludesCachePath.clear();
+  CInvok->getPreprocessorOpts().ImplicitPCHInclude.clear();
+  CInvok->getPreprocessorOpts().ImplicitPTHInclude.clear();
+  CInvok->getPreprocessorOpts().DisablePCHValidation = true;
+  CInvok->getPreprocessorOpts().Includes.clear();
+  CInvok->getPreprocessorOpts().MacroIncludes.clear();
+  CInvok->getPreprocessorOpts().Macros.clear();
+  
+  CInvok->getFrontendOpts().Inputs.clear();
+  CInvok->getFrontendOpts().Inputs.push_back(InputFile);
+
+  TextDiagnosticPrinter *DiagClient =
+    new TextDiagnosticPrinter(llvm::errs(), new DiagnosticOptions());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(DiagID, &CI.getDiagnosticOpts(), DiagClient));
+
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  Clang->setInvocation(CInvok.release());
+  Clang->setDiagnostics(Diags.get());
+  Clang->setTarget(TargetInfo::CreateTargetInfo(
+      Clang->getDiagnostics(), Clang->getInvocation().TargetOpts));
+  Clang->createFileManager();
+  Clang->createSourceManager(Clang->getFileManager());
+  Clang->createPreprocessor(TU_Prefix);
+  Clang->getDiagnosticClient().BeginSourceFile(Clang->getLangOpts(),
+                                               &Clang->getPreprocessor());
+  Clang->createASTContext();
+  return Clang;
+}
+
 ChainedIncludesSource::~ChainedIncludesSource() {
   for (unsigned i = 0, e = CIs.size(); i != e; ++i)
     delete CIs[i];
@@ -121,40 +219,74 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
   SmallVector<std::unique_ptr<llvm::MemoryBuffer>, 4> SerialBufs;
   SmallVector<std::string, 4> serialBufNames;
 
+  // Whether cached PCHs may be used for the remaining includes. Once one
+  // include in the chain has been rebuilt, every PCH after it depends on the
+  // new one and has to be rebuilt, too.
+  bool CacheEnabled =
+      !CI.getPreprocessorOpts().ChainedIncludesCachePath.empty();
+  bool UseCache = CacheEnabled;
+
   for (unsigned i = 0, e = includes.size(); i != e; ++i) {
     bool firstInclude = (i == 0);
-    std::unique_ptr<CompilerInvocation> CInvok;
-    CInvok.reset(new CompilerInvocation(CI.getInvocation()));
-    
-    CInvok->getPreprocessorOpts().ChainedIncludes.clear();
-    CInvok->getPreprocessorOpts().ImplicitPCHInclude.clear();
-    CInvok->getPreprocessorOpts().ImplicitPTHInclude.clear();
-    CInvok->getPreprocessorOpts().DisablePCHValidation = true;
-    CInvok->getPreprocessorOpts().Includes.clear();
-    CInvok->getPreprocessorOpts().MacroIncludes.clear();
-    CInvok->getPreprocessorOpts().Macros.clear();
-    
-    CInvok->getFrontendOpts().Inputs.clear();
+    if (!firstInclude) {
+      std::string pchName = includes[i-1];
+      llvm::raw_string_ostream os(pchName);
+      os << ".pch" << i-1;
+      serialBufNames.push_back(os.str());
+    }
+
     FrontendInputFile InputFile(includes[i], IK);
-    CInvok->getFrontendOpts().Inputs.push_back(InputFile);
-
-    TextDiagnosticPrinter *DiagClient =
-      new TextDiagnosticPrinter(llvm::errs(), new DiagnosticOptions());
-    IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
-    IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
-        new DiagnosticsEngine(DiagID, &CI.getDiagnosticOpts(), DiagClient));
-
-    std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
-    Clang->setInvocation(CInvok.release());
-    Clang->setDiagnostics(Diags.get());
-    Clang->setTarget(TargetInfo::CreateTargetInfo(
-        Clang->getDiagnostics(), Clang->getInvocation().TargetOpts));
-    Clang->createFileManager();
-    Clang->createSourceManager(Clang->getFileManager());
-    Clang->createPreprocessor(TU_Prefix);
-    Clang->getDiagnosticClient().BeginSourceFile(Clang->getLangOpts(),
-                                                 &Clang->getPreprocessor());
-    Clang->createASTContext();
+    std::unique_ptr<CompilerInstance> Clang =
+        createChainedIncludeInstance(CI, InputFile);
+
+    std::string CachePath;
+    if (CacheEnabled)
+      CachePath = getChainedIncludeCachePath(CI, includes, i);
+
+    if (UseCache) {
+      // If this include and everything before it are unchanged since the
+      // cached PCH was built, use it rather than parsing the header again.
+      // The reader validates the input files of the whole chain so far.
+      llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Cached =
+          llvm::MemoryBuffer::getFile(CachePath);
+      if (Cached) {
+        SmallVector<std::unique_ptr<llvm::MemoryBuffer>, 4> Bufs;
+        for (auto &SB : SerialBufs)
+          Bufs.push_back(llvm::MemoryBuffer::getMemBuffer(SB->getBuffer()));
+        Bufs.push_back(
+            llvm::MemoryBuffer::getMemBuffer((*Cached)->getBuffer()));
+        SmallVector<std::string, 4> BufNames(serialBufNames.begin(),
+                                             serialBufNames.end());
+        std::string pchName = includes[i];
+        llvm::raw_string_ostream os(pchName);
+        os << ".pch" << i;
+        BufNames.push_back(os.str());
+
+        IntrusiveRefCntPtr<ASTReader> Reader;
+        Reader = createASTReader(
+            *Clang, pchName, Bufs, BufNames, /*deserialListener=*/nullptr,
+            /*DisableValidation=*/false,
+            ASTReader::ARR_Missing | ASTReader::ARR_OutOfDate |
+                ASTReader::ARR_VersionMismatch |
+                ASTReader::ARR_ConfigurationMismatch);
+        if (Reader) {
+          Clang->setModuleManager(Reader);
+          Clang->getASTContext().setExternalSource(Reader);
+          Clang->getDiagnosticClient().EndSourceFile();
+          SerialBufs.push_back(std::move(*Cached));
+          source->CIs.push_back(Clang.release());
+          continue;
+        }
+
+        // The failed read may have left entries in the source manager and
+        // the identifier table, and the source manager still points to the
+        // destroyed reader. Parse the header with a fresh instance.
+        Clang->getDiagnosticClient().EndSourceFile();
+        Clang = createChainedIncludeInstance(CI, InputFile);
+      }
+
+      UseCache = false;
+    }
 
     SmallVector<char, 256> serialAST;
     llvm::raw_svector_ostream OS(serialAST);
@@ -177,14 +309,9 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
       // allocating new ones.
       for (auto &SB : SerialBufs)
         Bufs.push_back(llvm::MemoryBuffer::getMemBuffer(SB->getBuffer()));
-      std::string pchName = includes[i-1];
-      llvm::raw_string_ostream os(pchName);
-      os << ".pch" << i-1;
-      serialBufNames.push_back(os.str());
-
       IntrusiveRefCntPtr<ASTReader> Reader;
       Reader = createASTReader(
-          *Clang, pchName, Bufs, serialBufNames,
+          *Clang, serialBufNames.back(), Bufs, serialBufNames,
           Clang->getASTConsumer().GetASTDeserializationListener());
       if (!Reader)
         return nullptr;
@@ -198,6 +325,8 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
     ParseAST(Clang->getSema());
     Clang->getDiagnosticClient().EndSourceFile();
     SerialBufs.push_back(llvm::MemoryBuffer::getMemBufferCopy(OS.str()));
+    if (!CachePath.empty() && !Clang->getDiagnostics().hasErrorOccurred())
+      writeChainedIncludeCache(CachePath, SerialBufs.back()->getBuffer());
     source->CIs.push_back(Clang.release());
   }
 
@@ -15,6 +15,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Config/config.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
@@ -31,6 +32,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationReport.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "llvm/ADT/Statistic.h"
@@ -53,7 +55,8 @@ using namespace clang;
 
 CompilerInstance::CompilerInstance(bool BuildingModule)
   : ModuleLoader(BuildingModule),
-    Invocation(new CompilerInvocation()), ModuleManager(nullptr),
+    Invocation(new CompilerInvocation()),
+    DeserializationTraceFailed(false), ModuleManager(nullptr),
     BuildGlobalModuleIndex(false), HaveFullGlobalModuleIndex(false),
     ModuleBuildFailed(false) {
 }
@@ -372,6 +375,9 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
                            /*ShowDepth=*/true, /*MSStyle=*/true);
   }
 
+  if (getFrontendOpts().TimeTrace)
+    AttachTimeTraceSourceSpans(*PP);
+
   // Load all explictly-specified module map files.
   for (const auto &Filename : getFrontendOpts().ModuleMapFiles) {
     if (auto *File = getFileManager().getFile(Filename))
@@ -388,6 +394,8 @@ void CompilerInstance::createASTContext() {
   Context = new ASTContext(getLangOpts(), PP.getSourceManager(),
                            PP.getIdentifierTable(), PP.getSelectorTable(),
                            PP.getBuiltinInfo());
+  if (!getFrontendOpts().ASTMemoryReportFile.empty())
+    Context->enableMemoryProfile();
   Context->InitBuiltinTypes(getTarget());
 }
 
@@ -518,6 +526,9 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
                                   CodeCompleteConsumer *CompletionConsumer) {
   TheSema.reset(new Sema(getPreprocessor(), getASTContext(), getASTConsumer(),
                          TUKind, CompletionConsumer));
+
+  if (!getFrontendOpts().TemplateInstantiationReportFile.empty())
+    TheSema->InstantiationReport.reset(new TemplateInstantiationReport());
 }
 
 // Output Files
@@ -555,6 +566,23 @@ void CompilerInstance::clearOutputFiles(bool EraseFiles) {
   OutputFiles.clear();
 }
 
+raw_ostream *CompilerInstance::getDeserializationTraceStream() {
+  if (DeserializationTraceStream || DeserializationTraceFailed)
+    return DeserializationTraceStream.get();
+
+  StringRef OutputFile = getPreprocessorOpts().DeserializationTraceFile;
+  std::error_code EC;
+  DeserializationTraceStream.reset(
+      new llvm::raw_fd_ostream(OutputFile, EC, llvm::sys::fs::F_Text));
+  if (EC) {
+    getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << OutputFile << EC.message();
+    DeserializationTraceStream.reset();
+    DeserializationTraceFailed = true;
+  }
+  return DeserializationTraceStream.get();
+}
+
 llvm::raw_fd_ostream *
 CompilerInstance::createDefaultOutputFile(bool Binary,
                                           StringRef InFile,
@@ -807,7 +835,10 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
     if (hasSourceManager() && !Act.isModelParsingAction())
       getSourceManager().clearIDTables();
 
-    if (Act.BeginSourceFile(*this, getFrontendOpts().Inputs[i])) {
+    const FrontendInputFile &Input = getFrontendOpts().Inputs[i];
+    TimeTraceScope Scope("Frontend",
+                         Input.isFile() ? Input.getFile() : "<buffer>");
+    if (Act.BeginSourceFile(*this, Input)) {
       Act.Execute();
       Act.EndSourceFile();
     }
@@ -859,6 +890,8 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
                               SourceLocation ImportLoc,
                               Module *Module,
                               StringRef ModuleFileName) {
+  TimeTraceScope Scope("BuildModule", Module->getFullModuleName());
+
   ModuleMap &ModMap 
     = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
     
@@ -903,6 +936,7 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   FrontendOpts.OutputFile = ModuleFileName.str();
   FrontendOpts.DisableFree = false;
   FrontendOpts.GenerateGlobalModuleIndex = false;
+  FrontendOpts.ASTMemoryReportFile.clear();
   FrontendOpts.Inputs.clear();
   InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
 
@@ -1253,12 +1287,20 @@ void CompilerInstance::createModuleManager() {
                                   /*AllowConfigurationMismatch=*/false,
                                   HSOpts.ModulesValidateSystemHeaders,
                                   getFrontendOpts().UseGlobalModuleIndex);
+    ASTDeserializationListener *DeserialListener = nullptr;
     if (hasASTConsumer()) {
-      ModuleManager->setDeserializationListener(
-        getASTConsumer().GetASTDeserializationListener());
+      DeserialListener = getASTConsumer().GetASTDeserializationListener();
+      ModuleManager->setDeserializationListener(DeserialListener);
       getASTContext().setASTMutationListener(
         getASTConsumer().GetASTMutationListener());
     }
+    if (!PPOpts.DeserializationTraceFile.empty()) {
+      if (raw_ostream *OS = getDeserializationTraceStream())
+        ModuleManager->setDeserializationListener(
+            createDeserializationTracer(*OS, DeserialListener,
+                                        /*DeletePrevious=*/false),
+            /*TakeOwnership=*/true);
+    }
     getASTContext().setExternalSource(ModuleManager);
     if (hasSema())
       ModuleManager->InitializeSema(getSema());
@@ -366,6 +366,11 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
       Opts.setDebugInfo(CodeGenOptions::LimitedDebugInfo);
   }
   Opts.DebugColumnInfo = Args.hasArg(OPT_dwarf_column_info);
+  Opts.DebugTypesSection = Args.hasArg(OPT_fdebug_types_section);
+  Opts.DebugTypeHoming = Args.hasArg(OPT_fdebug_type_homing);
+  Opts.DebugTypeHomingManifest =
+      Args.getLastArgValue(OPT_fdebug_type_homing_manifest_EQ);
+  Opts.DebugTypeReportFile = Args.getLastArgValue(OPT_fdebug_type_report_EQ);
   Opts.SplitDwarfFile = Args.getLastArgValue(OPT_split_dwarf_file);
   if (Args.hasArg(OPT_gdwarf_2))
     Opts.DwarfVersion = 2;
@@ -401,8 +406,13 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.SampleProfileFile = Args.getLastArgValue(OPT_fprofile_sample_use_EQ);
   Opts.ProfileInstrGenerate = Args.hasArg(OPT_fprofile_instr_generate);
   Opts.InstrProfileInput = Args.getLastArgValue(OPT_fprofile_instr_use_EQ);
+  Opts.InstrProfileSubsetOutput =
+      Args.getLastArgValue(OPT_fprofile_instr_subset_EQ);
+  Opts.ProfileIndirectCalls = Args.hasArg(OPT_fprofile_instr_indirect_calls);
   Opts.CoverageMapping = Args.hasArg(OPT_fcoverage_mapping);
   Opts.DumpCoverageMapping = Args.hasArg(OPT_dump_coverage_mapping);
+  Opts.CoverageMappingMainFileOnly =
+      Args.hasArg(OPT_fcoverage_mapping_main_file_only);
   Opts.AsmVerbose = Args.hasArg(OPT_masm_verbose);
   Opts.ObjCAutoRefCountExceptions = Args.hasArg(OPT_fobjc_arc_exceptions);
   Opts.CUDAIsDevice = Args.hasArg(OPT_fcuda_is_device);
@@ -424,6 +434,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
                        Args.hasArg(OPT_cl_fast_relaxed_math));
   Opts.NoZeroInitializedInBSS = Args.hasArg(OPT_mno_zero_initialized_in_bss);
   Opts.BackendOptions = Args.getAllArgValues(OPT_backend_option);
+  Opts.ParallelCodeGenOutputs =
+      Args.getAllArgValues(OPT_parallel_codegen_output);
   Opts.NumRegisterParameters = getLastArgIntValue(Args, OPT_mregparm, 0, Diags);
   Opts.NoGlobalMerge = Args.hasArg(OPT_mno_global_merge);
   Opts.NoExecStack = Args.hasArg(OPT_mno_exec_stack);
@@ -435,6 +447,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.NoDwarfDirectoryAsm = Args.hasArg(OPT_fno_dwarf_directory_asm);
   Opts.SoftFloat = Args.hasArg(OPT_msoft_float);
   Opts.StrictEnums = Args.hasArg(OPT_fstrict_enums);
+  // Cleared by CreateFromArgs if the code can't be streamed.
+  Opts.StreamingCodeGen = Args.hasArg(OPT_fstreaming_codegen);
   Opts.UnsafeFPMath = Args.hasArg(OPT_menable_unsafe_fp_math) ||
                       Args.hasArg(OPT_cl_unsafe_math_optimizations) ||
                       Args.hasArg(OPT_cl_fast_relaxed_math);
@@ -584,6 +598,11 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   if (!Opts.SampleProfileFile.empty())
     NeedLocTracking = true;
 
+  // The remarks of the loop report are matched to the loops by location.
+  Opts.LoopReportFile = Args.getLastArgValue(OPT_floop_report_EQ);
+  if (!Opts.LoopReportFile.empty())
+    NeedLocTracking = true;
+
   // If the user requested a flag that requires source locations available in
   // the backend, make sure that the backend tracks source location information.
   if (NeedLocTracking && Opts.getDebugInfo() == CodeGenOptions::NoDebugInfo)
@@ -836,6 +855,10 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
+  Opts.TimeTrace = Args.hasArg(OPT_ftime_trace);
+  Opts.TemplateInstantiationReportFile =
+      Args.getLastArgValue(OPT_ftemplate_instantiation_report_EQ);
+  Opts.ASTMemoryReportFile = Args.getLastArgValue(OPT_ast_memory_report_EQ);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
@@ -1490,6 +1513,10 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_depth, 512, Diags);
   Opts.ConstexprStepLimit =
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
+  Opts.ConstexprCacheSize =
+      getLastArgIntValue(Args, OPT_fconstexpr_cache_size, 0, Diags);
+  Opts.ConstexprInterpreter =
+      Args.hasArg(OPT_fexperimental_constexpr_interpreter);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
   Opts.NumLargeByValueCopy =
@@ -1512,6 +1539,8 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
                         || Args.hasArg(OPT_fdump_record_layouts);
   Opts.DumpVTableLayouts = Args.hasArg(OPT_fdump_vtable_layouts);
   Opts.SpellChecking = !Args.hasArg(OPT_fno_spell_checking);
+  Opts.TypoCorrectionTimeBudget =
+      getLastArgIntValue(Args, OPT_ftypo_correction_time_budget, 0, Diags);
   Opts.NoBitFieldTypeAlign = Args.hasArg(OPT_fno_bitfield_type_align);
   Opts.SinglePrecisionConstants = Args.hasArg(OPT_cl_single_precision_constant);
   Opts.FastRelaxedMath = Args.hasArg(OPT_cl_fast_relaxed_math);
@@ -1650,6 +1679,8 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
+  Opts.DeserializationTraceFile =
+      Args.getLastArgValue(OPT_trace_deserialization_EQ);
   for (arg_iterator it = Args.filtered_begin(OPT_error_on_deserialized_pch_decl),
          ie = Args.filtered_end(); it != ie; ++it) {
     const Arg *A = *it;
@@ -1695,6 +1726,7 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
     const Arg *A = *it;
     Opts.ChainedIncludes.push_back(A->getValue());
   }
+  Opts.ChainedIncludesCachePath = Args.getLastArgValue(OPT_chain_include_cache);
 
   // Include 'altivec.h' if -faltivec option present
   if (Args.hasArg(OPT_faltivec))
@@ -1793,6 +1825,40 @@ static void ParseTargetArgs(TargetOptions &Opts, ArgList &Args) {
     Opts.Triple = llvm::sys::getDefaultTargetTriple();
 }
 
+/// \brief Whether code can be generated for each function as soon as its IR is
+/// complete, with -fstreaming-codegen.
+///
+/// CodeGen shapes the IR differently for streaming, so this is decided here
+/// once, rather than when the backend is set up.
+static bool canStreamCodeGen(const CompilerInvocation &Res) {
+  const CodeGenOptions &CGOpts = Res.getCodeGenOpts();
+  const LangOptions &LangOpts = *Res.getLangOpts();
+
+  // Only object files and assembly are streamed, and only without
+  // optimization, where the functions of a module don't need to be seen
+  // together.
+  frontend::ActionKind Action = Res.getFrontendOpts().ProgramAction;
+  if ((Action != frontend::EmitAssembly && Action != frontend::EmitObj) ||
+      CGOpts.OptimizationLevel != 0 || !CGOpts.ParallelCodeGenOutputs.empty())
+    return false;
+
+  // Debug info describes the whole compile unit at the end, and the
+  // instrumentation passes rewrite the whole module, so they need all of it.
+  if (CGOpts.getDebugInfo() != CodeGenOptions::NoDebugInfo ||
+      !LangOpts.Sanitize.empty() || CGOpts.SanitizeCoverage ||
+      CGOpts.EmitGcovArcs || CGOpts.EmitGcovNotes ||
+      CGOpts.ProfileInstrGenerate || !CGOpts.SampleProfileFile.empty())
+    return false;
+
+  // The Objective-C runtimes fill in module-level data at the end, and the
+  // ARM backend reads module flags that are only added at the end.
+  llvm::Triple Triple(Res.getTargetOpts().Triple);
+  return !LangOpts.ObjC1 && Triple.getArch() != llvm::Triple::arm &&
+         Triple.getArch() != llvm::Triple::armeb &&
+         Triple.getArch() != llvm::Triple::thumb &&
+         Triple.getArch() != llvm::Triple::thumbeb;
+}
+
 bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
                                         const char *const *ArgBegin,
                                         const char *const *ArgEnd,
@@ -1847,6 +1913,8 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   ParsePreprocessorArgs(Res.getPreprocessorOpts(), *Args, FileMgr, Diags);
   ParsePreprocessorOutputArgs(Res.getPreprocessorOutputOpts(), *Args,
                               Res.getFrontendOpts().ProgramAction);
+  if (Res.getCodeGenOpts().StreamingCodeGen && !canStreamCodeGen(Res))
+    Res.getCodeGenOpts().StreamingCodeGen = false;
   return Success;
 }
 
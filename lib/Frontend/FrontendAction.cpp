@@ -10,6 +10,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTMemoryProfile.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -21,6 +22,8 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationReport.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
@@ -29,6 +32,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <system_error>
 using namespace clang;
 
@@ -62,10 +66,18 @@ public:
     if (Previous)
       Previous->TypeRead(Idx, T);
   }
+  void ReadingType(serialization::TypeIdx Idx) override {
+    if (Previous)
+      Previous->ReadingType(Idx);
+  }
   void DeclRead(serialization::DeclID ID, const Decl *D) override {
     if (Previous)
       Previous->DeclRead(ID, D);
   }
+  void ReadingDecl(serialization::DeclID ID) override {
+    if (Previous)
+      Previous->ReadingDecl(ID);
+  }
   void SelectorRead(serialization::SelectorID ID, Selector Sel) override {
     if (Previous)
       Previous->SelectorRead(ID, Sel);
@@ -94,6 +106,183 @@ public:
   }
 };
 
+/// \brief Writes a trace of the deserialized declarations and types.
+///
+/// Each line holds the tab-separated fields: "decl" or "type", the reason for
+/// deserializing (see ASTReader::DeserializationReason), the declaration kind
+/// or type class, the declaration ID or type index, the qualified name and
+/// the location of a declaration (or "-"), the module file that owns the
+/// record (or "-"), and the wall time in microseconds spent reading the
+/// record, not counting the records read while reading it or the writing of
+/// the trace (or "-" if the read wasn't seen starting).
+///
+/// Nothing is deserialized to write the trace, which would skew the times: a
+/// name is only made of the identifiers of the declaration and of the named
+/// contexts around it, and types are not printed.
+class DeserializationTracer : public DelegatingDeserializationListener {
+  raw_ostream &OS;
+  ASTReader *Reader;
+
+  /// \brief A declaration or type record that is being read.
+  struct PendingRead {
+    bool IsType;
+    uint64_t ID;
+    double Start;
+    /// \brief The time spent reading the records nested in this one, and
+    /// writing their lines.
+    double Nested;
+  };
+  SmallVector<PendingRead, 8> Pending;
+
+  static double getWallTime() {
+    return llvm::TimeRecord::getCurrentTime(/*Start=*/false).getWallTime();
+  }
+
+  StringRef getReasonName() const {
+    if (!Reader)
+      return "unknown";
+    switch (Reader->getDeserializationReason()) {
+    case ASTReader::DR_Unknown:      return "unknown";
+    case ASTReader::DR_NameLookup:   return "lookup";
+    case ASTReader::DR_LexicalDecls: return "lexical";
+    case ASTReader::DR_RedeclChain:  return "redecl";
+    case ASTReader::DR_Eager:        return "eager";
+    case ASTReader::DR_MethodPool:   return "method-pool";
+    }
+    llvm_unreachable("Invalid DeserializationReason");
+  }
+
+  /// \brief Print the name of \p D qualified by the named contexts around
+  /// it, or "-". Names that aren't identifiers, such as those of operators and
+  /// constructors, and template arguments, would need types to be printed,
+  /// so they are left out.
+  static void printName(raw_ostream &OS, const Decl *D) {
+    const NamedDecl *ND = dyn_cast<NamedDecl>(D);
+    if (!ND || !ND->getIdentifier()) {
+      OS << '-';
+      return;
+    }
+    SmallVector<const IdentifierInfo *, 4> Names;
+    Names.push_back(ND->getIdentifier());
+    for (const DeclContext *DC = D->getDeclContext(); DC;
+         DC = DC->getParent()) {
+      if (const NamedDecl *Outer = dyn_cast<NamedDecl>(DC))
+        if (const IdentifierInfo *II = Outer->getIdentifier())
+          Names.push_back(II);
+    }
+    for (unsigned I = Names.size(); I != 0; --I) {
+      OS << Names[I - 1]->getName();
+      if (I != 1)
+        OS << "::";
+    }
+  }
+
+  void printLocation(const Decl *D) {
+    SourceLocation Loc = D->getLocation();
+    if (!Reader || Loc.isInvalid()) {
+      OS << '-';
+      return;
+    }
+    PresumedLoc PLoc = Reader->getSourceManager().getPresumedLoc(
+        Reader->getSourceManager().getFileLoc(Loc));
+    if (PLoc.isInvalid()) {
+      OS << '-';
+      return;
+    }
+    OS << PLoc.getFilename() << ':' << PLoc.getLine() << ':'
+       << PLoc.getColumn();
+  }
+
+  static void printModuleFile(raw_ostream &OS, serialization::ModuleFile *M) {
+    if (M)
+      OS << M->FileName;
+    else
+      OS << '-';
+  }
+
+  void startRead(bool IsType, uint64_t ID) {
+    PendingRead Read = { IsType, ID, getWallTime(), 0 };
+    Pending.push_back(Read);
+  }
+
+  /// \brief Finish the read of the given record, which ended at \p Now.
+  /// Returns its own time, or a negative value if it wasn't seen starting.
+  double finishRead(bool IsType, uint64_t ID, double Now) {
+    unsigned I = Pending.size();
+    while (I && (Pending[I - 1].IsType != IsType || Pending[I - 1].ID != ID))
+      --I;
+    if (!I)
+      return -1;
+
+    // Reads nested in this one that never finished, because they failed, are
+    // counted as part of this one.
+    double Total = Now - Pending[I - 1].Start;
+    double Self = std::max(Total - Pending[I - 1].Nested, 0.0);
+    Pending.resize(I - 1);
+    if (!Pending.empty())
+      Pending.back().Nested += Total;
+    return Self;
+  }
+
+  /// \brief Finish the line of a record whose read ended at \p Now, and
+  /// leave the time spent writing it out of the enclosing read.
+  void finishLine(double Self, double Now) {
+    if (Self < 0)
+      OS << "\t-\n";
+    else
+      OS << '\t' << (uint64_t)(Self * 1e6) << '\n';
+    if (!Pending.empty())
+      Pending.back().Nested += getWallTime() - Now;
+  }
+
+public:
+  DeserializationTracer(raw_ostream &OS, ASTDeserializationListener *Previous,
+                        bool DeletePrevious)
+      : DelegatingDeserializationListener(Previous, DeletePrevious), OS(OS),
+        Reader(nullptr) {}
+
+  void ReaderInitialized(ASTReader *Reader) override {
+    this->Reader = Reader;
+    DelegatingDeserializationListener::ReaderInitialized(Reader);
+  }
+
+  void ReadingType(serialization::TypeIdx Idx) override {
+    startRead(/*IsType=*/true, Idx.getIndex());
+    DelegatingDeserializationListener::ReadingType(Idx);
+  }
+
+  void TypeRead(serialization::TypeIdx Idx, QualType T) override {
+    double Now = getWallTime();
+    double Self = finishRead(/*IsType=*/true, Idx.getIndex(), Now);
+    OS << "type\t" << getReasonName() << '\t' << T->getTypeClassName() << '\t'
+       << Idx.getIndex() << "\t-\t-\t";
+    printModuleFile(OS, Reader ? Reader->getOwningModuleFile(Idx) : nullptr);
+    finishLine(Self, Now);
+
+    DelegatingDeserializationListener::TypeRead(Idx, T);
+  }
+
+  void ReadingDecl(serialization::DeclID ID) override {
+    startRead(/*IsType=*/false, ID);
+    DelegatingDeserializationListener::ReadingDecl(ID);
+  }
+
+  void DeclRead(serialization::DeclID ID, const Decl *D) override {
+    double Now = getWallTime();
+    double Self = finishRead(/*IsType=*/false, ID, Now);
+    OS << "decl\t" << getReasonName() << '\t' << D->getDeclKindName() << '\t'
+       << ID << '\t';
+    printName(OS, D);
+    OS << '\t';
+    printLocation(D);
+    OS << '\t';
+    printModuleFile(OS, Reader ? Reader->getOwningModuleFile(D) : nullptr);
+    finishLine(Self, Now);
+
+    DelegatingDeserializationListener::DeclRead(ID, D);
+  }
+};
+
 /// \brief Checks deserialized declarations and emits error if a name
 /// matches one given in command-line using -error-on-deserialized-decl.
 class DeserializedDeclsChecker : public DelegatingDeserializationListener {
@@ -348,6 +537,13 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
             DeserialListener, DeleteDeserialListener);
         DeleteDeserialListener = true;
       }
+      if (!CI.getPreprocessorOpts().DeserializationTraceFile.empty()) {
+        if (raw_ostream *OS = CI.getDeserializationTraceStream()) {
+          DeserialListener = createDeserializationTracer(
+              *OS, DeserialListener, DeleteDeserialListener);
+          DeleteDeserialListener = true;
+        }
+      }
       CI.createPCHExternalASTSource(
           CI.getPreprocessorOpts().ImplicitPCHInclude,
           CI.getPreprocessorOpts().DisablePCHValidation,
@@ -452,6 +648,35 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Write the template instantiation report, now that all of the pending
+  // instantiations have been performed.
+  if (CI.hasSema() && CI.getSema().InstantiationReport) {
+    StringRef File = CI.getFrontendOpts().TemplateInstantiationReportFile;
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(File, EC, llvm::sys::fs::F_Text);
+    if (EC)
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << File << EC.message();
+    else
+      CI.getSema().InstantiationReport->write(OS);
+  }
+
+  if (CI.hasASTContext())
+    if (ASTMemoryProfile *Profile = CI.getASTContext().getMemoryProfile()) {
+      StringRef File = CI.getFrontendOpts().ASTMemoryReportFile;
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(File, EC, llvm::sys::fs::F_Text);
+      if (EC)
+        CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+            << File << EC.message();
+      else
+        Profile->write(OS);
+
+      // With -disable-free the ASTContext outlives the compilation, but the
+      // profile is global state that must not.
+      CI.getASTContext().disableMemoryProfile();
+    }
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -578,3 +803,9 @@ bool WrapperFrontendAction::hasCodeCompletionSupport() const {
 WrapperFrontendAction::WrapperFrontendAction(FrontendAction *WrappedAction)
   : WrappedAction(WrappedAction) {}
 
+ASTDeserializationListener *
+clang::createDeserializationTracer(raw_ostream &OS,
+                                   ASTDeserializationListener *Previous,
+                                   bool DeletePrevious) {
+  return new DeserializationTracer(OS, Previous, DeletePrevious);
+}
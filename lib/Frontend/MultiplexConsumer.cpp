@@ -34,7 +34,9 @@ public:
   void IdentifierRead(serialization::IdentID ID,
                       IdentifierInfo *II) override;
   void TypeRead(serialization::TypeIdx Idx, QualType T) override;
+  void ReadingType(serialization::TypeIdx Idx) override;
   void DeclRead(serialization::DeclID ID, const Decl *D) override;
+  void ReadingDecl(serialization::DeclID ID) override;
   void SelectorRead(serialization::SelectorID iD, Selector Sel) override;
   void MacroDefinitionRead(serialization::PreprocessedEntityID,
                            MacroDefinition *MD) override;
@@ -65,12 +67,24 @@ void MultiplexASTDeserializationListener::TypeRead(
     Listeners[i]->TypeRead(Idx, T);
 }
 
+void MultiplexASTDeserializationListener::ReadingType(
+    serialization::TypeIdx Idx) {
+  for (size_t i = 0, e = Listeners.size(); i != e; ++i)
+    Listeners[i]->ReadingType(Idx);
+}
+
 void MultiplexASTDeserializationListener::DeclRead(
     serialization::DeclID ID, const Decl *D) {
   for (size_t i = 0, e = Listeners.size(); i != e; ++i)
     Listeners[i]->DeclRead(ID, D);
 }
 
+void MultiplexASTDeserializationListener::ReadingDecl(
+    serialization::DeclID ID) {
+  for (size_t i = 0, e = Listeners.size(); i != e; ++i)
+    Listeners[i]->ReadingDecl(ID);
+}
+
 void MultiplexASTDeserializationListener::SelectorRead(
     serialization::SelectorID ID, Selector Sel) {
   for (size_t i = 0, e = Listeners.size(); i != e; ++i)
@@ -0,0 +1,69 @@
+//===--- TimeTraceSourceSpans.cpp - Trace time spent in each header -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Lex/Preprocessor.h"
+using namespace clang;
+
+namespace {
+/// \brief Records a "Source" time span for each file that is entered by the
+/// preprocessor other than the main file, covering the time taken to lex,
+/// parse and analyze its contents. Buffers that are not files, such as the
+/// predefines, get no span.
+class TimeTraceSourceCallback : public PPCallbacks {
+  SourceManager &SM;
+
+  /// \brief For each file that has been entered but not exited, including
+  /// the main file, whether a span was opened for it.
+  SmallVector<bool, 16> IncludeStack;
+
+public:
+  explicit TimeTraceSourceCallback(const Preprocessor &PP)
+    : SM(PP.getSourceManager()) {}
+
+  ~TimeTraceSourceCallback() {
+    for (bool Opened : IncludeStack)
+      if (Opened)
+        timeTraceProfilerEnd();
+  }
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override;
+};
+}
+
+void clang::AttachTimeTraceSourceSpans(Preprocessor &PP) {
+  PP.addPPCallbacks(llvm::make_unique<TimeTraceSourceCallback>(PP));
+}
+
+void TimeTraceSourceCallback::FileChanged(SourceLocation Loc,
+                                          FileChangeReason Reason,
+                                          SrcMgr::CharacteristicKind FileType,
+                                          FileID PrevFID) {
+  if (Reason == PPCallbacks::EnterFile) {
+    // The main file is covered by the "Frontend" span of the action.
+    bool Open = !IncludeStack.empty() &&
+                SM.getFileEntryForID(SM.getFileID(Loc));
+    IncludeStack.push_back(Open);
+    if (!Open)
+      return;
+
+    PresumedLoc UserLoc = SM.getPresumedLoc(Loc);
+    timeTraceProfilerBegin("Source",
+                           UserLoc.isValid() ? UserLoc.getFilename() : "");
+  } else if (Reason == PPCallbacks::ExitFile) {
+    if (IncludeStack.empty())
+      return;
+    if (IncludeStack.pop_back_val())
+      timeTraceProfilerEnd();
+  }
+}
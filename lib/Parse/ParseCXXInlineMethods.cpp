@@ -523,9 +523,13 @@ void Parser::ParseLexedMethodDef(LexedMethod &LM) {
 
   ParseFunctionStatementBody(LM.D, FnScope);
 
-  // Clear the late-template-parsed bit if we set it before.
-  if (LM.D)
-    LM.D->getAsFunction()->setLateTemplateParsed(false);
+  // Clear the late-template-parsed bit if we set it before, unless the body
+  // was skipped and its tokens kept to be parsed on instantiation.
+  if (LM.D) {
+    FunctionDecl *FD = LM.D->getAsFunction();
+    if (!Actions.LateParsedTemplateMap.count(FD))
+      FD->setLateTemplateParsed(false);
+  }
 
   if (Tok.getLocation() != origLoc) {
     // Due to parsing error, we either went over the cached tokens or
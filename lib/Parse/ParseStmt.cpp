@@ -1843,10 +1843,23 @@ Decl *Parser::ParseFunctionStatementBody(Decl *Decl, ParseScope &BodyScope) {
   assert(Tok.is(tok::l_brace));
   SourceLocation LBraceLoc = Tok.getLocation();
 
-  if (SkipFunctionBodies && (!Decl || Actions.canSkipFunctionBody(Decl)) &&
-      trySkippingFunctionBody()) {
-    BodyScope.Exit();
-    return Actions.ActOnSkippedFunctionBody(Decl);
+  if (SkipFunctionBodies && (!Decl || Actions.canSkipFunctionBody(Decl))) {
+    // Keep the tokens of a skipped template body if the consumer wants it
+    // parsed on demand, when the template is instantiated.
+    if (Decl && !PP.isCodeCompletionEnabled() &&
+        Actions.canDelaySkippedFunctionBody(Decl)) {
+      CachedTokens Toks;
+      LexTemplateFunctionForLateParsing(Toks);
+      BodyScope.Exit();
+      Actions.ActOnSkippedFunctionBody(Decl);
+      Actions.MarkAsLateParsedTemplate(Decl->getAsFunction(), Decl, Toks);
+      return Decl;
+    }
+
+    if (trySkippingFunctionBody()) {
+      BodyScope.Exit();
+      return Actions.ActOnSkippedFunctionBody(Decl);
+    }
   }
 
   PrettyDeclStackTraceEntry CrashInfo(Actions, Decl, LBraceLoc,
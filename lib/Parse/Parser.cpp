@@ -547,8 +547,9 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
     return false;
 
   case tok::eof:
-    // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    // Late template parsing can begin. Skipped template bodies whose tokens
+    // were kept are parsed the same way.
+    if (getLangOpts().DelayedTemplateParsing || SkipFunctionBodies)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
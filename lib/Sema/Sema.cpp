@@ -32,11 +32,14 @@
 #include "clang/Sema/ExternalSemaSource.h"
 #include "clang/Sema/MultiplexExternalSemaSource.h"
 #include "clang/Sema/ObjCMethodList.h"
+#include "clang/Sema/Overload.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/ScopeInfo.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateInstantiationReport.h"
+#include "clang/Sema/TypoCorrectionIndex.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
@@ -98,11 +101,13 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     MSAsmLabelNameCounter(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0),
+    NumSFINAEErrors(0), NumEnableIfChecks(0), NumDeductionsAvoided(0),
+    NumFailedDeductions(0), FailedDeductionTime(0), NumConversionCacheHits(0),
+    NumConversionCacheMisses(0), ConversionCacheMissTime(0),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(nullptr), DisableTypoCorrection(false),
-    TyposCorrected(0), AnalysisWarnings(*this),
+    TyposCorrected(0), TypoCorrectionTime(0), AnalysisWarnings(*this),
     VarDataSharingAttributesStack(nullptr), CurScope(nullptr),
     Ident_super(nullptr), Ident___float128(nullptr)
 {
@@ -304,6 +309,24 @@ void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
 
+  // Estimate the time saved by overload resolution from the average cost of
+  // the work it avoided.
+  uint64_t DeductionTimeSaved = 0, ConversionTimeSaved = 0;
+  if (NumFailedDeductions)
+    DeductionTimeSaved =
+        FailedDeductionTime * NumDeductionsAvoided / NumFailedDeductions;
+  if (NumConversionCacheMisses)
+    ConversionTimeSaved = ConversionCacheMissTime * NumConversionCacheHits /
+                          NumConversionCacheMisses;
+  llvm::errs() << NumDeductionsAvoided
+               << " template argument deductions avoided (~"
+               << DeductionTimeSaved << "us saved), " << NumFailedDeductions
+               << " failed (" << FailedDeductionTime << "us).\n";
+  llvm::errs() << NumConversionCacheHits << " conversion cache hits (~"
+               << ConversionTimeSaved << "us saved), "
+               << NumConversionCacheMisses << " misses ("
+               << ConversionCacheMissTime << "us).\n";
+
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
 }
@@ -10399,12 +10399,34 @@ bool Sema::canSkipFunctionBody(Decl *D) {
   // rest of the file.
   // We cannot skip the body of a function with an undeduced return type,
   // because any callers of that function need to know the type.
+  // A skipped template body that was kept so that it can be parsed on demand
+  // is being parsed now.
   if (const FunctionDecl *FD = D->getAsFunction())
-    if (FD->isConstexpr() || FD->getReturnType()->isUndeducedType())
+    if (FD->isConstexpr() || FD->getReturnType()->isUndeducedType() ||
+        (FD->isLateTemplateParsed() && FD->hasSkippedBody()))
       return false;
   return Consumer.shouldSkipFunctionBody(D);
 }
 
+bool Sema::canDelaySkippedFunctionBody(Decl *D) {
+  FunctionDecl *FD = D->getAsFunction();
+  if (!FD || !FD->isDependentContext() || FD->isLateTemplateParsed())
+    return false;
+
+  // The late template parser starts from the body, and would lose the
+  // member initializers of a constructor.
+  if (isa<CXXConstructorDecl>(FD))
+    return false;
+
+  // The late template parser can only reenter namespace and class scopes.
+  for (DeclContext *DC = FD->getLexicalParent(); DC;
+       DC = DC->getLexicalParent())
+    if (DC->isFunctionOrMethod())
+      return false;
+
+  return Consumer.shouldDelaySkippedTemplateBody(D);
+}
+
 Decl *Sema::ActOnSkippedFunctionBody(Decl *Decl) {
   if (FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Decl))
     FD->setHasSkippedBody();
@@ -12922,6 +12944,12 @@ void Sema::ActOnFields(Scope *S, SourceLocation RecLoc, Decl *EnclosingDecl,
     if (!Completed)
       Record->completeDefinition();
 
+    // The cached conversions may depend on this class through a conversion
+    // function's result, a pointee or a base, and were computed while it was
+    // incomplete.
+    if (ConversionCache)
+      ConversionCache->clear();
+
     if (Record->hasAttrs()) {
       CheckAlignasUnderalignment(Record);
 
@@ -33,6 +33,7 @@
 #include "clang/Sema/SemaInternal.h"
 #include "clang/Sema/TemplateDeduction.h"
 #include "clang/Sema/TypoCorrection.h"
+#include "clang/Sema/TypoCorrectionIndex.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -41,6 +42,7 @@
 #include "llvm/ADT/edit_distance.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <limits>
 #include <list>
@@ -3433,7 +3435,7 @@ void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
 
   // Compute an upper bound on the allowable edit distance, so that the
   // edit-distance algorithm can short-circuit.
-  unsigned UpperBound = (TypoStr.size() + 2) / 3 + 1;
+  unsigned UpperBound = getMaxEditDistance(TypoStr) + 1;
   unsigned ED = TypoStr.edit_distance(Name, true, UpperBound);
   if (ED >= UpperBound) return;
 
@@ -3515,11 +3517,35 @@ void TypoCorrectionConsumer::addNamespaces(
   }
 }
 
+namespace {
+/// \brief Adds the time spent in its scope to a running total, in
+/// microseconds.
+class TypoCorrectionTimer {
+  uint64_t &Total;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  explicit TypoCorrectionTimer(uint64_t &Total)
+      : Total(Total), Start(std::chrono::steady_clock::now()) {}
+  ~TypoCorrectionTimer() {
+    Total += std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - Start).count();
+  }
+};
+}
+
 const TypoCorrection &TypoCorrectionConsumer::getNextCorrection() {
   if (++CurrentTCIndex < ValidatedCorrections.size())
     return ValidatedCorrections[CurrentTCIndex];
 
   CurrentTCIndex = ValidatedCorrections.size();
+
+  // Validating the candidates, which looks each of them up, counts against
+  // the time budget for typo correction too.
+  if (!SemaRef.hasTypoCorrectionTimeLeft())
+    return ValidatedCorrections[0];  // The empty correction.
+  TypoCorrectionTimer Timer(SemaRef.TypoCorrectionTime);
+
   while (!CorrectionResults.empty()) {
     auto DI = CorrectionResults.begin();
     if (DI->second.empty()) {
@@ -4052,6 +4078,12 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   if (!ActiveTemplateInstantiations.empty())
     return nullptr;
 
+  // Stop looking for corrections once the translation unit has used up its
+  // time budget for them.
+  if (!hasTypoCorrectionTimeLeft())
+    return nullptr;
+  TypoCorrectionTimer Timer(TypoCorrectionTime);
+
   // Don't try to correct 'super'.
   if (S && S->isInObjcMethodScope() && Typo == getSuperIdentifier())
     return nullptr;
@@ -4152,25 +4184,22 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
       (IsUnqualifiedLookup || (SS && SS->isSet()));
 
   if (IsUnqualifiedLookup || SearchNamespaces) {
-    // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    for (const auto &I : Context.Idents)
-      Consumer->FoundName(I.getKey());
-
-    // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    if (IdentifierInfoLookup *External
-                            = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer->FoundName(Name);
-      } while (true);
-    }
+    // For unqualified lookup, look through the names that we have seen in
+    // this translation unit and in external identifier sources, skipping
+    // those that the index shows are too far from the typo.
+    if (!TypoIndex)
+      TypoIndex.reset(new TypoCorrectionIndex(Context.Idents));
+    ExternalASTSource *ExternalAST = Context.getExternalSource();
+    TypoIndex->update(Context.Idents.getExternalIdentifierLookup(),
+                      ExternalAST ? ExternalAST->getGeneration() : 0);
+
+    SmallVector<StringRef, 64> Candidates;
+    TypoIndex->lookup(Typo->getName(),
+                      TypoCorrectionConsumer::getMaxEditDistance(
+                          Typo->getName()),
+                      Candidates);
+    for (StringRef Name : Candidates)
+      Consumer->FoundName(Name);
   }
 
   AddKeywordsToConsumer(*this, *Consumer, S, CCCRef, SS && SS->isNotEmpty());
@@ -33,6 +33,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 
 using namespace clang;
@@ -4636,18 +4637,14 @@ TryListConversion(Sema &S, InitListExpr *From, QualType ToType,
   return Result;
 }
 
-/// TryCopyInitialization - Try to copy-initialize a value of type
-/// ToType from the expression From. Return the implicit conversion
-/// sequence required to pass this argument, which may be a bad
-/// conversion sequence (meaning that the argument cannot be passed to
-/// a parameter of this type). If @p SuppressUserConversions, then we
-/// do not permit any user-defined conversion sequences.
+/// ComputeCopyInitialization - Compute the implicit conversion sequence
+/// for TryCopyInitialization, without consulting the cache.
 static ImplicitConversionSequence
-TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
-                      bool SuppressUserConversions,
-                      bool InOverloadResolution,
-                      bool AllowObjCWritebackConversion,
-                      bool AllowExplicit) {
+ComputeCopyInitialization(Sema &S, Expr *From, QualType ToType,
+                          bool SuppressUserConversions,
+                          bool InOverloadResolution,
+                          bool AllowObjCWritebackConversion,
+                          bool AllowExplicit) {
   if (InitListExpr *FromInitList = dyn_cast<InitListExpr>(From))
     return TryListConversion(S, FromInitList, ToType, SuppressUserConversions,
                              InOverloadResolution,AllowObjCWritebackConversion);
@@ -4667,6 +4664,101 @@ TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
                                /*AllowObjCConversionOnExplicit=*/false);
 }
 
+/// \brief Determine whether the implicit conversion sequence from \p From to
+/// \p ToType depends only on their types, so that it can be cached.
+static bool isCacheableConversion(Sema &S, Expr *From, QualType ToType) {
+  const LangOptions &LangOpts = S.getLangOpts();
+  if (!LangOpts.CPlusPlus || LangOpts.ObjC1 || LangOpts.CUDA ||
+      LangOpts.Modules || S.isSFINAEContext())
+    return false;
+
+  if (isa<InitListExpr>(From) || From->isTypeDependent() ||
+      From->getObjectKind() != OK_Ordinary)
+    return false;
+
+  // Arguments of other types may convert differently depending on their
+  // value, such as null pointer constants, or on what they name, such as
+  // overloaded functions. The conversions of an incomplete class, or to
+  // one, change once the class is completed. Conversions that depend on
+  // other classes are dropped from the cache whenever a class is completed.
+  const CXXRecordDecl *FromRD = From->getType()->getAsCXXRecordDecl();
+  if (!FromRD || !(FromRD = FromRD->getDefinition()) ||
+      FromRD->isBeingDefined())
+    return false;
+
+  QualType T = ToType.getNonReferenceType();
+  if (T->isDependentType())
+    return false;
+  if (const CXXRecordDecl *ToRD = T->getAsCXXRecordDecl())
+    if (!(ToRD = ToRD->getDefinition()) || ToRD->isBeingDefined())
+      return false;
+  return true;
+}
+
+/// TryCopyInitialization - Try to copy-initialize a value of type
+/// ToType from the expression From. Return the implicit conversion
+/// sequence required to pass this argument, which may be a bad
+/// conversion sequence (meaning that the argument cannot be passed to
+/// a parameter of this type). If @p SuppressUserConversions, then we
+/// do not permit any user-defined conversion sequences.
+static ImplicitConversionSequence
+TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
+                      bool SuppressUserConversions,
+                      bool InOverloadResolution,
+                      bool AllowObjCWritebackConversion,
+                      bool AllowExplicit) {
+  if (!isCacheableConversion(S, From, ToType))
+    return ComputeCopyInitialization(S, From, ToType, SuppressUserConversions,
+                                     InOverloadResolution,
+                                     AllowObjCWritebackConversion,
+                                     AllowExplicit);
+
+  unsigned Flags = From->getValueKind()
+                   << ConversionSequenceCache::ValueKindShift;
+  if (SuppressUserConversions)
+    Flags |= ConversionSequenceCache::SuppressUserConversions;
+  if (InOverloadResolution)
+    Flags |= ConversionSequenceCache::InOverloadResolution;
+  if (AllowObjCWritebackConversion)
+    Flags |= ConversionSequenceCache::AllowObjCWritebackConversion;
+  if (AllowExplicit)
+    Flags |= ConversionSequenceCache::AllowExplicit;
+  ConversionSequenceCache::Key Key =
+      ConversionSequenceCache::getKey(From->getType(), ToType, Flags);
+
+  if (!S.ConversionCache)
+    S.ConversionCache.reset(new ConversionSequenceCache);
+  if (const ImplicitConversionSequence *Cached = S.ConversionCache->find(Key)) {
+    ++S.NumConversionCacheHits;
+    ImplicitConversionSequence ICS = *Cached;
+    if (ICS.isBad() && ICS.Bad.FromExpr)
+      ICS.Bad.setFromExpr(From);
+    return ICS;
+  }
+
+  ++S.NumConversionCacheMisses;
+  unsigned NumEnableIfChecks = S.NumEnableIfChecks;
+  std::chrono::steady_clock::time_point Start;
+  if (S.CollectStats)
+    Start = std::chrono::steady_clock::now();
+
+  ImplicitConversionSequence ICS =
+      ComputeCopyInitialization(S, From, ToType, SuppressUserConversions,
+                                InOverloadResolution,
+                                AllowObjCWritebackConversion, AllowExplicit);
+
+  if (S.CollectStats)
+    S.ConversionCacheMissTime +=
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - Start).count();
+
+  // A conversion that checked an enable_if condition depends on the value
+  // of the argument.
+  if (S.NumEnableIfChecks == NumEnableIfChecks)
+    S.ConversionCache->insert(Key, ICS);
+  return ICS;
+}
+
 static bool TryCopyInitialization(const CanQualType FromQTy,
                                   const CanQualType ToQTy,
                                   Sema &S,
@@ -5783,6 +5875,7 @@ EnableIfAttr *Sema::CheckEnableIf(FunctionDecl *Function, ArrayRef<Expr *> Args,
   if (Attrs.begin() == E)
     return nullptr;
   std::reverse(Attrs.begin(), E);
+  ++NumEnableIfChecks;
 
   SFINAETrap Trap(*this);
 
@@ -6080,6 +6173,117 @@ Sema::AddMethodTemplateCandidate(FunctionTemplateDecl *MethodTmpl,
                      CandidateSet, SuppressUserConversions);
 }
 
+/// \brief Check whether a function template whose templated declaration is
+/// \p Function can be called with \p NumArgs arguments, as template argument
+/// deduction would.
+static Sema::TemplateDeductionResult
+CheckDeductionArity(FunctionDecl *Function, unsigned NumArgs) {
+  if (NumArgs < Function->getMinRequiredArguments())
+    return Sema::TDK_TooFewArguments;
+  if (NumArgs > Function->getNumParams()) {
+    const FunctionProtoType *Proto =
+        Function->getType()->getAs<FunctionProtoType>();
+    if (!Proto->isTemplateVariadic() && !Proto->isVariadic())
+      return Sema::TDK_TooManyArguments;
+  }
+  return Sema::TDK_Success;
+}
+
+/// \brief Determine whether \p RD is a specialization of \p Template, or is
+/// derived from one, or might be.
+static bool isOrDerivesFromSpecializationOf(const CXXRecordDecl *RD,
+                                            ClassTemplateDecl *Template) {
+  Template = Template->getCanonicalDecl();
+  llvm::SmallPtrSet<const CXXRecordDecl *, 8> Visited;
+  SmallVector<const CXXRecordDecl *, 8> ToVisit(1, RD);
+  while (!ToVisit.empty()) {
+    const CXXRecordDecl *Next = ToVisit.pop_back_val();
+    if (!Visited.insert(Next).second)
+      continue;
+
+    if (const ClassTemplateSpecializationDecl *Spec =
+            dyn_cast<ClassTemplateSpecializationDecl>(Next))
+      if (Spec->getSpecializedTemplate()->getCanonicalDecl() == Template)
+        return true;
+
+    for (const auto &Base : Next->bases()) {
+      const CXXRecordDecl *BaseRD = Base.getType()->getAsCXXRecordDecl();
+      if (!BaseRD || !(BaseRD = BaseRD->getDefinition()))
+        return true;
+      ToVisit.push_back(BaseRD);
+    }
+  }
+  return false;
+}
+
+/// \brief Determine whether template argument deduction for a call to
+/// \p FunctionTemplate with the arguments \p Args is certain to fail,
+/// without performing it.
+///
+/// Deduction fails when a parameter of the form \c X<...T...>, where \c X is
+/// a class template and \c T a template parameter being deduced, is matched
+/// against an argument whose type is neither a specialization of \c X nor
+/// derived from one. Parameters are only inspected up to the first one whose
+/// deduction might instantiate a template or resolve an overloaded function,
+/// so skipping the deduction has no visible effect.
+static bool isDeductionCertainToFail(FunctionTemplateDecl *FunctionTemplate,
+                                     ArrayRef<Expr *> Args) {
+  FunctionDecl *Function = FunctionTemplate->getTemplatedDecl();
+  unsigned Depth = FunctionTemplate->getTemplateParameters()->getDepth();
+  unsigned NumParams = std::min<unsigned>(Args.size(),
+                                          Function->getNumParams());
+  for (unsigned I = 0; I != NumParams; ++I) {
+    QualType ParamType = Function->getParamDecl(I)->getType();
+    if (isa<PackExpansionType>(ParamType))
+      return false;
+
+    Expr *Arg = Args[I];
+    QualType ArgType = Arg->getType();
+    if (isa<InitListExpr>(Arg) || Arg->isTypeDependent() ||
+        ArgType->isPlaceholderType() || ArgType->isIncompleteArrayType())
+      return false;
+
+    // Deduction would complete the argument's type to look at its bases.
+    const CXXRecordDecl *ArgRD = ArgType->getAsCXXRecordDecl();
+    if (ArgRD) {
+      ArgRD = ArgRD->getDefinition();
+      if (!ArgRD || ArgRD->isBeingDefined())
+        return false;
+    }
+
+    const TemplateSpecializationType *Spec =
+        dyn_cast<TemplateSpecializationType>(
+            ParamType.getNonReferenceType().getCanonicalType());
+    if (!Spec)
+      continue;
+    ClassTemplateDecl *Template = dyn_cast_or_null<ClassTemplateDecl>(
+        Spec->getTemplateName().getAsTemplateDecl());
+    if (!Template)
+      continue;
+
+    // The parameter must be a deduced context: one of its template arguments
+    // is a template parameter of this function template, and none of them is
+    // a pack expansion.
+    bool Deducible = false;
+    for (unsigned A = 0, NumArgs = Spec->getNumArgs(); A != NumArgs; ++A) {
+      const TemplateArgument &TA = Spec->getArg(A);
+      if (TA.isPackExpansion())
+        return false;
+      if (TA.getKind() != TemplateArgument::Type)
+        continue;
+      if (const TemplateTypeParmType *TTP =
+              dyn_cast<TemplateTypeParmType>(TA.getAsType()))
+        Deducible |= TTP->getDepth() == Depth;
+    }
+    if (!Deducible)
+      continue;
+
+    if (!ArgRD || !isOrDerivesFromSpecializationOf(ArgRD, Template))
+      return true;
+  }
+  return false;
+}
+
 /// \brief Add a C++ function template specialization as a candidate
 /// in the candidate set, using template argument deduction to produce
 /// an appropriate function template specialization.
@@ -6103,10 +6307,48 @@ Sema::AddTemplateOverloadCandidate(FunctionTemplateDecl *FunctionTemplate,
   //   function template are combined with the set of non-template candidate
   //   functions.
   TemplateDeductionInfo Info(CandidateSet.getLocation());
+
+  // Don't deduce template arguments when deduction is certain to fail. The
+  // reason is only needed if the candidate is noted, so unless the number of
+  // arguments is wrong, it is worked out then.
+  if (!ExplicitTemplateArgs && !FunctionTemplate->isInvalidDecl()) {
+    TemplateDeductionResult Result =
+        CheckDeductionArity(FunctionTemplate->getTemplatedDecl(), Args.size());
+    if (Result || isDeductionCertainToFail(FunctionTemplate, Args)) {
+      OverloadCandidate &Candidate = CandidateSet.addCandidate();
+      Candidate.FoundDecl = FoundDecl;
+      Candidate.Function = FunctionTemplate->getTemplatedDecl();
+      Candidate.Viable = false;
+      Candidate.IsSurrogate = false;
+      Candidate.IgnoreObjectArgument = false;
+      Candidate.ExplicitCallArguments = Args.size();
+      if (Result) {
+        Candidate.FailureKind = ovl_fail_bad_deduction;
+        Candidate.DeductionFailure = MakeDeductionFailureInfo(Context, Result,
+                                                              Info);
+      } else {
+        ++NumDeductionsAvoided;
+        Candidate.FailureKind = ovl_fail_deferred_deduction;
+      }
+      return;
+    }
+  }
+
+  std::chrono::steady_clock::time_point Start;
+  if (CollectStats)
+    Start = std::chrono::steady_clock::now();
+
   FunctionDecl *Specialization = nullptr;
   if (TemplateDeductionResult Result
         = DeduceTemplateArguments(FunctionTemplate, ExplicitTemplateArgs, Args,
                                   Specialization, Info)) {
+    if (CollectStats) {
+      ++NumFailedDeductions;
+      FailedDeductionTime +=
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - Start).count();
+    }
+
     OverloadCandidate &Candidate = CandidateSet.addCandidate();
     Candidate.FoundDecl = FoundDecl;
     Candidate.Function = FunctionTemplate->getTemplatedDecl();
@@ -9257,6 +9499,9 @@ static void NoteFunctionCandidate(Sema &S, OverloadCandidate *Cand,
 
   case ovl_fail_enable_if:
     return DiagnoseFailedEnableIfAttr(S, Cand);
+
+  case ovl_fail_deferred_deduction:
+    llvm_unreachable("template argument deduction was not completed");
   }
 }
 
@@ -9491,6 +9736,26 @@ struct CompareOverloadCandidatesForDisplay {
 };
 }
 
+/// \brief Perform the template argument deduction skipped for a function
+/// template candidate, to find out why it fails.
+static void CompleteDeferredDeduction(Sema &S, OverloadCandidate *Cand,
+                                      ArrayRef<Expr *> Args,
+                                      SourceLocation Loc) {
+  FunctionTemplateDecl *FunctionTemplate =
+      Cand->Function->getDescribedFunctionTemplate();
+  TemplateDeductionInfo Info(Loc);
+  FunctionDecl *Specialization = nullptr;
+  Sema::TemplateDeductionResult Result =
+      S.DeduceTemplateArguments(FunctionTemplate, nullptr, Args,
+                                Specialization, Info);
+  assert(Result && "skipped a template argument deduction that succeeds");
+  if (!Result)
+    Result = Sema::TDK_MiscellaneousDeductionFailure;
+
+  Cand->FailureKind = ovl_fail_bad_deduction;
+  Cand->DeductionFailure = MakeDeductionFailureInfo(S.Context, Result, Info);
+}
+
 /// CompleteNonViableCandidate - Normally, overload resolution only
 /// computes up to the first. Produces the FixIt set if possible.
 static void CompleteNonViableCandidate(Sema &S, OverloadCandidate *Cand,
@@ -9590,6 +9855,8 @@ void OverloadCandidateSet::NoteCandidates(Sema &S,
     if (Cand->Viable)
       Cands.push_back(Cand);
     else if (OCD == OCD_AllCandidates) {
+      if (Cand->FailureKind == ovl_fail_deferred_deduction)
+        CompleteDeferredDeduction(S, Cand, Args, getLocation());
       CompleteNonViableCandidate(S, Cand, Args);
       if (Cand->Function || Cand->IsSurrogate)
         Cands.push_back(Cand);
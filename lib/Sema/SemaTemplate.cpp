@@ -8282,6 +8282,8 @@ void Sema::UnmarkAsLateParsedTemplate(FunctionDecl *FD) {
   if (!FD)
     return;
   FD->setLateTemplateParsed(false);
+  // The body of a template that was skipped has now been parsed.
+  FD->setHasSkippedBody(false);
 }
 
 bool Sema::IsInsideALocalClassWithinATemplateFunction() {
@@ -0,0 +1,173 @@
+//===--- TemplateInstantiationReport.cpp - Instantiation costs ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//===----------------------------------------------------------------------===//
+//
+//  This file implements TemplateInstantiationReport.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TemplateInstantiationReport.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Sema/Sema.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+static uint64_t getCurrentMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// \brief Count the statements in \p S, including \p S itself.
+static unsigned countStmts(const Stmt *S) {
+  if (!S)
+    return 0;
+  unsigned Count = 1;
+  for (Stmt::const_child_range C = S->children(); C; ++C)
+    Count += countStmts(*C);
+  return Count;
+}
+
+/// \brief Count the AST nodes in the instantiated definition of \p D, not
+/// counting those of nested classes, which are instantiated separately.
+static unsigned countNodes(const Decl *D) {
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
+    return 1 + countStmts(FD->getBody());
+
+  unsigned Count = 1;
+  if (const DeclContext *DC = dyn_cast<DeclContext>(D))
+    for (const Decl *Member : DC->decls())
+      Count += isa<CXXRecordDecl>(Member) ? 1 : countNodes(Member);
+  return Count;
+}
+
+TemplateInstantiationReport::Scope::Scope(Sema &S,
+                                          const NamedDecl *Specialization,
+                                          const NamedDecl *Pattern)
+  : Report(S.InstantiationReport.get()), S(S),
+    Specialization(Specialization), Pattern(Pattern) {
+  if (Report)
+    Report->begin(S.Context.getASTAllocatedBytes());
+}
+
+TemplateInstantiationReport::Scope::~Scope() {
+  if (!Report)
+    return;
+
+  std::string Name;
+  llvm::raw_string_ostream OS(Name);
+  Specialization->getNameForDiagnostic(OS, S.getPrintingPolicy(),
+                                       /*Qualified=*/true);
+  OS.flush();
+
+  Report->end(S.Context.getASTAllocatedBytes(), Name,
+              isa<FunctionDecl>(Specialization) ? "function" : "class",
+              Pattern->getQualifiedNameAsString(),
+              countNodes(Specialization),
+              S.ActiveTemplateInstantiations.size());
+}
+
+void TemplateInstantiationReport::begin(uint64_t Bytes) {
+  Frame F = { getCurrentMicros(), Bytes, 0, 0 };
+  Stack.push_back(F);
+}
+
+void TemplateInstantiationReport::end(uint64_t Bytes, StringRef Name,
+                                      const char *Kind, StringRef Template,
+                                      unsigned Nodes, unsigned Depth) {
+  assert(!Stack.empty() && "unbalanced template instantiation report");
+  Frame F = Stack.pop_back_val();
+  uint64_t Time = getCurrentMicros() - F.StartTime;
+  uint64_t Allocated = Bytes - F.StartBytes;
+
+  Cost &C = Specializations[Name];
+  if (!C.Count) {
+    C.Kind = Kind;
+    C.Template = Template;
+  }
+  ++C.Count;
+  C.SelfTime += Time - std::min(Time, F.ChildTime);
+  C.SelfBytes += Allocated - std::min(Allocated, F.ChildBytes);
+  C.Nodes += Nodes;
+  C.MaxDepth = std::max(C.MaxDepth, Depth);
+
+  // A specialization cannot be instantiated while it is already being
+  // instantiated, so the totals never count the same work twice.
+  C.TotalTime += Time;
+  C.TotalBytes += Allocated;
+
+  if (!Stack.empty()) {
+    Stack.back().ChildTime += Time;
+    Stack.back().ChildBytes += Allocated;
+  }
+}
+
+void TemplateInstantiationReport::write(raw_ostream &OS) const {
+  typedef std::pair<StringRef, const Cost *> Entry;
+  std::vector<Entry> Entries;
+  llvm::StringMap<Cost> Templates;
+  llvm::StringMap<unsigned> SpecializationsPerTemplate;
+  for (llvm::StringMap<Cost>::const_iterator I = Specializations.begin(),
+                                             E = Specializations.end();
+       I != E; ++I) {
+    Entries.push_back(Entry(I->getKey(), &I->getValue()));
+
+    const Cost &C = I->getValue();
+    Cost &T = Templates[C.Template];
+    T.Kind = C.Kind;
+    T.Count += C.Count;
+    T.SelfTime += C.SelfTime;
+    T.SelfBytes += C.SelfBytes;
+    T.Nodes += C.Nodes;
+    T.MaxDepth = std::max(T.MaxDepth, C.MaxDepth);
+    ++SpecializationsPerTemplate[C.Template];
+  }
+
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+    if (LHS.second->SelfTime != RHS.second->SelfTime)
+      return LHS.second->SelfTime > RHS.second->SelfTime;
+    return LHS.first < RHS.first;
+  });
+
+  OS << "# specialization\tkind\tname\ttemplate\tcount\tself-us\ttotal-us"
+        "\tself-bytes\ttotal-bytes\tnodes\tmax-depth\n";
+  for (const Entry &E : Entries) {
+    const Cost &C = *E.second;
+    OS << "specialization\t" << C.Kind << '\t' << E.first << '\t'
+       << C.Template << '\t' << C.Count << '\t' << C.SelfTime << '\t'
+       << C.TotalTime << '\t' << C.SelfBytes << '\t' << C.TotalBytes << '\t'
+       << C.Nodes << '\t' << C.MaxDepth << '\n';
+  }
+
+  Entries.clear();
+  for (llvm::StringMap<Cost>::const_iterator I = Templates.begin(),
+                                             E = Templates.end();
+       I != E; ++I)
+    Entries.push_back(Entry(I->getKey(), &I->getValue()));
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+    if (LHS.second->SelfTime != RHS.second->SelfTime)
+      return LHS.second->SelfTime > RHS.second->SelfTime;
+    return LHS.first < RHS.first;
+  });
+
+  OS << "# template\tkind\tname\tspecializations\tcount\tself-us"
+        "\tself-bytes\tnodes\tmax-depth\n";
+  for (const Entry &E : Entries) {
+    const Cost &C = *E.second;
+    OS << "template\t" << C.Kind << '\t' << E.first << '\t'
+       << SpecializationsPerTemplate.lookup(E.first) << '\t' << C.Count
+       << '\t' << C.SelfTime << '\t' << C.SelfBytes << '\t' << C.Nodes
+       << '\t' << C.MaxDepth << '\n';
+  }
+}
@@ -0,0 +1,126 @@
+//===- TypoCorrectionIndex.cpp - Typo correction candidates ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//===----------------------------------------------------------------------===//
+//
+//  This file implements TypoCorrectionIndex.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TypoCorrectionIndex.h"
+#include <algorithm>
+#include <memory>
+
+using namespace clang;
+
+/// \brief Compute the distinct bigrams of \p Name, padded with a leading and
+/// a trailing NUL, which cannot appear in an identifier.
+static void getBigrams(StringRef Name, SmallVectorImpl<unsigned> &Bigrams) {
+  unsigned char Prev = 0;
+  for (unsigned char C : Name) {
+    Bigrams.push_back(Prev << 8 | C);
+    Prev = C;
+  }
+  Bigrams.push_back(Prev << 8);
+
+  std::sort(Bigrams.begin(), Bigrams.end());
+  Bigrams.erase(std::unique(Bigrams.begin(), Bigrams.end()), Bigrams.end());
+}
+
+void TypoCorrectionIndex::addName(StringRef Name) {
+  SmallVector<unsigned, 32> Bigrams;
+  getBigrams(Name, Bigrams);
+
+  unsigned Index = Names.size();
+  Names.push_back(Name);
+  for (unsigned B : Bigrams)
+    Postings[B].push_back(Index);
+}
+
+void TypoCorrectionIndex::clear() {
+  Names.clear();
+  Postings.clear();
+  IndexedTable = false;
+  NewIdentifiers.clear();
+}
+
+TypoCorrectionIndex::TypoCorrectionIndex(IdentifierTable &Idents)
+    : Idents(Idents), IndexedTable(false), ExternalGeneration(~0U) {
+  assert(!Idents.getCreationListener() &&
+         "identifier table already has a creation listener");
+  Idents.setCreationListener(this);
+}
+
+TypoCorrectionIndex::~TypoCorrectionIndex() {
+  Idents.setCreationListener(nullptr);
+}
+
+void TypoCorrectionIndex::IdentifierCreated(IdentifierInfo &II) {
+  // The name is owned by the table, and stays valid as long as it does.
+  if (IndexedTable)
+    NewIdentifiers.push_back(II.getName());
+}
+
+void TypoCorrectionIndex::update(IdentifierInfoLookup *External,
+                                 unsigned Generation) {
+  // Loading a module may have added external identifiers; start over. The
+  // names returned by the external source remain valid as long as it does.
+  if (External && Generation != ExternalGeneration) {
+    clear();
+    std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+    while (true) {
+      StringRef Name = Iter->Next();
+      if (Name.empty())
+        break;
+      addName(Name);
+    }
+    ExternalGeneration = Generation;
+  }
+
+  // The table is only walked to build the index; after that, the new
+  // identifiers are the ones the table told us about.
+  if (!IndexedTable) {
+    for (const auto &I : Idents)
+      addName(I.getKey());
+    IndexedTable = true;
+    return;
+  }
+  for (StringRef Name : NewIdentifiers)
+    addName(Name);
+  NewIdentifiers.clear();
+}
+
+void TypoCorrectionIndex::lookup(StringRef Typo, unsigned MaxDistance,
+                                 SmallVectorImpl<StringRef> &Candidates) {
+  SmallVector<unsigned, 32> Bigrams;
+  getBigrams(Typo, Bigrams);
+
+  // Each edit destroys at most two bigrams. If the filter can't reject
+  // anything, every name is a candidate.
+  if (Bigrams.size() <= 2 * MaxDistance) {
+    Candidates.append(Names.begin(), Names.end());
+    return;
+  }
+  unsigned Threshold = Bigrams.size() - 2 * MaxDistance;
+
+  SharedBigrams.resize(Names.size());
+  for (unsigned B : Bigrams) {
+    llvm::DenseMap<unsigned, std::vector<unsigned> >::iterator P =
+        Postings.find(B);
+    if (P == Postings.end())
+      continue;
+    for (unsigned Index : P->second)
+      if (SharedBigrams[Index]++ == 0)
+        TouchedNames.push_back(Index);
+  }
+
+  for (unsigned Index : TouchedNames) {
+    if (SharedBigrams[Index] >= Threshold)
+      Candidates.push_back(Names[Index]);
+    SharedBigrams[Index] = 0;
+  }
+  TouchedNames.clear();
+}
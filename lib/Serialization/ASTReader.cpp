@@ -28,6 +28,7 @@
 #include "clang/Basic/SourceManagerInternals.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Basic/VersionTuple.h"
 #include "clang/Frontend/Utils.h"
@@ -1714,6 +1715,7 @@ namespace {
 void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
   // Note that we are loading an identifier.
   Deserializing AnIdentifier(this);
+  DeserializationReasonTracker Reason(DR_NameLookup, *this);
 
   unsigned PriorGeneration = 0;
   if (getContext().getLangOpts().Modules)
@@ -5982,6 +5984,8 @@ QualType ASTReader::GetType(TypeID ID) {
   Index -= NUM_PREDEF_TYPE_IDS;
   assert(Index < TypesLoaded.size() && "Type index out-of-range");
   if (TypesLoaded[Index].isNull()) {
+    if (DeserializationListener)
+      DeserializationListener->ReadingType(TypeIdx::fromTypeID(ID));
     TypesLoaded[Index] = readTypeRecord(Index);
     if (TypesLoaded[Index].isNull())
       return QualType();
@@ -6091,6 +6095,7 @@ void ASTReader::CompleteRedeclChain(const Decl *D) {
     return;
   }
 
+  DeserializationReasonTracker Reason(DR_RedeclChain, *this);
   const DeclContext *DC = D->getDeclContext()->getRedeclContext();
 
   // If this is a named declaration, complete it by looking it up
@@ -6178,6 +6183,16 @@ ModuleFile *ASTReader::getOwningModuleFile(const Decl *D) {
   return I->second;
 }
 
+ModuleFile *ASTReader::getOwningModuleFile(TypeIdx Idx) {
+  unsigned Index = Idx.getIndex();
+  if (Index < NUM_PREDEF_TYPE_IDS)
+    return nullptr;
+  GlobalTypeMapType::iterator I =
+      GlobalTypeMap.find(Index - NUM_PREDEF_TYPE_IDS);
+  assert(I != GlobalTypeMap.end() && "Corrupted global type map");
+  return I->second;
+}
+
 SourceLocation ASTReader::getSourceLocationForDeclID(GlobalDeclID ID) {
   if (ID < NUM_PREDEF_DECL_IDS)
     return SourceLocation();
@@ -6256,7 +6271,17 @@ Decl *ASTReader::GetDecl(DeclID ID) {
   }
 
   if (!DeclsLoaded[Index]) {
+    TimeTraceScope TimeScope("DeserializeDecl");
+    if (DeserializationListener)
+      DeserializationListener->ReadingDecl(ID);
     ReadDeclRecord(ID);
+    // Naming the declaration could deserialize more declarations within this
+    // span, so it is only identified by its kind and ID.
+    TimeScope.setDetail([&]() -> std::string {
+      if (Decl *D = DeclsLoaded[Index])
+        return (Twine(D->getDeclKindName()) + " " + Twine(ID)).str();
+      return Twine(ID).str();
+    });
     if (DeserializationListener)
       DeserializationListener->DeclRead(ID, DeclsLoaded[Index]);
   }
@@ -6368,6 +6393,8 @@ namespace {
 ExternalLoadResult ASTReader::FindExternalLexicalDecls(const DeclContext *DC,
                                          bool (*isKindWeWant)(Decl::Kind),
                                          SmallVectorImpl<Decl*> &Decls) {
+  DeserializationReasonTracker Reason(DR_LexicalDecls, *this);
+
   // There might be lexical decls in multiple modules, for the TU at
   // least. Walk all of the modules in the order they were loaded.
   FindExternalLexicalDeclsVisitor Visitor(*this, DC, isKindWeWant, Decls);
@@ -6553,6 +6580,7 @@ ASTReader::FindExternalVisibleDeclsByName(const DeclContext *DC,
     return false;
 
   Deserializing LookupResults(this);
+  DeserializationReasonTracker Reason(DR_NameLookup, *this);
 
   SmallVector<NamedDecl *, 64> Decls;
 
@@ -6677,6 +6705,7 @@ namespace {
 void ASTReader::completeVisibleDeclsMap(const DeclContext *DC) {
   if (!DC->hasExternalVisibleStorage())
     return;
+  DeserializationReasonTracker Reason(DR_NameLookup, *this);
   DeclsMap Decls;
 
   // Compute the declaration contexts we need to look into. Multiple such
@@ -6752,6 +6781,7 @@ void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
   if (!Consumer)
     return;
 
+  DeserializationReasonTracker Reason(DR_Eager, *this);
   for (unsigned I = 0, N = EagerlyDeserializedDecls.size(); I != N; ++I) {
     // Force deserialization of this decl, which will cause it to be queued for
     // passing to the consumer.
@@ -6973,6 +7003,7 @@ IdentifierInfo* ASTReader::get(const char *NameStart, const char *NameEnd) {
   // Note that we are loading an identifier.
   Deserializing AnIdentifier(this);
   StringRef Name(NameStart, NameEnd - NameStart);
+  DeserializationReasonTracker Reason(DR_NameLookup, *this);
 
   // If there is a global index, look there first to determine which modules
   // provably do not have any results for this identifier.
@@ -7130,15 +7161,27 @@ static void addMethodsToPool(Sema &S, ArrayRef<ObjCMethodDecl *> Methods,
 }
                              
 void ASTReader::ReadMethodPool(Selector Sel) {
+  DeserializationReasonTracker Reason(DR_MethodPool, *this);
+
   // Get the selector generation and update it to the current generation.
   unsigned &Generation = SelectorGeneration[Sel];
   unsigned PriorGeneration = Generation;
   Generation = getGeneration();
   
+  // If there is a global index, look there first to determine which modules
+  // provably do not have any methods with this selector.
+  GlobalModuleIndex::HitSet Hits;
+  GlobalModuleIndex::HitSet *HitsPtr = nullptr;
+  if (!loadGlobalIndex()) {
+    if (GlobalIndex->lookupSelector(Sel.getAsString(), Hits)) {
+      HitsPtr = &Hits;
+    }
+  }
+
   // Search for methods defined with this selector.
   ++NumMethodPoolLookups;
   ReadMethodPoolVisitor Visitor(*this, Sel, PriorGeneration);
-  ModuleMgr.visit(&ReadMethodPoolVisitor::visit, &Visitor);
+  ModuleMgr.visit(&ReadMethodPoolVisitor::visit, &Visitor, HitsPtr);
   
   if (Visitor.getInstanceMethods().empty() &&
       Visitor.getFactoryMethods().empty())
@@ -8548,7 +8591,7 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context, StringRef isysroot,
       NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
       TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
       PassingDeclsToConsumer(false), NumCXXBaseSpecifiersLoaded(0),
-      ReadingKind(Read_None) {
+      ReadingKind(Read_None), CurrentDeserializationReason(DR_Unknown) {
   SourceMgr.setExternalSLocEntrySource(this);
 }
 
@@ -4563,6 +4563,12 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
 
   // Keep writing types, declarations, and declaration update records
   // until we've emitted all of them.
+  //
+  // FIXME: This is inherently serial. Writing a decl or type assigns IDs to
+  // the decls and types it refers to (see GetDeclRef and GetOrCreateTypeID)
+  // and queues them here, so both the set of records and their IDs are only
+  // known once the worklist has been drained. Encoding records in parallel
+  // would first require a separate pass that assigns every ID up front.
   Stream.EnterSubblock(DECLTYPES_BLOCK_ID, /*bits for abbreviations*/5);
   WriteTypeAbbrevs();
   WriteDeclAbbrevs();
@@ -58,8 +58,10 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   // Make sure it hits disk now.
   Out->flush();
 
-  // Free up some memory, in case the process is kept alive.
-  Buffer.clear();
+  // Free up the memory held by the serialized AST, in case the process is
+  // kept alive. clear() alone would retain the buffer's capacity, which is as
+  // large as the AST file itself.
+  SmallVector<char, 128>().swap(Buffer);
 
   HasEmittedPCH = true;
 }
@@ -49,7 +49,10 @@ namespace {
     /// \brief Describes a module, including its file name and dependencies.
     MODULE,
     /// \brief The index for identifiers.
-    IDENTIFIER_INDEX
+    IDENTIFIER_INDEX,
+    /// \brief The index for Objective-C selectors, keyed by the spelling of
+    /// the selector.
+    SELECTOR_INDEX
   };
 }
 
@@ -57,7 +60,7 @@ namespace {
 static const char * const IndexFileName = "modules.idx";
 
 /// \brief The global index file version.
-static const unsigned CurrentVersion = 1;
+static const unsigned CurrentVersion = 2;
 
 //----------------------------------------------------------------------------//
 // Global module index reader.
@@ -120,12 +123,17 @@ public:
 typedef llvm::OnDiskIterableChainedHashTable<IdentifierIndexReaderTrait>
     IdentifierIndexTable;
 
+/// \brief The selector index uses the same layout as the identifier index,
+/// keyed by the spelling of the selector (e.g., "initWithFoo:bar:").
+typedef IdentifierIndexTable SelectorIndexTable;
+
 }
 
 GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                      llvm::BitstreamCursor Cursor)
-    : Buffer(std::move(Buffer)), IdentifierIndex(), NumIdentifierLookups(),
-      NumIdentifierLookupHits() {
+    : Buffer(std::move(Buffer)), IdentifierIndex(), SelectorIndex(),
+      NumIdentifierLookups(), NumIdentifierLookupHits(), NumSelectorLookups(),
+      NumSelectorLookupHits() {
   // Read the global index.
   bool InGlobalIndexBlock = false;
   bool Done = false;
@@ -201,6 +209,9 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                       Record.begin() + Idx + NumDeps);
       Idx += NumDeps;
 
+      // Whether all of the selectors in this module file were indexed.
+      Modules[ID].SelectorsIndexed = Record[Idx++];
+
       // Make sure we're at the end of the record.
       assert(Idx == Record.size() && "More module info?");
 
@@ -223,12 +234,23 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
             (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
       }
       break;
+
+    case SELECTOR_INDEX:
+      // Wire up the selector index.
+      if (Record[0]) {
+        SelectorIndex = SelectorIndexTable::Create(
+            (const unsigned char *)Blob.data() + Record[0],
+            (const unsigned char *)Blob.data() + sizeof(uint32_t),
+            (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
+      }
+      break;
     }
   }
 }
 
 GlobalModuleIndex::~GlobalModuleIndex() {
   delete static_cast<IdentifierIndexTable *>(IdentifierIndex);
+  delete static_cast<SelectorIndexTable *>(SelectorIndex);
 }
 
 std::pair<GlobalModuleIndex *, GlobalModuleIndex::ErrorCode>
@@ -316,6 +338,38 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   return true;
 }
 
+bool GlobalModuleIndex::lookupSelector(StringRef Name, HitSet &Hits) {
+  Hits.clear();
+
+  // If there's no selector index, there is nothing we can do.
+  if (!SelectorIndex)
+    return false;
+
+  // Module files whose selectors could not all be indexed may contain this
+  // selector, so they always have to be searched.
+  ++NumSelectorLookups;
+  for (unsigned I = 0, N = Modules.size(); I != N; ++I) {
+    if (!Modules[I].SelectorsIndexed)
+      if (ModuleFile *MF = Modules[I].File)
+        Hits.insert(MF);
+  }
+
+  // Look into the selector index.
+  SelectorIndexTable &Table = *static_cast<SelectorIndexTable *>(SelectorIndex);
+  SelectorIndexTable::iterator Known = Table.find(Name);
+  if (Known == Table.end())
+    return true;
+
+  SmallVector<unsigned, 2> ModuleIDs = *Known;
+  for (unsigned I = 0, N = ModuleIDs.size(); I != N; ++I) {
+    if (ModuleFile *MF = Modules[ModuleIDs[I]].File)
+      Hits.insert(MF);
+  }
+
+  ++NumSelectorLookupHits;
+  return true;
+}
+
 bool GlobalModuleIndex::loadedModuleFile(ModuleFile *File) {
   // Look for the module in the global module index based on the module name.
   StringRef Name = File->ModuleName;
@@ -350,6 +404,11 @@ void GlobalModuleIndex::printStats() {
             NumIdentifierLookupHits, NumIdentifierLookups,
             (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumSelectorLookups) {
+    fprintf(stderr, "  %u / %u selector lookups succeeded (%f%%)\n",
+            NumSelectorLookupHits, NumSelectorLookups,
+            (double)NumSelectorLookupHits*100.0/NumSelectorLookups);
+  }
   std::fprintf(stderr, "\n");
 }
 
@@ -373,14 +432,26 @@ void GlobalModuleIndex::dump() {
 namespace {
   /// \brief Provides information about a specific module file.
   struct ModuleFileInfo {
+    ModuleFileInfo() : ID(), SelectorsIndexed(false) { }
+
     /// \brief The numberic ID for this module file.
     unsigned ID;
 
     /// \brief The set of modules on which this module depends. Each entry is
     /// a module ID.
     SmallVector<unsigned, 4> Dependencies;
+
+    /// \brief Whether every selector in this module file's method pool was
+    /// recorded in the selector index.
+    bool SelectorsIndexed;
   };
 
+  /// \brief Mapping from strings (identifiers or selectors) to the list of
+  /// module file IDs that know about that string.
+  typedef llvm::StringMap<SmallVector<unsigned, 2> > StringIndexMap;
+}
+
+namespace clang {
   /// \brief Builder that generates the global module index file.
   class GlobalModuleIndexBuilder {
     FileManager &FileMgr;
@@ -391,17 +462,41 @@ namespace {
     /// \brief Information about each of the known module files.
     ModuleFilesMap ModuleFiles;
 
-    /// \brief Mapping from identifiers to the list of module file IDs that
-    /// consider this identifier to be interesting.
-    typedef llvm::StringMap<SmallVector<unsigned, 2> > InterestingIdentifierMap;
-
     /// \brief A mapping from all interesting identifiers to the set of module
     /// files in which those identifiers are considered interesting.
-    InterestingIdentifierMap InterestingIdentifiers;
-    
+    StringIndexMap InterestingIdentifiers;
+
+    /// \brief A mapping from all selectors to the set of module files whose
+    /// method pools contain that selector.
+    StringIndexMap Selectors;
+
+    /// \brief The previous global module index, if any, whose contents may be
+    /// reused for module files that have not changed since it was written.
+    GlobalModuleIndex *PreviousIndex;
+
+    /// \brief Mapping from module file names to IDs in the previous index.
+    llvm::StringMap<unsigned> PreviousModules;
+
+    /// \brief Mapping from IDs in the previous index to the IDs of the module
+    /// files reused from it.
+    llvm::DenseMap<unsigned, unsigned> ReusedModules;
+
     /// \brief Write the block-info block for the global module index file.
     void emitBlockInfoBlock(llvm::BitstreamWriter &Stream);
 
+    /// \brief Write a string -> module file IDs mapping as an on-disk hash
+    /// table record.
+    void emitStringIndex(llvm::BitstreamWriter &Stream, unsigned Code,
+                         const StringIndexMap &Index);
+
+    /// \brief Determine whether the given module file, as recorded in the
+    /// previous index, is still the file \p File.
+    bool isUnchangedInPreviousIndex(const FileEntry *File, unsigned PrevID);
+
+    /// \brief Copy the entries of a previous index table for the module files
+    /// that were reused.
+    void importPreviousIndex(void *PrevTable, StringIndexMap &Index);
+
     /// \brief Retrieve the module file information for the given file.
     ModuleFileInfo &getModuleFileInfo(const FileEntry *File) {
       llvm::MapVector<const FileEntry *, ModuleFileInfo>::iterator Known
@@ -416,13 +511,29 @@ namespace {
     }
 
   public:
-    explicit GlobalModuleIndexBuilder(FileManager &FileMgr) : FileMgr(FileMgr){}
+    explicit GlobalModuleIndexBuilder(FileManager &FileMgr)
+      : FileMgr(FileMgr), PreviousIndex() { }
+
+    /// \brief Allow the contents of the given, previously-written index to be
+    /// reused for module files that have not changed since it was written.
+    void setPreviousIndex(GlobalModuleIndex *Index);
 
     /// \brief Load the contents of the given module file into the builder.
     ///
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// \brief Try to take the contents of the given module file from the
+    /// previous index instead of reading the module file itself.
+    ///
+    /// \returns true if the module file was reused, false if it needs to be
+    /// loaded with \c loadModuleFile().
+    bool reuseModuleFile(const FileEntry *File);
+
+    /// \brief Copy the identifiers and selectors of all reused module files
+    /// from the previous index.
+    void finishReusingModuleFiles();
+
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
   };
@@ -464,6 +575,7 @@ GlobalModuleIndexBuilder::emitBlockInfoBlock(llvm::BitstreamWriter &Stream) {
   RECORD(INDEX_METADATA);
   RECORD(MODULE);
   RECORD(IDENTIFIER_INDEX);
+  RECORD(SELECTOR_INDEX);
 #undef RECORD
 #undef BLOCK
 
@@ -489,6 +601,91 @@ namespace {
       return std::make_pair(k, IsInteresting);
     }
   };
+
+  /// \brief Trait used to enumerate the keys of a module file's method pool,
+  /// without resolving the identifiers that make up each selector.
+  class MethodPoolKeyTrait {
+  public:
+    /// \brief The raw selector key: a 16-bit argument count followed by the
+    /// module-local identifier IDs of each selector piece.
+    typedef const unsigned char *external_key_type;
+    typedef external_key_type internal_key_type;
+    typedef void data_type;
+    typedef unsigned hash_value_type;
+    typedef unsigned offset_type;
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const unsigned char*& d) {
+      using namespace llvm::support;
+      unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(d);
+      unsigned DataLen = endian::readNext<uint16_t, little, unaligned>(d);
+      return std::make_pair(KeyLen, DataLen);
+    }
+
+    static const external_key_type &
+    GetExternalKey(const internal_key_type &x) { return x; }
+
+    static internal_key_type ReadKey(const unsigned char* d, unsigned) {
+      return d;
+    }
+  };
+
+  /// \brief The identifier tables of a module file, which are needed to spell
+  /// the selectors in its method pool.
+  struct ModuleIdentifiers {
+    ModuleIdentifiers()
+      : TableData(), Offsets(), NumIdentifiers(), BaseID() { }
+
+    const char *TableData;
+    const uint32_t *Offsets;
+    unsigned NumIdentifiers;
+    unsigned BaseID;
+
+    /// \brief Retrieve the spelling of an identifier given its ID within the
+    /// module file.
+    ///
+    /// \returns false if the identifier was not defined by this module file,
+    /// e.g. because it was imported from another module.
+    bool getName(unsigned LocalID, StringRef &Name) const {
+      if (LocalID < NUM_PREDEF_IDENT_IDS) {
+        Name = StringRef();
+        return true;
+      }
+
+      unsigned Index = LocalID - NUM_PREDEF_IDENT_IDS;
+      if (!TableData || Index < BaseID || Index - BaseID >= NumIdentifiers)
+        return false;
+
+      // Strings in the identifier table are preceded by their length + 1.
+      const char *Str = TableData + Offsets[Index - BaseID];
+      const unsigned char *StrLenPtr = (const unsigned char*) Str - 2;
+      unsigned StrLen = (((unsigned) StrLenPtr[0])
+                         | (((unsigned) StrLenPtr[1]) << 8)) - 1;
+      Name = StringRef(Str, StrLen);
+      return true;
+    }
+  };
+}
+
+/// \brief Form the spelling of a selector from its raw method pool key.
+///
+/// \returns false if some piece of the selector could not be spelled.
+static bool getSelectorSpelling(const unsigned char *Key,
+                                const ModuleIdentifiers &Identifiers,
+                                SmallVectorImpl<char> &Spelling) {
+  using namespace llvm::support;
+  Spelling.clear();
+  unsigned N = endian::readNext<uint16_t, little, unaligned>(Key);
+  for (unsigned I = 0, NumPieces = N ? N : 1; I != NumPieces; ++I) {
+    StringRef Piece;
+    if (!Identifiers.getName(endian::readNext<uint32_t, little, unaligned>(Key),
+                             Piece))
+      return false;
+    Spelling.append(Piece.begin(), Piece.end());
+    if (N)
+      Spelling.push_back(':');
+  }
+  return true;
 }
 
 bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
@@ -517,6 +714,12 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
   // one already).
   unsigned ID = getModuleFileInfo(File).ID;
 
+  // The method pool and the identifier tables needed to spell its selectors,
+  // which may appear in any order within the AST block.
+  ModuleIdentifiers Identifiers;
+  StringRef MethodPoolBlob;
+  unsigned MethodPoolBucketOffset = 0;
+
   // Search for the blocks and records we care about.
   enum { Other, ControlBlock, ASTBlock } State = Other;
   bool Done = false;
@@ -633,14 +836,141 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
         else
           (void)InterestingIdentifiers[Ident.first];
       }
+      Identifiers.TableData = Blob.data();
+      continue;
+    }
+
+    if (State == ASTBlock && Code == IDENTIFIER_OFFSET) {
+      Identifiers.Offsets = (const uint32_t *)Blob.data();
+      Identifiers.NumIdentifiers = Record[0];
+      Identifiers.BaseID = Record[1];
+      continue;
+    }
+
+    if (State == ASTBlock && Code == METHOD_POOL) {
+      MethodPoolBlob = Blob;
+      MethodPoolBucketOffset = Record[0];
+      continue;
     }
 
     // We don't care about this record.
   }
 
+  // Record the selectors in the method pool. If any of them refers to an
+  // identifier from another module file, we can't spell it here, so the
+  // selector index will not be authoritative for this module file.
+  bool SelectorsIndexed = true;
+  if (MethodPoolBucketOffset) {
+    typedef llvm::OnDiskIterableChainedHashTable<MethodPoolKeyTrait>
+        MethodPoolTable;
+    std::unique_ptr<MethodPoolTable> Table(MethodPoolTable::Create(
+        (const unsigned char *)MethodPoolBlob.data() + MethodPoolBucketOffset,
+        (const unsigned char *)MethodPoolBlob.data() + sizeof(uint32_t),
+        (const unsigned char *)MethodPoolBlob.data()));
+    SmallString<64> Spelling;
+    for (MethodPoolTable::key_iterator K = Table->key_begin(),
+                                       KEnd = Table->key_end();
+         K != KEnd; ++K) {
+      if (!getSelectorSpelling(*K, Identifiers, Spelling)) {
+        SelectorsIndexed = false;
+        continue;
+      }
+
+      SmallVectorImpl<unsigned> &IDs = Selectors[Spelling.str()];
+      if (IDs.empty() || IDs.back() != ID)
+        IDs.push_back(ID);
+    }
+  }
+  getModuleFileInfo(File).SelectorsIndexed = SelectorsIndexed;
+
   return false;
 }
 
+void GlobalModuleIndexBuilder::setPreviousIndex(GlobalModuleIndex *Index) {
+  PreviousIndex = Index;
+  PreviousModules.clear();
+  for (unsigned I = 0, N = Index->Modules.size(); I != N; ++I) {
+    if (!Index->Modules[I].FileName.empty())
+      PreviousModules[Index->Modules[I].FileName] = I;
+  }
+}
+
+bool GlobalModuleIndexBuilder::isUnchangedInPreviousIndex(
+       const FileEntry *File, unsigned PrevID) {
+  const GlobalModuleIndex::ModuleInfo &Info = PreviousIndex->Modules[PrevID];
+  return File && File->getSize() == Info.Size &&
+         File->getModificationTime() == Info.ModTime;
+}
+
+bool GlobalModuleIndexBuilder::reuseModuleFile(const FileEntry *File) {
+  if (!PreviousIndex)
+    return false;
+
+  llvm::StringMap<unsigned>::iterator Known
+    = PreviousModules.find(File->getName());
+  if (Known == PreviousModules.end() ||
+      !isUnchangedInPreviousIndex(File, Known->second))
+    return false;
+
+  // The module file can only be reused if none of its dependencies has
+  // changed, either.
+  const GlobalModuleIndex::ModuleInfo &Info
+    = PreviousIndex->Modules[Known->second];
+  SmallVector<const FileEntry *, 4> DependsOnFiles;
+  for (unsigned I = 0, N = Info.Dependencies.size(); I != N; ++I) {
+    unsigned DepID = Info.Dependencies[I];
+    if (DepID >= PreviousIndex->Modules.size())
+      return false;
+
+    const FileEntry *DependsOnFile
+      = FileMgr.getFile(PreviousIndex->Modules[DepID].FileName,
+                        /*openFile=*/false, /*cacheFailure=*/false);
+    if (!isUnchangedInPreviousIndex(DependsOnFile, DepID))
+      return false;
+    DependsOnFiles.push_back(DependsOnFile);
+  }
+
+  unsigned ID = getModuleFileInfo(File).ID;
+  for (unsigned I = 0, N = DependsOnFiles.size(); I != N; ++I) {
+    unsigned DependsOnID = getModuleFileInfo(DependsOnFiles[I]).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+  getModuleFileInfo(File).SelectorsIndexed = Info.SelectorsIndexed;
+  ReusedModules[Known->second] = ID;
+  return true;
+}
+
+void GlobalModuleIndexBuilder::importPreviousIndex(void *PrevTable,
+                                                   StringIndexMap &Index) {
+  if (!PrevTable)
+    return;
+
+  IdentifierIndexTable &Table = *static_cast<IdentifierIndexTable *>(PrevTable);
+  for (IdentifierIndexTable::key_iterator K = Table.key_begin(),
+                                          KEnd = Table.key_end();
+       K != KEnd; ++K) {
+    IdentifierIndexTable::iterator Known = Table.find(*K);
+    if (Known == Table.end())
+      continue;
+
+    SmallVector<unsigned, 2> PrevIDs = *Known;
+    for (unsigned I = 0, N = PrevIDs.size(); I != N; ++I) {
+      llvm::DenseMap<unsigned, unsigned>::iterator Reused
+        = ReusedModules.find(PrevIDs[I]);
+      if (Reused != ReusedModules.end())
+        Index[*K].push_back(Reused->second);
+    }
+  }
+}
+
+void GlobalModuleIndexBuilder::finishReusingModuleFiles() {
+  if (!PreviousIndex || ReusedModules.empty())
+    return;
+
+  importPreviousIndex(PreviousIndex->IdentifierIndex, InterestingIdentifiers);
+  importPreviousIndex(PreviousIndex->SelectorIndex, Selectors);
+}
+
 namespace {
 
 /// \brief Trait used to generate the identifier index as an on-disk hash
@@ -683,6 +1013,45 @@ public:
 
 }
 
+void GlobalModuleIndexBuilder::emitStringIndex(llvm::BitstreamWriter &Stream,
+                                               unsigned Code,
+                                               const StringIndexMap &Index) {
+  using namespace llvm;
+
+  OnDiskChainedHashTableGenerator<IdentifierIndexWriterTrait> Generator;
+  IdentifierIndexWriterTrait Trait;
+
+  // Populate the hash table.
+  for (StringIndexMap::const_iterator I = Index.begin(), IEnd = Index.end();
+       I != IEnd; ++I) {
+    Generator.insert(I->first(), I->second, Trait);
+  }
+
+  // Create the on-disk hash table in a buffer.
+  SmallString<4096> Table;
+  uint32_t BucketOffset;
+  {
+    using namespace llvm::support;
+    raw_svector_ostream Out(Table);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(Out).write<uint32_t>(0);
+    BucketOffset = Generator.Emit(Out, Trait);
+  }
+
+  // Create a blob abbreviation
+  BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(Code));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned TableAbbrev = Stream.EmitAbbrev(Abbrev);
+
+  // Write the table
+  SmallVector<uint64_t, 2> Record;
+  Record.push_back(Code);
+  Record.push_back(BucketOffset);
+  Stream.EmitRecordWithBlob(TableAbbrev, Record, Table.str());
+}
+
 void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
   using namespace llvm;
   
@@ -720,45 +1089,17 @@ void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     // Dependencies
     Record.push_back(M->second.Dependencies.size());
     Record.append(M->second.Dependencies.begin(), M->second.Dependencies.end());
+
+    // Whether the selector index covers this module file.
+    Record.push_back(M->second.SelectorsIndexed);
     Stream.EmitRecord(MODULE, Record);
   }
 
   // Write the identifier -> module file mapping.
-  {
-    llvm::OnDiskChainedHashTableGenerator<IdentifierIndexWriterTrait> Generator;
-    IdentifierIndexWriterTrait Trait;
-
-    // Populate the hash table.
-    for (InterestingIdentifierMap::iterator I = InterestingIdentifiers.begin(),
-                                            IEnd = InterestingIdentifiers.end();
-         I != IEnd; ++I) {
-      Generator.insert(I->first(), I->second, Trait);
-    }
-    
-    // Create the on-disk hash table in a buffer.
-    SmallString<4096> IdentifierTable;
-    uint32_t BucketOffset;
-    {
-      using namespace llvm::support;
-      llvm::raw_svector_ostream Out(IdentifierTable);
-      // Make sure that no bucket is at offset 0
-      endian::Writer<little>(Out).write<uint32_t>(0);
-      BucketOffset = Generator.Emit(Out, Trait);
-    }
-
-    // Create a blob abbreviation
-    BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
-    Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_INDEX));
-    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
-    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
-    unsigned IDTableAbbrev = Stream.EmitAbbrev(Abbrev);
+  emitStringIndex(Stream, IDENTIFIER_INDEX, InterestingIdentifiers);
 
-    // Write the identifier table
-    Record.clear();
-    Record.push_back(IDENTIFIER_INDEX);
-    Record.push_back(BucketOffset);
-    Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable.str());
-  }
+  // Write the selector -> module file mapping.
+  emitStringIndex(Stream, SELECTOR_INDEX, Selectors);
 
   Stream.ExitBlock();
 }
@@ -788,7 +1129,13 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
 
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr);
-  
+
+  // If there is an existing index, reuse its contents for the module files
+  // that haven't changed rather than reading them all again.
+  std::unique_ptr<GlobalModuleIndex> PreviousIndex(readIndex(Path).first);
+  if (PreviousIndex)
+    Builder.setPreviousIndex(PreviousIndex.get());
+
   // Load each of the module files.
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
@@ -810,10 +1157,13 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr, StringRef Path) {
     if (!ModuleFile)
       continue;
 
-    // Load this module file.
+    // Reuse or load this module file.
+    if (Builder.reuseModuleFile(ModuleFile))
+      continue;
     if (Builder.loadModuleFile(ModuleFile))
       return EC_IOError;
   }
+  Builder.finishReusingModuleFiles();
 
   // The output buffer, into which the global index will be written.
   SmallVector<char, 16> OutputBuffer;
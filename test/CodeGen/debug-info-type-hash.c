@@ -0,0 +1,69 @@
+// RUN: %clang_cc1 -emit-llvm -g -fdebug-types-section -triple x86_64-linux-gnu %s -o - | FileCheck %s
+// RUN: %clang_cc1 -emit-llvm -g -triple x86_64-linux-gnu %s -o - | FileCheck -check-prefix=NOFDTS %s
+// RUN: %clang_cc1 -emit-llvm -g -fdebug-types-section -triple x86_64-linux-gnu %s -o %t.1.ll
+// RUN: %clang_cc1 -emit-llvm -g -fdebug-types-section -triple x86_64-linux-gnu %s -DEXTRA -o %t.2.ll
+// RUN: grep 'DW_TAG_structure_type \] \[Point\]' %t.1.ll | grep -o 'metadata !"Point\.[0-9a-f]*"' | uniq > %t.1.id
+// RUN: grep 'DW_TAG_structure_type \] \[Point\]' %t.2.ll | grep -o 'metadata !"Point\.[0-9a-f]*"' | uniq > %t.2.id
+// RUN: diff %t.1.id %t.2.id
+
+// The same definition reached through another path gets the same identifier.
+// RUN: rm -rf %t.dir && mkdir -p %t.dir && cp %s %t.dir/copy.c
+// RUN: %clang_cc1 -emit-llvm -g -fdebug-types-section -triple x86_64-linux-gnu %t.dir/copy.c -o %t.3.ll
+// RUN: grep 'DW_TAG_structure_type \] \[Point\]' %t.3.ll | grep -o 'metadata !"Point\.[0-9a-f]*"' | uniq > %t.3.id
+// RUN: diff %t.1.id %t.3.id
+
+// A pointer to a complete type is not the same as one to an opaque type.
+// RUN: %clang_cc1 -emit-llvm -g -fdebug-types-section -triple x86_64-linux-gnu %s -DIMPL -o %t.4.ll
+// RUN: grep 'DW_TAG_structure_type \] \[Handle\]' %t.1.ll | grep -o 'metadata !"Handle\.[0-9a-f]*"' | uniq > %t.1.handle
+// RUN: grep 'DW_TAG_structure_type \] \[Handle\]' %t.4.ll | grep -o 'metadata !"Handle\.[0-9a-f]*"' | uniq > %t.4.handle
+// RUN: not diff %t.1.handle %t.4.handle
+
+// When types go in type units of their own, the types defined at file scope
+// are identified by a hash of their definition, so that the same definition
+// in two translation units ends up in the same type unit.
+
+struct Point {
+  int x, y;
+};
+
+enum Color { Red, Green, Blue };
+
+struct Shape {
+  struct Point Origin;
+  struct Point *Next;
+  enum Color Fill;
+  unsigned Flags : 3;
+};
+
+#ifdef IMPL
+struct impl { int fd; };
+#endif
+
+// A recursive type, behind a pointer to an opaque or complete type.
+struct Handle {
+  struct impl *Impl;
+  struct Handle *Next;
+};
+
+struct Handle h;
+
+#ifdef EXTRA
+struct Unrelated { double d; };
+struct Unrelated u;
+#endif
+
+struct Shape s;
+
+int f() {
+  struct Local { int i; } l;
+  return l.i;
+}
+
+// CHECK-DAG: metadata !"Point.{{[0-9a-f]+}}"} ; [ DW_TAG_structure_type ] [Point] {{.*}} [def]
+// CHECK-DAG: metadata !"Shape.{{[0-9a-f]+}}"} ; [ DW_TAG_structure_type ] [Shape] {{.*}} [def]
+// CHECK-DAG: metadata !"Handle.{{[0-9a-f]+}}"} ; [ DW_TAG_structure_type ] [Handle] {{.*}} [def]
+// CHECK-DAG: metadata !"Color.{{[0-9a-f]+}}"} ; [ DW_TAG_enumeration_type ] [Color]
+// CHECK-DAG: , null} ; [ DW_TAG_structure_type ] [Local] {{.*}} [def]
+
+// NOFDTS-NOT: metadata !"Point.
+// NOFDTS: ; [ DW_TAG_structure_type ] [Point] {{.*}} [def]
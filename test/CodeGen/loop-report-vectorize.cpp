@@ -0,0 +1,44 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O2 -floop-report=%t.json -emit-obj -o %t.o %s
+// RUN: FileCheck %s < %t.json
+
+// A -Rpass flag narrows down the remarks of its kind to the passes it matches.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O2 -floop-report=%t.filtered.json -Rpass-missed=loop-unroll -emit-obj -o %t.o %s 2> /dev/null
+// RUN: FileCheck -check-prefix=FILTER %s < %t.filtered.json
+
+int opaque(int);
+
+void vectorized(int *__restrict a, int *__restrict b, int n) {
+  for (int i = 0; i < n; ++i)
+    a[i] += b[i];
+}
+
+// The call keeps the loop from being vectorized.
+void not_vectorized(int *a, int n) {
+  for (int i = 0; i < n; ++i)
+    a[i] = opaque(a[i]);
+}
+
+// CHECK:       "line": 8,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 9,
+// CHECK-NEXT:       "kind": "ForStmt",
+// CHECK-NEXT:       "function": "_Z10vectorizedPiS_i",
+// CHECK-NEXT:       "hints": [],
+// CHECK-NEXT:       "remarks": [
+// CHECK:        {"pass": "loop-vectorize", "kind": "passed", "message": "vectorized loop{{.*}}"}
+// CHECK:       "line": 14,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 15,
+// CHECK-NEXT:       "kind": "ForStmt",
+// CHECK-NEXT:       "function": "_Z14not_vectorizedPii",
+// CHECK-NEXT:       "hints": [],
+// CHECK-NEXT:       "remarks": [
+// CHECK:        {"pass": "loop-vectorize", "kind": "missed", "message": "loop not vectorized{{.*}}"}
+// CHECK:      ]
+
+// FILTER:      "function": "_Z10vectorizedPiS_i",
+// FILTER:      {"pass": "loop-vectorize", "kind": "passed"
+// FILTER:      "function": "_Z14not_vectorizedPii",
+// FILTER-NOT:  {"pass": "loop-vectorize", "kind": "missed"
+// FILTER:      ]
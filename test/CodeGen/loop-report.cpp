@@ -0,0 +1,109 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -std=c++11 -floop-report=%t.json -emit-llvm-only %s
+// RUN: FileCheck %s < %t.json
+// RUN: not %clang_cc1 -floop-report=%t.dir/missing/loops.json -emit-llvm-only %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=ERROR %s
+
+// The inliner reports on always_inline functions even at -O0, which gives
+// remarks that do not depend on the target.
+inline int twice(int x) __attribute__((always_inline));
+inline int twice(int x) { return x * 2; }
+
+// The inliner is not a loop pass, so only the call on the line where the loop
+// starts gives a remark about the loop.
+void hinted(int *a, int n) {
+#pragma clang loop vectorize(enable) interleave_count(2)
+  for (int i = 0; i < twice(n); ++i)
+    a[i] = twice(a[i]);
+}
+
+// Remarks go to the innermost loop.
+void nested(int *a, int n) {
+  int i = 0;
+  do {
+    for (int j = 0; j < twice(n); ++j)
+      a[j] += i;
+  } while (++i < n);
+}
+
+// The instantiations of a loop share an entry.
+template <int N> void unrolled(int *a) {
+#pragma unroll
+  for (int i = 0; i < N; ++i)
+    a[i] = 0;
+  int i = 0;
+#pragma clang loop unroll_count(N)
+  while (i < N)
+    a[i++] = 1;
+}
+template void unrolled<4>(int *);
+template void unrolled<8>(int *);
+
+void ranged(int (&a)[4]) {
+#pragma clang loop vectorize(disable)
+  for (int &x : a)
+    x = twice(x);
+}
+
+// CHECK: {
+// CHECK-NEXT:   "loops": [
+// CHECK-NEXT:     {
+// CHECK-NEXT:       "file": "{{.*}}loop-report.cpp",
+// CHECK-NEXT:       "line": 15,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 16,
+// CHECK-NEXT:       "kind": "ForStmt",
+// CHECK-NEXT:       "function": "_Z6hintedPii",
+// CHECK-NEXT:       "hints": ["vectorize(enable)", "interleave_count(2)"],
+// CHECK-NEXT:       "remarks": [
+// CHECK-NEXT: {"pass": "inline", "kind": "passed", "message": "_Z5twicei inlined into _Z6hintedPii"}
+// CHECK-NEXT: ]
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK:       "line": 22,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 25,
+// CHECK-NEXT:       "kind": "DoStmt",
+// CHECK-NEXT:       "function": "_Z6nestedPii",
+// CHECK-NEXT:       "hints": [],
+// CHECK-NEXT:       "remarks": []
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK:       "line": 23,
+// CHECK-NEXT:       "column": 5,
+// CHECK-NEXT:       "end-line": 24,
+// CHECK-NEXT:       "kind": "ForStmt",
+// CHECK:       "remarks": [
+// CHECK-NEXT: {"pass": "inline", "kind": "passed", "message": "_Z5twicei inlined into _Z6nestedPii"}
+// CHECK-NEXT: ]
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK:       "line": 31,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 32,
+// CHECK-NEXT:       "kind": "ForStmt",
+// CHECK-NEXT:       "function": "_Z8unrolledILi{{[48]}}EEvPi",
+// CHECK-NEXT:       "hints": ["unroll(full)"],
+// CHECK-NEXT:       "remarks": []
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK:       "line": 35,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 36,
+// CHECK-NEXT:       "kind": "WhileStmt",
+// CHECK-NEXT:       "function": "_Z8unrolledILi{{[48]}}EEvPi",
+// CHECK-NEXT:       "hints": ["unroll_count({{[48]}})", "unroll_count({{[48]}})"],
+// CHECK-NEXT:       "remarks": []
+// CHECK-NEXT:     },
+// CHECK-NEXT:     {
+// CHECK:       "line": 43,
+// CHECK-NEXT:       "column": 3,
+// CHECK-NEXT:       "end-line": 44,
+// CHECK-NEXT:       "kind": "CXXForRangeStmt",
+// CHECK-NEXT:       "function": "_Z6rangedRA4_i",
+// CHECK-NEXT:       "hints": ["vectorize(disable)"],
+// CHECK-NEXT:       "remarks": []
+// CHECK-NEXT:     }
+// CHECK-NEXT:   ]
+// CHECK-NEXT: }
+
+// ERROR: error: unable to open output file
@@ -0,0 +1,31 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -S %s -o %t.0.s \
+// RUN:   -parallel-codegen-output %t.1.s
+// RUN: FileCheck -check-prefix=PART0 %s < %t.0.s
+// RUN: FileCheck -check-prefix=PART1 %s < %t.1.s
+
+// The module-level asm refers to a static function by name, so the function
+// stays with the asm in the first part and keeps its name. So does its
+// caller, which would otherwise refer to it from another part.
+__asm__(".globl entry\nentry:\n\tjmp target");
+
+__attribute__((used)) static int target(int x) {
+  int a = x + 1, b = x - 2, c = x * 3, d = x / 4;
+  a = a * b + c * d;
+  b = a - b * c - d;
+  return a + b + c + d;
+}
+
+int caller(int x) { return target(x) + 1; }
+
+int other(int x) { return x * 5; }
+
+// PART0-DAG: jmp target
+// PART0-DAG: {{^}}target:
+// PART0-DAG: {{^}}caller:
+// PART0-NOT: {{^}}other:
+
+// PART1-NOT: target
+// PART1-NOT: {{^}}caller:
+// PART1: {{^}}other:
+// PART1-NOT: target
@@ -0,0 +1,28 @@
+// REQUIRES: x86-registered-target
+// The diagnostics of the parts are reported as if the module had been
+// compiled as a whole: with their warning group, and with source locations.
+//
+// RUN: not %clang_cc1 %s -mllvm -warn-stack-size=0 -no-integrated-as -S \
+// RUN:   -triple=i386-apple-darwin -o %t.0.s -parallel-codegen-output %t.1.s \
+// RUN:   2> %t.err
+// RUN: FileCheck < %t.err %s --check-prefix=REGULAR --check-prefix=ASM
+// RUN: not %clang_cc1 %s -mllvm -warn-stack-size=0 -no-integrated-as -S \
+// RUN:   -triple=i386-apple-darwin -o %t.0.s -parallel-codegen-output %t.1.s \
+// RUN:   -Wno-frame-larger-than= 2> %t.err
+// RUN: FileCheck < %t.err %s --check-prefix=IGNORE --check-prefix=ASM
+
+extern void doIt(char *);
+
+// REGULAR: warning: stack frame size of {{[0-9]+}} bytes in function 'stackSizeWarning' [-Wframe-larger-than=]
+// IGNORE-NOT: stack frame size of {{[0-9]+}} bytes in function 'stackSizeWarning'
+void stackSizeWarning() {
+  char buffer[80];
+  doIt(buffer);
+}
+
+// ASM: parallel-codegen-diagnostics.c:[[@LINE+3]]:{{[0-9]+}}: error: inline assembly requires more registers than available
+void inlineAsmError(int x0, int x1, int x2, int x3, int x4,
+                    int x5, int x6, int x7, int x8, int x9) {
+  __asm__("hello world": : "r" (x0),"r" (x1),"r" (x2),"r" (x3),
+          "r" (x4),"r" (x5),"r" (x6),"r" (x7),"r" (x8),"r" (x9));
+}
@@ -0,0 +1,51 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -S %s -o %t.0.s \
+// RUN:   -parallel-codegen-output %t.1.s
+// RUN: FileCheck -check-prefix=PART0 %s < %t.0.s
+// RUN: FileCheck -check-prefix=PART1 %s < %t.1.s
+
+// The output doesn't depend on anything but the module.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -S %s -o %t.again.0.s \
+// RUN:   -parallel-codegen-output %t.again.1.s
+// RUN: cmp %t.0.s %t.again.0.s
+// RUN: cmp %t.1.s %t.again.1.s
+
+// Debug info can't be split, so everything goes in the first part, and the
+// second part is empty.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -S %s -o %t.g.0.s \
+// RUN:   -g -parallel-codegen-output %t.g.1.s
+// RUN: FileCheck -check-prefix=DEBUG0 %s < %t.g.0.s
+// RUN: FileCheck -check-prefix=DEBUG1 %s < %t.g.1.s
+
+// The most expensive function goes in the first part, the others in the
+// second, and the static function called across parts gets a name of its own.
+static int helper(int x) { return x * 3; }
+
+int big(int x) {
+  int a = x + 1, b = x - 2, c = x * 3, d = x / 4;
+  a = a * b + c * d;
+  b = a - b * c - d;
+  c = (a + b) * (c + d);
+  d = a * b * c * d;
+  return helper(a + b + c + d);
+}
+
+int user(int x) { return helper(x) + 1; }
+
+// PART0: {{^}}big:
+// PART0: callq helper.llvm.[[HASH:[0-9a-f]+]]
+// PART0-NOT: {{^}}user:
+// PART0-NOT: {{^}}helper
+
+// PART1-NOT: {{^}}big:
+// PART1-DAG: .hidden helper.llvm.
+// PART1-DAG: {{^}}helper.llvm.{{[0-9a-f]+}}:
+// PART1-DAG: {{^}}user:
+
+// DEBUG0-DAG: {{^}}big:
+// DEBUG0-DAG: {{^}}helper:
+// DEBUG0-DAG: {{^}}user:
+// DEBUG1-NOT: {{^}}big:
+// DEBUG1-NOT: {{^}}helper
+// DEBUG1-NOT: {{^}}user:
+// DEBUG1-NOT: .debug_info
@@ -0,0 +1,66 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fstreaming-codegen -S \
+// RUN:   -print-stats %s -o %t.s 2> %t.stats
+// RUN: FileCheck %s < %t.s
+// RUN: FileCheck -check-prefix=INLINED %s < %t.s
+// RUN: FileCheck -check-prefix=STATS %s < %t.stats
+
+// Code is generated all at once when optimizing.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -fstreaming-codegen -S \
+// RUN:   -O1 -print-stats %s -o /dev/null 2>&1 \
+// RUN:   | FileCheck -check-prefix=OPT %s
+
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -fstreaming-codegen \
+// RUN:   -S -DLATE_ASM %s -o /dev/null 2>&1 \
+// RUN:   | FileCheck -check-prefix=LATE-ASM %s
+
+// Module-level asm that comes first is emitted ahead of everything else.
+__asm__(".globl early_asm_symbol");
+
+static inline __attribute__((always_inline)) int twice(int x) { return 2 * x; }
+
+// Callers of always_inline functions are kept until the end, so that the
+// call can be inlined.
+int caller(int x) { return twice(x) + 1; }
+
+static int internal_helper(int x);
+
+#define FUNC(n) int f##n(int x) { return internal_helper(x) + n; }
+FUNC(0) FUNC(1) FUNC(2) FUNC(3) FUNC(4) FUNC(5) FUNC(6) FUNC(7) FUNC(8)
+FUNC(9) FUNC(10) FUNC(11) FUNC(12) FUNC(13) FUNC(14) FUNC(15) FUNC(16)
+FUNC(17) FUNC(18) FUNC(19)
+
+// A static function that is defined after its callers have been built. The
+// callers wait for its definition.
+static int internal_helper(int x) { return x - 1; }
+
+// A function that only becomes always_inline with its definition, after a
+// caller of it and a use of its address have been built.
+static int late_inline(int x);
+int calls_late(int x) { return late_inline(x) * 3; }
+int (*late_inline_ptr)(int) = late_inline;
+static inline __attribute__((always_inline)) int late_inline(int x) {
+  return x + 7;
+}
+
+#ifdef LATE_ASM
+__asm__(".globl late_asm_symbol");
+// LATE-ASM: error: file-scope asm cannot follow a function definition with '-fstreaming-codegen'
+#endif
+
+// CHECK: .globl early_asm_symbol
+// CHECK-DAG: {{^}}f0:
+// CHECK-DAG: {{^}}f19:
+// CHECK-DAG: {{^}}internal_helper:
+// CHECK-DAG: {{^}}caller:
+// CHECK-DAG: {{^}}calls_late:
+// CHECK-DAG: .quad late_inline
+
+// INLINED-NOT: twice
+// INLINED-NOT: call{{.*}}late_inline
+
+// STATS: *** Streaming Code Generation Stats:
+// STATS-NEXT: {{[1-9][0-9]*}} functions generated while building the module
+// STATS-NEXT: {{[1-9][0-9]*}} functions generated at the end of the module
+
+// OPT-NOT: Streaming Code Generation Stats
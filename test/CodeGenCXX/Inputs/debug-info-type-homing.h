@@ -0,0 +1,17 @@
+struct Used {
+  int i;
+};
+
+struct Unused {
+  int j;
+};
+
+struct Dynamic {
+  virtual ~Dynamic();
+};
+
+template <typename T> struct Tmpl {
+  T t;
+};
+
+extern template struct Tmpl<int>;
@@ -0,0 +1,57 @@
+// RUN: echo '%t.other.o: %t.other.cpp \' > %t.after.d
+// RUN: echo '  %S/Inputs/debug-info-type-homing.h' >> %t.after.d
+// RUN: echo '%t.o: %s %S/Inputs/debug-info-type-homing.h' >> %t.after.d
+// RUN: echo '%t.o: %s %S/Inputs/debug-info-type-homing.h' > %t.first.d
+// RUN: cat %t.after.d >> %t.first.d
+
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -g -fdebug-type-homing \
+// RUN:   -fdebug-type-homing-manifest=%t.after.d \
+// RUN:   -fdebug-type-report=%t.report %s -o - \
+// RUN:   | FileCheck -check-prefix=ELSEWHERE %s
+// RUN: FileCheck -check-prefix=REPORT %s < %t.report
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -g -fdebug-type-homing \
+// RUN:   -fdebug-type-homing-manifest=%t.first.d %s -o - \
+// RUN:   | FileCheck -check-prefix=HERE %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -g \
+// RUN:   -fdebug-type-homing-manifest=%t.after.d %s -o - \
+// RUN:   | FileCheck -check-prefix=OFF %s
+
+#include "Inputs/debug-info-type-homing.h"
+
+struct Local {
+  int k;
+};
+
+Used u;
+Local l;
+Dynamic *d;
+Tmpl<int> ti;
+Tmpl<long> tl;
+
+// The classes from the header are at home in the first translation unit
+// that includes it, and the explicitly instantiated specialization where it
+// is instantiated.
+// ELSEWHERE-DAG: [ DW_TAG_structure_type ] [Used] {{.*}} [decl]
+// ELSEWHERE-DAG: [ DW_TAG_structure_type ] [Local] {{.*}} [def]
+// ELSEWHERE-DAG: [ DW_TAG_structure_type ] [Dynamic] {{.*}} [decl]
+// ELSEWHERE-DAG: [ DW_TAG_structure_type ] [Tmpl<int>] {{.*}} [decl]
+// ELSEWHERE-DAG: [ DW_TAG_structure_type ] [Tmpl<long>] {{.*}} [def]
+// ELSEWHERE-NOT: [Unused]
+
+// REPORT: # type name kind est-bytes members home
+// REPORT-DAG: type Local definition {{[1-9][0-9]*}} 1 -
+// REPORT-DAG: type Tmpl<long> definition {{[1-9][0-9]*}} 2 -
+// REPORT-DAG: type Used declaration 0 0 {{.*}}.other.cpp
+// REPORT-DAG: type Tmpl<int> declaration 0 0 explicit instantiation
+// REPORT-DAG: type Dynamic declaration 0 0 vtable
+// REPORT: # total definitions declarations homed-elsewhere est-bytes
+// REPORT: total 2 3 3
+
+// The home emits the classes from the header even if it doesn't use them.
+// HERE-DAG: [ DW_TAG_structure_type ] [Used] {{.*}} [def]
+// HERE-DAG: [ DW_TAG_structure_type ] [Unused] {{.*}} [def]
+// HERE-DAG: [ DW_TAG_structure_type ] [Tmpl<int>] {{.*}} [decl]
+
+// OFF-DAG: [ DW_TAG_structure_type ] [Used] {{.*}} [def]
+// OFF-DAG: [ DW_TAG_structure_type ] [Tmpl<int>] {{.*}} [def]
+// OFF-NOT: [Unused]
@@ -0,0 +1,17 @@
+// The IR is only changed for -fstreaming-codegen when the code is streamed,
+// which it isn't when emitting IR or debug info.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -mconstructor-aliases \
+// RUN:   -fstreaming-codegen -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -mconstructor-aliases \
+// RUN:   -fstreaming-codegen -g -emit-llvm %s -o - | FileCheck %s
+
+struct A {
+  A() {}
+};
+
+void f() { A a; }
+
+// The calls to the complete constructor are redirected to the base one.
+// CHECK-LABEL: define void @_Z1fv(
+// CHECK: call void @_ZN1AC2Ev(
+// CHECK-NOT: define {{.*}} @_ZN1AC1Ev(
@@ -0,0 +1,28 @@
+// Check that the mappings of functions that other translation units may emit
+// as well are emitted in blocks of their own, which the linker keeps only one
+// copy of.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -main-file-name shared.cpp %s -o - -emit-llvm -fprofile-instr-generate -fcoverage-mapping | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name shared.cpp %s -o - -emit-llvm -fprofile-instr-generate -fcoverage-mapping | FileCheck -check-prefix=MACHO %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -main-file-name shared.cpp %s -o - -emit-llvm -fprofile-instr-generate -fcoverage-mapping -fcoverage-mapping-main-file-only | FileCheck -check-prefix=MAINFILE %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -main-file-name shared.cpp %s -emit-llvm-only -fprofile-instr-generate -fcoverage-mapping -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+#include "Inputs/header1.h"
+
+int main() {
+  func(1);
+  static_func(2);
+}
+
+// CHECK: $[[FUNC:__llvm_coverage_mapping__Z4funci_[0-9A-F]+]] = comdat any
+// CHECK: @[[FUNC]] = linkonce_odr hidden constant { i32, i32, i32, i32, [1 x { i8*, i32, i32, i64 }], [{{[0-9]+}} x i8] } { i32 1, {{.*}} @__llvm_profile_name__Z4funci, {{.*}}, section "__llvm_covmap", comdat $[[FUNC]], align 8
+// CHECK: @__llvm_coverage_mapping = internal constant { i32, i32, i32, i32, [3 x { i8*, i32, i32, i64 }], [{{[0-9]+}} x i8] } { i32 3,
+// CHECK: @llvm.used = {{.*}} @[[FUNC]] {{.*}} @__llvm_coverage_mapping
+
+// MACHO: @__llvm_coverage_mapping__Z4funci_{{[0-9A-F]+}} = linkonce_odr hidden constant {{.*}}, section "__DATA,__llvm_covmap", align 8
+
+// MAINFILE-NOT: @__llvm_coverage_mapping__Z4funci
+// MAINFILE: @__llvm_coverage_mapping = internal constant { i32, i32, i32, i32, [1 x { i8*, i32, i32, i64 }], [{{[0-9]+}} x i8] } { i32 1, {{.*}} @__llvm_profile_name_main,
+
+// STATS: *** Coverage Mapping Stats:
+// STATS-NEXT: 3 functions mapped in the translation unit's block, {{[0-9]+}} bytes, 2 files
+// STATS-NEXT: 1 functions mapped in blocks shared with other translation units, {{[0-9]+}} bytes
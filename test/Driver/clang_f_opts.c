@@ -390,3 +390,8 @@
 // CHECK-WCHAR1-NOT: -fshort-wchar
 // CHECK-WCHAR2: -fshort-wchar
 // CHECK-WCHAR2-NOT: -fno-short-wchar
+
+// RUN: %clang -### -c -fstreaming-codegen %s 2>&1 | FileCheck -check-prefix=CHECK-STREAMING %s
+// RUN: %clang -### -c -fstreaming-codegen -fno-streaming-codegen %s 2>&1 | FileCheck -check-prefix=CHECK-NO-STREAMING %s
+// CHECK-STREAMING: "-fstreaming-codegen"
+// CHECK-NO-STREAMING-NOT: "-fstreaming-codegen"
@@ -72,6 +72,13 @@
 // RUN: %clang -### -fdebug-types-section -fno-debug-types-section %s 2>&1 \
 // RUN:        | FileCheck -check-prefix=NOFDTS %s
 //
+// RUN: %clang -### -g -fdebug-type-homing -fdebug-type-homing-manifest=deps.d \
+// RUN:        -fdebug-type-report=types.txt %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=HOMING %s
+//
+// RUN: %clang -### -g -fdebug-type-homing -fno-debug-type-homing %s 2>&1 \
+// RUN:        | FileCheck -check-prefix=NOHOMING %s
+//
 // RUN: %clang -### -g -gno-column-info %s 2>&1 \
 // RUN:        | FileCheck -check-prefix=NOCI %s
 //
@@ -119,10 +126,16 @@
 //
 // GARANGE: -generate-arange-section
 //
-// FDTS: "-backend-option" "-generate-type-units"
+// FDTS: "-fdebug-types-section" "-backend-option" "-generate-type-units"
 //
+// NOFDTS-NOT: "-fdebug-types-section"
 // NOFDTS-NOT: "-backend-option" "-generate-type-units"
 //
+// HOMING: "-fdebug-type-homing" "-fdebug-type-homing-manifest=deps.d"
+// HOMING: "-fdebug-type-report=types.txt"
+//
+// NOHOMING-NOT: "-fdebug-type-homing"
+//
 // CI: "-dwarf-column-info"
 //
 // NOCI-NOT: "-dwarf-column-info"
@@ -0,0 +1,29 @@
+// The command line is the same whether or not cc1 runs in-process.
+// RUN: %clang -### -fintegrated-cc1 -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=PRINT %s
+// PRINT: "-cc1"
+// PRINT: "-disable-free"
+
+// RUN: %clang -fintegrated-cc1 -E -P %s | FileCheck -check-prefix=PP %s
+// RUN: %clang -fintegrated-cc1 -E -P %s %s \
+// RUN:   | FileCheck -check-prefix=PP -check-prefix=PP2 %s
+// PP: int in_process;
+// PP2: int in_process;
+int in_process;
+
+// RUN: not %clang -fintegrated-cc1 -fsyntax-only -DFAIL %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=ERROR %s
+// ERROR: error: failed in process
+#ifdef FAIL
+#error failed in process
+#endif
+
+// Options parsed into global state still get a process of their own.
+// RUN: %clang -fintegrated-cc1 -fsyntax-only -mllvm -stats %s
+
+// So do the options the backend passes on to LLVM, for every compilation.
+// RUN: rm -rf %t && mkdir -p %t && cp %s %t/second.c
+// RUN: cd %t && %clang -fintegrated-cc1 -ftime-report -c %s %t/second.c 2>/dev/null
+// RUN: %clang -### -fintegrated-cc1 -ftime-report -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=TIME %s
+// TIME: "-ftime-report"
@@ -0,0 +1,21 @@
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -c -fparallel-codegen=3 \
+// RUN:   %s -o %t.o 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK: "-o" "[[PART0:[^"]+]]" "-parallel-codegen-output" "[[PART1:[^"]+]]" "-parallel-codegen-output" "[[PART2:[^"]+]]"
+// CHECK: "-r" "-o" "{{[^"]*}}.o" "[[PART0]]" "[[PART1]]" "[[PART2]]"
+
+// Only object files are split.
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -S -fparallel-codegen=3 \
+// RUN:   %s 2>&1 | FileCheck -check-prefix=ASM %s
+// ASM-NOT: "-parallel-codegen-output"
+// ASM-NOT: "-r"
+
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -c -fparallel-codegen=0 \
+// RUN:   %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid integral value '0' in '-fparallel-codegen=0'
+
+// Debug info can't be split, so neither is the code of an object with it.
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -c -fparallel-codegen=3 \
+// RUN:   -g %s -o %t.o 2>&1 | FileCheck -check-prefix=DEBUG %s
+// DEBUG-NOT: "-parallel-codegen-output"
+// DEBUG-NOT: "-r"
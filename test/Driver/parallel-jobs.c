@@ -0,0 +1,22 @@
+// RUN: echo 'int first_file;' > %t.a.c
+// RUN: echo 'int second_file;' > %t.b.c
+// RUN: echo 'int third_file;' > %t.c.c
+// RUN: echo '#error first failure' > %t.err1.c
+// RUN: echo '#error second failure' > %t.err2.c
+
+// Output is written in the order of the inputs.
+// RUN: %clang -E -P -j 3 %t.a.c %t.b.c %t.c.c | FileCheck -check-prefix=ORDER %s
+// RUN: %clang -E -P -j3 %t.a.c %t.b.c %t.c.c | FileCheck -check-prefix=ORDER %s
+// ORDER: first_file
+// ORDER: second_file
+// ORDER: third_file
+
+// So are failures, and the commands after them still run.
+// RUN: not %clang -fsyntax-only -j 2 %t.err1.c %t.a.c %t.err2.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=FAILURES %s
+// FAILURES: error: first failure
+// FAILURES: error: second failure
+
+// RUN: not %clang -fsyntax-only -j 0 %t.a.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid integral value '0' in '-j 0'
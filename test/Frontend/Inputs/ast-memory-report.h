@@ -0,0 +1,4 @@
+struct FromHeader {
+  int a, b, c;
+  int sum() const { return a + b + c; }
+};
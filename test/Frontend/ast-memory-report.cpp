@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -fsyntax-only -ast-memory-report=%t %s
+// RUN: FileCheck %s < %t
+
+// CHECK: # category
+// CHECK-NEXT: category{{.}}decl{{.}}{{[1-9][0-9]*}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}stmt{{.}}{{[1-9][0-9]*}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}type{{.}}{{[1-9][0-9]*}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}typeloc{{.}}{{[1-9][0-9]*}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}comment{{.}}{{[0-9]+}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}other
+// CHECK-NEXT: category{{.}}redeclaration{{.}}{{[1-9][0-9]*}}{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}lookup-table{{.}}{{[1-9][0-9]*}}
+// CHECK-NEXT: category{{.}}allocator-slack
+// CHECK: # kind
+// CHECK-DAG: kind{{.}}decl{{.}}Function{{.}}2{{.}}
+// CHECK-DAG: kind{{.}}decl{{.}}CXXMethod{{.}}1{{.}}
+// CHECK-DAG: kind{{.}}decl{{.}}CXXRecord{{.}}
+// CHECK-DAG: kind{{.}}stmt{{.}}ReturnStmt{{.}}2{{.}}
+// CHECK-DAG: kind{{.}}type{{.}}Builtin{{.}}
+// CHECK-DAG: kind{{.}}typeloc{{.}}FunctionProto{{.}}
+// CHECK: # file
+// CHECK-DAG: file{{.}}{{.*}}ast-memory-report.cpp{{.}}
+// CHECK-DAG: file{{.}}{{.*}}Inputs{{.}}ast-memory-report.h{{.}}
+
+#include "Inputs/ast-memory-report.h"
+
+/// \brief Adds one.
+int next(int x);
+
+int next(int x) {
+  return x + 1;
+}
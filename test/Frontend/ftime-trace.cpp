@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -ftime-trace -emit-llvm -o %t.ll %s
+// RUN: FileCheck %s < %t.json
+// RUN: FileCheck -check-prefix=NOBUILTIN %s < %t.json
+// RUN: %clang -### -ftime-trace -c %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+
+// CHECK: "traceEvents":[
+// CHECK-DAG: "name":"Frontend"
+// CHECK-DAG: "name":"Source","args":{"detail":"{{.*}}test.h"}
+// CHECK-DAG: "name":"InstantiateClass","args":{"detail":"S<int>"}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"S<int>::get"}
+// CHECK-DAG: "name":"EmitDeferred","args":{"detail":"S<int>::get"}
+// CHECK-DAG: "name":"Total Frontend","args":{"count":1}
+// CHECK: ]}
+
+// The predefines buffer is not a header.
+// NOBUILTIN-NOT: <built-in>
+
+// DRIVER: "-cc1"{{.*}} "-ftime-trace"
+
+#include "Inputs/test.h"
+
+template <typename T> struct S {
+  T get() { return T(); }
+};
+
+int f() { return S<int>().get(); }
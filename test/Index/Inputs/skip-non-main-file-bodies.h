@@ -0,0 +1,15 @@
+extern int header_val;
+
+inline void header_func() {
+  header_val = undef_header_val;
+}
+
+template <typename T>
+void header_tmpl(T t) {
+  header_val = t.missing;
+}
+
+template <typename T>
+struct HeaderClass {
+  void method(T t) { header_val = t.missing_member; }
+};
@@ -0,0 +1,24 @@
+#include "skip-non-main-file-bodies.h"
+
+void main_func() {
+  header_val = 0;
+  header_tmpl(1);
+  HeaderClass<int>().method(2);
+}
+
+// RUN: env CINDEXTEST_SKIP_NON_MAIN_FILE_BODIES=1 c-index-test -index-file %s -I %S/Inputs | FileCheck %s
+// CHECK:      [indexDeclaration]: kind: function | name: header_func | {{.*}} | isDef: 1 | isContainer: skipped
+// CHECK:      [indexDeclaration]: kind: function-template | name: header_tmpl | {{.*}} | isDef: 1 | isContainer: skipped
+// CHECK:      [indexDeclaration]: kind: c++-instance-method | name: method | {{.*}} | isDef: 1 | isContainer: skipped
+// CHECK:      [indexDeclaration]: kind: function | name: main_func | {{.*}} | isDef: 1 | isContainer: 1
+// CHECK-NEXT: [indexEntityReference]: kind: variable | name: header_val
+// CHECK-NOT:  [diagnostic]
+
+// The bodies of templates are parsed when they are instantiated.
+// RUN: env CINDEXTEST_SKIP_NON_MAIN_FILE_BODIES=1 CINDEXTEST_INDEXIMPLICITTEMPLATEINSTANTIATIONS=1 c-index-test -index-file %s -I %S/Inputs | FileCheck %s -check-prefix=INST
+// INST:     [indexDeclaration]: kind: function | name: main_func | {{.*}} | isDef: 1 | isContainer: 1
+// INST-NOT: undeclared identifier 'undef_header_val'
+// The function template, header_tmpl:
+// INST-DAG: [diagnostic]: {{.*}}skip-non-main-file-bodies.h:9:{{[0-9]+}}: error: member reference base type 'int' is not a structure or union
+// The member of the class template, HeaderClass<int>::method:
+// INST-DAG: [diagnostic]: {{.*}}skip-non-main-file-bodies.h:14:{{[0-9]+}}: error: member reference base type 'int' is not a structure or union
@@ -0,0 +1,19 @@
+// RUN: rm -rf %t
+// Run and create the global module index
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -I %S/Inputs %s -verify
+// RUN: ls %t|grep modules.idx
+// Run and use the global module index for method pool lookups
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -I %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+@import MethodPoolA;
+
+// CHECK: *** Global Module Index Statistics:
+// CHECK: selector lookups succeeded
+
+void testMethod2(id object) {
+  [object method2:1];
+}
+
+void testMethod4(id object) {
+  [object method4]; // expected-warning{{instance method '-method4' not found (return type defaults to 'id')}}
+}
@@ -0,0 +1,44 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %S/Inputs/chain-decls1.h %S/Inputs/chain-decls2.h %t
+
+// Build the chain and populate the cache.
+// RUN: %clang_cc1 -fsyntax-only -verify %s -chain-include %t/chain-decls1.h -chain-include %t/chain-decls2.h -chain-include-cache %t/cache
+// RUN: ls %t/cache | grep chain-decls1.h-
+// RUN: ls %t/cache | grep chain-decls2.h-
+
+// Date the cached PCHs back, so that the ones that get rewritten show up as
+// newer than the stamp.
+// RUN: touch -t 200001010000 %t/cache/*.pch
+// RUN: touch -t 200001020000 %t/stamp
+
+// Reuse the cached chain.
+// RUN: %clang_cc1 -fsyntax-only -verify %s -chain-include %t/chain-decls1.h -chain-include %t/chain-decls2.h -chain-include-cache %t/cache
+// RUN: find %t/cache -name '*.pch' -newer %t/stamp | count 0
+
+// Changing the last header in the chain rebuilds it, on top of the cached PCH
+// of the first one.
+// RUN: echo "void changed(void);" >> %t/chain-decls2.h
+// RUN: echo "void use_changed(void) { changed(); }" > %t/use-changed.c
+// RUN: %clang_cc1 -fsyntax-only -Werror=implicit-function-declaration %t/use-changed.c -chain-include %t/chain-decls1.h -chain-include %t/chain-decls2.h -chain-include-cache %t/cache
+// RUN: find %t/cache -name '*.pch' -newer %t/stamp | FileCheck -check-prefix=REBUILT %s
+// REBUILT-NOT: chain-decls1.h-
+// REBUILT: chain-decls2.h-
+// REBUILT-NOT: chain-decls1.h-
+
+// expected-no-diagnostics
+
+int h() {
+  f();
+  g();
+
+  struct one x;
+  one();
+  struct two y;
+  two();
+  struct three z;
+
+  many(0);
+  struct many m;
+
+  noret();
+}
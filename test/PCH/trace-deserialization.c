@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -emit-pch -o %t.pch %s
+// RUN: %clang_cc1 -include-pch %t.pch -fsyntax-only -trace-deserialization=%t.trace %s
+// RUN: FileCheck %s < %t.trace
+
+#ifndef HEADER
+#define HEADER
+
+struct Point { int x, y; };
+int distance(struct Point p);
+
+#else
+
+// CHECK-DAG: decl	{{[a-z]+}}	Function	{{[0-9]+}}	distance	{{.*}}trace-deserialization.c:9:5	{{.*}}.pch	{{[0-9]+$}}
+// CHECK-DAG: decl	{{[a-z]+}}	Record	{{[0-9]+}}	Point	{{.*}}trace-deserialization.c:8:8	{{.*}}.pch	{{[0-9]+$}}
+// CHECK-DAG: type	{{[a-z]+}}	Record	{{[0-9]+}}	-	-	{{.*}}.pch	{{[0-9]+$}}
+int use(struct Point p) { return distance(p); }
+
+#endif
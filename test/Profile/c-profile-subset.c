@@ -0,0 +1,31 @@
+// Test that a profile subset has the data of the functions in the translation
+// unit, and gives the same results as the whole profile.
+
+// RUN: llvm-profdata merge %S/Inputs/c-attributes.proftext -o %t.profdata
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name c-profile-subset.c %s -o %t.whole.ll -emit-llvm -fprofile-instr-use=%t.profdata -fprofile-instr-subset=%t.subset.profdata
+// RUN: llvm-profdata show -all-functions %t.subset.profdata | FileCheck -check-prefix=SUBSET %s
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name c-profile-subset.c %s -o %t.subset.ll -emit-llvm -fprofile-instr-use=%t.subset.profdata
+// RUN: diff %t.whole.ll %t.subset.ll
+// RUN: FileCheck %s < %t.subset.ll
+
+// SUBSET-NOT: hot_100_percent:
+// SUBSET-NOT: main:
+// SUBSET-DAG: hot_40_percent:
+// SUBSET-DAG: cold_func:
+// SUBSET: Total functions: 3
+// SUBSET: Maximum function count: 100000
+
+// CHECK: hot_40_percent(i32{{.*}}%i) [[HOT:#[0-9]+]]
+void hot_40_percent(int i) {
+  while (i > 0)
+    i--;
+}
+
+// CHECK: cold_func(i32{{.*}}%i) [[COLD:#[0-9]+]]
+void cold_func(int i) {
+  while (i > 0)
+    i--;
+}
+
+// CHECK: attributes [[HOT]] = { inlinehint nounwind {{.*}} }
+// CHECK: attributes [[COLD]] = { cold nounwind {{.*}} }
@@ -0,0 +1,119 @@
+// Tests for value profiling of the targets of indirect calls.
+
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name cxx-indirect-calls.cpp %s -o - -emit-llvm -fprofile-instr-generate -fprofile-instr-indirect-calls | FileCheck -check-prefix=PGOGEN %s
+
+// RUN: llvm-profdata merge %S/Inputs/cxx-indirect-calls.proftext -o %t.profdata
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name cxx-indirect-calls.cpp %s -o - -emit-llvm -fprofile-instr-use=%t.profdata -fprofile-instr-indirect-calls | FileCheck -check-prefix=PGOUSE %s
+
+// Without the flag, calls get no counters of their own.
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name cxx-indirect-calls.cpp %s -o - -emit-llvm -fprofile-instr-generate | FileCheck -check-prefix=NOVP %s
+
+// NOVP: @__llvm_profile_counters__Z8call_getP4Base = hidden global [1 x i64]
+// NOVP-NOT: pgo.vp
+
+struct Base {
+  virtual int get();
+  virtual void set(int) = 0;
+};
+
+struct Derived : Base {
+  int get();
+  void set(int);
+};
+
+// Nothing in the module refers to the functions of Other, so calls aren't
+// compared against them.
+struct Other : Base {
+  int get();
+  void set(int);
+};
+
+int Base::get() { return 0; }
+int Derived::get() { return 1; }
+void Derived::set(int) {}
+
+// The value profile counters live in a record of their own, so that the
+// function hash doesn't depend on the targets.
+// PGOGEN-DAG: @[[CGC:__llvm_profile_counters__Z8call_getP4Base]] = hidden global [1 x i64]
+// PGOGEN-DAG: @[[CGV:__llvm_profile_counters__Z8call_getP4Base.vp]] = hidden global [4 x i64]
+// PGOGEN-DAG: @[[CSV:__llvm_profile_counters__Z8call_setP4Base.vp]] = hidden global [3 x i64]
+// PGOGEN-DAG: @[[CPV:__llvm_profile_counters__Z8call_ptrPFivE.vp]] = hidden global [4 x i64]
+
+// PGOGEN-LABEL: define i32 @_Z8call_getP4Base(
+// PGOUSE-LABEL: define i32 @_Z8call_getP4Base(
+int call_get(Base *B) {
+  // PGOGEN: store {{.*}} @[[CGC]], i64 0, i64 0
+  // PGOGEN: store {{.*}} @[[CGV]], i64 0, i64 0
+  // PGOGEN: icmp eq i8* {{.*}}@_ZN4Base3getEv
+  // PGOGEN: store {{.*}} @[[CGV]], i64 0, i64 1
+  // PGOGEN: icmp eq i8* {{.*}}@_ZN7Derived3getEv
+  // PGOGEN: store {{.*}} @[[CGV]], i64 0, i64 2
+  // PGOGEN-NOT: @_ZN5Other3getEv
+  // PGOGEN: call i32 %
+  // PGOUSE: call i32 %{{.*}}, !prof ![[CG:[0-9]+]]
+  return B->get();
+}
+
+// Pure virtual functions are not targets.
+// PGOGEN-LABEL: define void @_Z8call_setP4Base(
+// PGOUSE-LABEL: define void @_Z8call_setP4Base(
+void call_set(Base *B) {
+  // PGOGEN: store {{.*}} @[[CSV]], i64 0, i64 0
+  // PGOGEN-NOT: @_ZN4Base3setEi
+  // PGOGEN: icmp eq i8* {{.*}}@_ZN7Derived3setEi
+  // PGOGEN: store {{.*}} @[[CSV]], i64 0, i64 1
+  // PGOGEN-NOT: @_ZN5Other3setEi
+  // PGOUSE: call void %{{.*}}, !prof ![[CS:[0-9]+]]
+  B->set(1);
+}
+
+// Calls that aren't indirect are not profiled.
+// PGOGEN-LABEL: define void @_Z11call_directR7Derived(
+void call_direct(Derived &D) {
+  // PGOGEN-NOT: pgo.vp
+  // PGOGEN: ret void
+  D.Base::get();
+}
+
+static int one() { return 1; }
+int two();
+int three();
+
+int (*Table[])() = { one, two };
+
+int four();
+int five();
+
+// Calling a function directly, or naming it in sizeof, doesn't take its
+// address.
+int call_four() { return four() + sizeof(&five); }
+
+// Taking the address in a function that isn't emitted makes a target, but
+// instrumenting the call must not emit it or refer to it.
+inline int seven() { return 7; }
+inline int (*get_seven())() { return seven; }
+
+// Only functions whose address was taken are targets of function pointers.
+// PGOGEN-LABEL: define i32 @_Z8call_ptrPFivE(
+// PGOUSE-LABEL: define i32 @_Z8call_ptrPFivE(
+int call_ptr(int (*F)()) {
+  // PGOGEN: store {{.*}} @[[CPV]], i64 0, i64 0
+  // PGOGEN: icmp eq i8* {{.*}}@_ZL3onev
+  // PGOGEN: store {{.*}} @[[CPV]], i64 0, i64 1
+  // PGOGEN: icmp eq i8* {{.*}}@_Z3twov
+  // PGOGEN: store {{.*}} @[[CPV]], i64 0, i64 2
+  // PGOGEN-NOT: @_Z5threev
+  // PGOGEN-NOT: @_Z4fourv
+  // PGOGEN-NOT: @_Z4fivev
+  // PGOGEN-NOT: @_Z5sevenv
+  // PGOGEN: ret i32
+  // PGOUSE: call i32 %{{.*}}, !prof ![[CP:[0-9]+]]
+  return F();
+}
+// PGOGEN-NOT: @_Z5sevenv
+
+// Targets are listed by decreasing count, and those that were never called
+// are left out.
+// PGOUSE-DAG: ![[CG]] = metadata !{metadata !"VP", i32 0, i64 10, i64 7352261856662604111, i64 7, i64 -3447509134456105770, i64 3}
+// PGOUSE-DAG: ![[CS]] = metadata !{metadata !"VP", i32 0, i64 4, i64 -6371051094114976669, i64 4}
+// PGOUSE-DAG: ![[CP]] = metadata !{metadata !"VP", i32 0, i64 5, i64 1505102606472081037, i64 5}
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fsyntax-only -verify -ftypo-correction-time-budget 100000 %s
+// RUN: %clang -### -fsyntax-only -ftypo-correction-time-budget=50 %s 2>&1 | FileCheck %s
+// CHECK: "-ftypo-correction-time-budget" "50"
+
+// Typo correction only computes the edit distance to the names that share
+// enough bigrams with the typo. Corrections must be the same as if it
+// considered every name.
+
+int ab; // expected-note {{'ab' declared here}}
+int receiver_count; // expected-note {{'receiver_count' declared here}}
+int mmmmmmmmx; // expected-note {{'mmmmmmmmx' declared here}}
+
+void f() {
+  ac = 1; // expected-error {{use of undeclared identifier 'ac'; did you mean 'ab'?}}
+  recievr_count = 2; // expected-error {{use of undeclared identifier 'recievr_count'; did you mean 'receiver_count'?}}
+  mmmmmmmmy = 3; // expected-error {{use of undeclared identifier 'mmmmmmmmy'; did you mean 'mmmmmmmmx'?}}
+}
+
+// Names declared after the first correction are found too.
+int late_declared_name; // expected-note {{'late_declared_name' declared here}}
+
+void g() {
+  late_declared_nmae = 4; // expected-error {{use of undeclared identifier 'late_declared_nmae'; did you mean 'late_declared_name'?}}
+}
@@ -0,0 +1,41 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fconstexpr-cache-size 1000
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fconstexpr-cache-size 1000 -fconstexpr-steps 100000
+// RUN: %clang -std=c++1y -fsyntax-only -Xclang -verify %s -fconstexpr-cache-size=1000
+
+// Naive recursion makes an exponential number of calls: fib(90) would take
+// far more than 100000 steps unless the results of the calls are memoized.
+constexpr unsigned long long fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+static_assert(fib(40) == 102334155ULL, "");
+static_assert(fib(90) == 2880067194370816120ULL, "");
+
+// Memoized results are shared across the translation unit.
+constexpr unsigned long long fib91 = fib(91);
+static_assert(fib91 == 4660046610375530309ULL, "");
+
+constexpr double halve(double d, int n) {
+  return n == 0 ? d : halve(d, n - 1) / 2;
+}
+static_assert(halve(1024.0, 10) == 1.0, "");
+
+// Calls that are not constant expressions must not be memoized, so that they
+// are diagnosed every time.
+int g; // expected-note 2{{declared here}}
+constexpr int readG(int n) {
+  return n ? g : 0; // expected-note 2{{read of non-const variable 'g'}}
+}
+static_assert(readG(0) == 0, "");
+static_assert(readG(1) == 0, ""); // expected-error {{constant expression}} \
+                                  // expected-note {{in call to 'readG(1)'}}
+static_assert(readG(1) == 0, ""); // expected-error {{constant expression}} \
+                                  // expected-note {{in call to 'readG(1)'}}
+
+// Member functions are never memoized.
+struct S {
+  int v;
+  constexpr int get(int n) const { return v + n; }
+};
+constexpr S s1 = {1}, s2 = {2};
+static_assert(s1.get(1) == 2 && s2.get(1) == 3, "");
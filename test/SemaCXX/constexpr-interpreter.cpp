@@ -0,0 +1,144 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fexperimental-constexpr-interpreter
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fexperimental-constexpr-interpreter -fconstexpr-cache-size 100
+// RUN: %clang -std=c++1y -fsyntax-only -Xclang -verify %s -fexperimental-constexpr-interpreter
+
+// The bytecode interpreter must give exactly the same results and
+// diagnostics as the AST-walking evaluator.
+
+constexpr int sum(int n) {
+  int total = 0;
+  for (int i = 1; i <= n; ++i)
+    total += i;
+  return total;
+}
+static_assert(sum(0) == 0, "");
+static_assert(sum(10000) == 50005000, "");
+
+constexpr unsigned collatz(unsigned long long n) {
+  unsigned steps = 0;
+  while (n != 1) {
+    if (n % 2)
+      n = 3 * n + 1;
+    else
+      n /= 2;
+    ++steps;
+  }
+  return steps;
+}
+static_assert(collatz(27) == 111, "");
+
+constexpr int firstDivisor(int n) {
+  int d = 2;
+  do {
+    if (n % d == 0)
+      break;
+    if (d * d > n) {
+      d = n - 1;
+      continue;
+    }
+  } while (++d < n);
+  return d;
+}
+static_assert(firstDivisor(91) == 7, "");
+static_assert(firstDivisor(97) == 97, "");
+
+constexpr bool isPrime(int n) {
+  return n > 1 && firstDivisor(n) == n;
+}
+constexpr int countPrimes(int n) {
+  int count = 0;
+  for (int i = 0; i < n; i++)
+    count += isPrime(i);
+  return count;
+}
+static_assert(countPrimes(1000) == 168, "");
+
+constexpr unsigned long long ackermann(unsigned long long m,
+                                       unsigned long long n) {
+  return m == 0 ? n + 1 : n == 0 ? ackermann(m - 1, 1)
+                                 : ackermann(m - 1, ackermann(m, n - 1));
+}
+static_assert(ackermann(2, 3) == 9, "");
+
+// Narrow types wrap around on increment, and unsigned arithmetic wraps.
+constexpr signed char wrapChar(signed char c) {
+  return ++c;
+}
+static_assert(wrapChar(127) == -128, "");
+constexpr unsigned wrapUnsigned(unsigned u) {
+  u -= 2;
+  return u << 1;
+}
+static_assert(wrapUnsigned(1) == 0xfffffffeu, "");
+
+constexpr int shifts(int a, unsigned b) {
+  return (a >> b) + (1 << b);
+}
+static_assert(shifts(-16, 2) == 0, "");
+static_assert(shifts(100, 31) == -2147483648, "");
+
+constexpr int global = 42;
+constexpr int readGlobal(int n) {
+  return global + n;
+}
+static_assert(readGlobal(1) == 43, "");
+
+constexpr bool logic(bool a, bool b) {
+  return (a && !b) || (!a && b);
+}
+static_assert(logic(true, false) && !logic(true, true), "");
+
+// Evaluations that are not constant expressions are left to the AST-walking
+// evaluator, which diagnoses them.
+constexpr int overflow(int n) {
+  int v = 1;
+  for (int i = 0; i < n; ++i)
+    v *= 2; // expected-note {{value 2147483648 is outside the range}}
+  return v;
+}
+static_assert(overflow(30) == 1 << 30, "");
+static_assert(overflow(31), ""); // expected-error {{constant expression}} \
+                                 // expected-note {{in call to 'overflow(31)'}}
+
+constexpr int divide(int a, int b) {
+  return a / b; // expected-note {{division by zero}}
+}
+constexpr int callDivide(int n) {
+  return divide(100, n - 1); // expected-note {{in call to 'divide(100, 0)'}}
+}
+static_assert(callDivide(5) == 25, "");
+static_assert(callDivide(1), ""); // expected-error {{constant expression}} \
+                                  // expected-note {{in call to 'callDivide(1)'}}
+
+constexpr int noReturn(int n) {
+  if (n)
+    return n;
+} // expected-warning {{control may reach end of non-void function}} \
+  // expected-note {{control reached end}}
+static_assert(noReturn(0), ""); // expected-error {{constant expression}} \
+                                // expected-note {{in call to 'noReturn(0)'}}
+
+// Functions using unsupported constructs are evaluated by walking the AST.
+constexpr int viaSwitch(int n) {
+  switch (n) {
+  case 0: return 10;
+  default: return 20;
+  }
+}
+static_assert(viaSwitch(0) == 10 && viaSwitch(1) == 20, "");
+
+constexpr int viaArray(int n) {
+  int a[3] = {1, 2, 3};
+  return a[n];
+}
+static_assert(viaArray(2) == 3, "");
+
+struct S {
+  int v;
+  constexpr int get(int n) const { return v + n; }
+};
+constexpr int viaMember(int n) {
+  return S{n}.get(n);
+}
+static_assert(viaMember(2) == 4, "");
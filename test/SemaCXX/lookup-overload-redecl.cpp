@@ -0,0 +1,40 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Redeclarations of functions and function templates in an overload set must
+// replace the earlier declarations in the lookup table, so that later lookups
+// find the default arguments they add.
+namespace N {
+  void f(int);
+  void f(char);
+  template<typename T> void f(T *);
+  void f(double);
+}
+
+void useBefore() {
+  N::f(); // expected-error {{no matching function}}
+  // expected-note@7 {{requires 1 argument}}
+  // expected-note@8 {{requires 1 argument}}
+  // expected-note@9 {{requires 1 argument}}
+  // expected-note@10 {{requires 1 argument}}
+}
+
+namespace N {
+  void f(char c = 'a');
+  template<typename T> void f(T *);
+  void f(int);
+}
+
+void useAfter() {
+  N::f();
+  N::f((int *)0);
+}
+
+namespace N {
+  void g(int);
+  void g(long);
+  void g(int x = 0) {}
+}
+
+void useG() {
+  N::g();
+}
@@ -0,0 +1,65 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Candidates whose template argument deduction is skipped are diagnosed as if
+// deduction had been performed.
+template<typename T> struct Vec { T *Data; };
+template<typename T> struct DerivedVec : Vec<T> {};
+struct Plain {};
+
+template<typename T> int size(const Vec<T> &); // expected-note 2{{candidate template ignored: could not match 'Vec<type-parameter-0-0>' against}}
+int size(Plain *); // expected-note 2{{candidate function not viable: no known conversion}}
+
+void test_deduction(Plain P, Vec<int> V, DerivedVec<char> D) {
+  size(V);
+  size(D);
+  size(P); // expected-error {{no matching function for call to 'size'}}
+  size(1.0); // expected-error {{no matching function for call to 'size'}}
+}
+
+// Deduction instantiates the argument's class to look at its bases.
+template<typename T> struct Base {};
+template<typename T> struct Wrapper : Base<T> {};
+template<typename T> int base(const Base<T> &);
+Wrapper<int> *make();
+
+void test_instantiate() {
+  base(*make());
+}
+
+template<typename T> void pair(T, T); // expected-note {{candidate function template not viable: requires 2 arguments, but 1 was provided}}
+
+void test_arity() {
+  pair(1); // expected-error {{no matching function for call to 'pair'}}
+}
+
+// Cached bad conversion sequences refer to the argument being converted.
+struct Convertible { operator int() const; };
+struct Other {};
+void take(int); // expected-note 2{{candidate function not viable: no known conversion from 'Other' to 'int' for 1st argument}}
+void take(Plain); // expected-note 2{{candidate function not viable: no known conversion from 'Other' to 'Plain' for 1st argument}}
+
+void test_cache(Convertible C, Other O) {
+  take(C);
+  take(C);
+  take(O); // expected-error {{no matching function for call to 'take'}}
+  take(O); // expected-error {{no matching function for call to 'take'}}
+}
+
+// Completing a class changes the conversions that were cached before.
+struct PtrBase {};
+struct PtrDerived;
+struct ToPtr { operator PtrDerived *(); };
+int pick(PtrBase *);
+char pick(...);
+
+void test_completion() {
+  typedef char before[sizeof(pick(ToPtr())) == sizeof(char) ? 1 : -1];
+}
+struct PtrDerived : PtrBase {};
+void test_completed() {
+  typedef char after[sizeof(pick(ToPtr())) == sizeof(int) ? 1 : -1];
+}
+
+// CHECK: {{[1-9][0-9]*}} template argument deductions avoided
+// CHECK: {{[1-9][0-9]*}} conversion cache hits
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -fsyntax-only -ftemplate-instantiation-report=%t %s
+// RUN: FileCheck %s < %t
+// RUN: %clang -### -ftemplate-instantiation-report=%t -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=DRIVER %s
+
+// CHECK: # specialization
+// CHECK-DAG: specialization{{.}}class{{.}}Outer<int>{{.}}Outer{{.}}1{{.}}
+// CHECK-DAG: specialization{{.}}class{{.}}Inner<int>{{.}}Inner{{.}}1{{.}}
+// CHECK-DAG: specialization{{.}}function{{.}}Outer<int>::get{{.}}Outer::get{{.}}1{{.}}
+// CHECK-DAG: specialization{{.}}function{{.}}make<int>{{.}}make{{.}}1{{.}}
+// CHECK: # template
+// CHECK-DAG: template{{.}}class{{.}}Inner{{.}}2{{.}}2{{.}}
+// CHECK-DAG: template{{.}}function{{.}}make{{.}}2{{.}}2{{.}}
+
+// DRIVER: "-cc1"{{.*}} "-ftemplate-instantiation-report=
+
+template <typename T> struct Inner { T Value; };
+
+template <typename T> struct Outer {
+  Inner<T> I;
+  T get() { return I.Value; }
+};
+
+template <typename T> T make() { return Outer<T>().get(); }
+
+int f() { return make<int>() + (int)make<long>(); }
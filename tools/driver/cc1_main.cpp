@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -27,8 +28,10 @@
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
@@ -41,11 +44,20 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+namespace {
+/// \brief The state of the fatal error handler during one run of the tool.
+struct FatalErrorInfo {
+  DiagnosticsEngine *Diags;
+  /// The status to exit with, once a fatal error has been reported.
+  int Status;
+};
+}
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
-  DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
+  FatalErrorInfo &Info = *static_cast<FatalErrorInfo*>(UserData);
 
-  Diags.Report(diag::err_fe_error_backend) << Message;
+  Info.Diags->Report(diag::err_fe_error_backend) << Message;
 
   // Run the interrupt handlers to make sure any special cleanups get done, in
   // particular that we remove files registered with RemoveFileOnSignal.
@@ -54,7 +66,14 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  Info.Status = GenCrashDiag ? 70 : 1;
+
+  // When running in the driver process, unwind back to cc1_main and return
+  // the status from there instead of exiting the driver.
+  if (llvm::CrashRecoveryContext *CRC =
+          llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+  exit(Info.Status);
 }
 
 #ifdef LINK_POLLY_INTO_TOOLS
@@ -99,15 +118,51 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   // Set an error handler, so that any LLVM backend diagnostics go through our
   // error handler.
+  FatalErrorInfo FatalError = { &Clang->getDiagnostics(), 0 };
   llvm::install_fatal_error_handler(LLVMErrorHandler,
-                                  static_cast<void*>(&Clang->getDiagnostics()));
+                                    static_cast<void*>(&FatalError));
 
   DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
-  if (!Success)
+  if (!Success) {
+    llvm::remove_fatal_error_handler();
     return 1;
+  }
 
-  // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  if (Clang->getFrontendOpts().TimeTrace)
+    timeTraceProfilerInitialize();
+
+  // Execute the frontend actions. In the driver process, a fatal error
+  // unwinds to here, while a crash is left to the driver to report.
+  llvm::CrashRecoveryContext *DriverCRC =
+      llvm::CrashRecoveryContext::GetCurrent();
+  llvm::CrashRecoveryContext CRC;
+  if (!CRC.RunSafely(
+          [&] { Success = ExecuteCompilerInvocation(Clang.get()); })) {
+    if (!FatalError.Status && DriverCRC)
+      DriverCRC->HandleCrash();
+    Success = false;
+  }
+
+  // Write the time trace next to the output file, or next to the input file
+  // if there is no output file.
+  if (timeTraceProfilerEnabled()) {
+    const FrontendOptions &FEOpts = Clang->getFrontendOpts();
+    SmallString<128> Path(FEOpts.OutputFile);
+    if ((Path.empty() || Path == "-") && !FEOpts.Inputs.empty() &&
+        FEOpts.Inputs[0].isFile())
+      Path = llvm::sys::path::filename(FEOpts.Inputs[0].getFile());
+    if (!Path.empty() && Path != "-") {
+      llvm::sys::path::replace_extension(Path, "json");
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(Path.str(), EC, llvm::sys::fs::F_Text);
+      if (EC)
+        Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+            << Path << EC.message();
+      else
+        timeTraceProfilerWrite(OS);
+    }
+    timeTraceProfilerCleanup();
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
@@ -118,17 +173,20 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   // later errors use the default handling behavior instead.
   llvm::remove_fatal_error_handler();
 
+  int Status = FatalError.Status ? FatalError.Status : !Success;
+
   // When running with -disable-free, don't do any destruction or shutdown.
-  if (Clang->getFrontendOpts().DisableFree) {
+  // Nor after a fatal error, which left the compiler in an unknown state.
+  if (Clang->getFrontendOpts().DisableFree || FatalError.Status) {
     if (llvm::AreStatisticsEnabled() || Clang->getFrontendOpts().ShowStats)
       llvm::PrintStatistics();
     BuryPointer(std::move(Clang));
-    return !Success;
+    return Status;
   }
 
   // Managed static deconstruction. Useful for making things like
   // -time-passes usable.
   llvm::llvm_shutdown();
 
-  return !Success;
+  return Status;
 }
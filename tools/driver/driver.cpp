@@ -375,6 +375,11 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   return 1;
 }
 
+/// \brief Run a -cc1 tool for a job of a driver with -fintegrated-cc1.
+static int ExecuteCC1InProcess(ArrayRef<const char *> argv) {
+  return ExecuteCC1Tool(argv, StringRef(argv[1]).substr(4));
+}
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal();
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -463,6 +468,7 @@ int main(int argc_, const char **argv_) {
   ParseProgName(argv, SavedStrings);
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
+  TheDriver.CC1Main = ExecuteCC1InProcess;
 
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 0;
@@ -353,13 +353,17 @@ public:
   }
 
   bool shouldSkipFunctionBody(Decl *D) override {
-    if (!SKCtrl) {
-      // Always skip bodies.
+    const SourceManager &SM = IndexCtx.getASTContext().getSourceManager();
+    SourceLocation Loc = D->getLocation();
+    if (IndexCtx.shouldSkipNonMainFileBodies() &&
+        !SM.isInMainFile(SM.getExpansionLoc(Loc)))
       return true;
+
+    if (!SKCtrl) {
+      // Always skip bodies, unless only the other files' bodies are skipped.
+      return !IndexCtx.shouldSkipNonMainFileBodies();
     }
 
-    const SourceManager &SM = IndexCtx.getASTContext().getSourceManager();
-    SourceLocation Loc = D->getLocation();
     if (Loc.isMacroID())
       return false;
     if (SM.isInSystemHeader(Loc))
@@ -377,6 +381,11 @@ public:
 
     return SKCtrl->isParsed(Loc, FID, FE);
   }
+
+  bool shouldDelaySkippedTemplateBody(Decl *D) override {
+    // Implicit instantiations are only performed if they are indexed.
+    return IndexCtx.shouldIndexImplicitTemplateInsts();
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -609,7 +618,7 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   // revisited.
   bool SkipBodies = (index_options & CXIndexOpt_SkipParsedBodiesInSession) &&
       CInvok->getLangOpts()->CPlusPlus;
-  if (SkipBodies)
+  if (SkipBodies || (index_options & CXIndexOpt_SkipNonMainFileBodies))
     CInvok->getFrontendOpts().SkipFunctionBodies = true;
 
   std::unique_ptr<IndexingFrontendAction> IndexAction;
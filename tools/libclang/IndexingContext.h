@@ -357,6 +357,10 @@ public:
     return IndexOptions & CXIndexOpt_IndexImplicitTemplateInstantiations;
   }
 
+  bool shouldSkipNonMainFileBodies() const {
+    return IndexOptions & CXIndexOpt_SkipNonMainFileBodies;
+  }
+
   static bool isFunctionLocalDecl(const Decl *D);
 
   bool shouldAbort();
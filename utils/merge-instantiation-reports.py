@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+
+"""
+Merge the reports written by -ftemplate-instantiation-report for several
+translation units, and list the template specializations that are
+instantiated in more than one of them, along with the time that would be
+saved by instantiating them only once (for example, by adding an explicit
+instantiation declaration, 'extern template', for them to a header and an
+explicit instantiation definition to a single source file).
+"""
+
+import optparse
+import sys
+
+class Specialization(object):
+    def __init__(self, kind, name, template):
+        self.kind = kind
+        self.name = name
+        self.template = template
+        self.units = 0
+        self.selfTime = 0
+        self.totalTime = 0
+        self.selfBytes = 0
+
+    def redundantTime(self):
+        # The time spent in every translation unit but one.
+        if not self.units:
+            return 0
+        return self.totalTime - self.totalTime // self.units
+
+def readReport(path, specializations):
+    seen = set()
+    for line in open(path):
+        if line.startswith('#'):
+            continue
+        fields = line.rstrip('\n').split('\t')
+        if fields[0] != 'specialization':
+            continue
+        (_, kind, name, template, count, selfTime, totalTime, selfBytes,
+         totalBytes, nodes, maxDepth) = fields
+        s = specializations.get(name)
+        if s is None:
+            s = specializations[name] = Specialization(kind, name, template)
+        if name not in seen:
+            seen.add(name)
+            s.units += 1
+        s.selfTime += int(selfTime)
+        s.totalTime += int(totalTime)
+        s.selfBytes += int(selfBytes)
+
+def main():
+    parser = optparse.OptionParser("%prog [options] report...")
+    parser.add_option("-n", "--min-units", dest="minUnits", type=int,
+                      default=2, metavar="N",
+                      help="only list specializations instantiated in at "
+                           "least N translation units [%default]")
+    parser.add_option("", "--limit", dest="limit", type=int, default=0,
+                      help="list at most this many specializations")
+    parser.add_option("", "--by-template", dest="byTemplate",
+                      action="store_true", default=False,
+                      help="aggregate the results per template")
+    opts, args = parser.parse_args()
+    if not args:
+        parser.error("no reports given")
+
+    specializations = {}
+    for path in args:
+        readReport(path, specializations)
+
+    results = [s for s in specializations.values()
+               if s.units >= opts.minUnits]
+
+    if opts.byTemplate:
+        templates = {}
+        for s in results:
+            t = templates.get(s.template)
+            if t is None:
+                t = templates[s.template] = Specialization(s.kind, s.template,
+                                                           s.template)
+            t.units = max(t.units, s.units)
+            t.selfTime += s.selfTime
+            t.totalTime += s.totalTime
+            t.selfBytes += s.selfBytes
+            t.redundant = getattr(t, 'redundant', 0) + s.redundantTime()
+        results = list(templates.values())
+        key = lambda s: s.redundant
+    else:
+        key = lambda s: s.redundantTime()
+
+    results.sort(key=lambda s: (-key(s), s.name))
+    if opts.limit:
+        results = results[:opts.limit]
+
+    print('# units\tredundant-us\ttotal-us\tself-bytes\tkind\tname')
+    for s in results:
+        print('%d\t%d\t%d\t%d\t%s\t%s' % (s.units, key(s), s.totalTime,
+                                          s.selfBytes, s.kind, s.name))
+
+if __name__ == '__main__':
+    main()